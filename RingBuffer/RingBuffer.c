@@ -39,8 +39,26 @@
 /* ************************************************************************** */
 /* ************************************************************************** */
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE     // MAP_ANON, madvise()
+#endif
+
+#include <string.h>
+
+// The definitions below must keep the exported names
+#define RING_NO_FAST_MACROS
 #include "RingBuffer.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define RING_MAPPED_STORAGE
+#endif
+
 /* ************************************************************************** */
 /* ************************************************************************** */
 /* Section: File Scope or Global Data                                         */
@@ -57,17 +75,83 @@
 
 // Returns the rounded down power of 2 of the given number
 
-#ifdef POWER_2_OPTIMIZATION
-
 static size_t RING_RoundDown(size_t x) {
     x = x | (x >> 1);
     x = x | (x >> 2);
     x = x | (x >> 4);
     x = x | (x >> 8);
     x = x | (x >> 16);
+#if SIZE_MAX > 0xFFFFFFFFu
+    x = x | (x >> 32);
+#endif
     return x - (x >> 1);
 }
+
+// Returns the buffer size granted by the policy, 0 if it cannot be represented
+
+static size_t RING_ApplySizePolicy(size_t size, RING_SIZE_POLICY policy) {
+    size_t down;
+    
+    switch (policy) {
+        case RING_SIZE_EXACT:
+            return size;
+        case RING_SIZE_ROUND_DOWN:
+            return RING_RoundDown(size);
+        case RING_SIZE_ROUND_UP:
+            down = RING_RoundDown(size);
+            if (down == size)
+                return size;
+            return down > SIZE_MAX / 2 ? 0 : down << 1;
+        default:
+            return 0;
+    }
+}
+
+// Copies with non-temporal stores, the destination lines are not kept in cache
+
+static void RING_StreamCopy(uint8_t *dst, const uint8_t *src, size_t len) {
+#if defined(__SSE2__)
+    __m128i a, b, c, d;
+    size_t head;
+    
+    // Stores must be 16 bytes aligned
+    head = min(len, (16 - ((uintptr_t) dst & 15)) & 15);
+    memcpy(dst, src, head);
+    dst += head;
+    src += head;
+    len -= head;
+    
+    while (len >= 64) {
+        _mm_prefetch((const char*) src + 512, _MM_HINT_NTA);
+        a = _mm_loadu_si128((const __m128i*) src);
+        b = _mm_loadu_si128((const __m128i*) (src + 16));
+        c = _mm_loadu_si128((const __m128i*) (src + 32));
+        d = _mm_loadu_si128((const __m128i*) (src + 48));
+        _mm_stream_si128((__m128i*) dst, a);
+        _mm_stream_si128((__m128i*) (dst + 16), b);
+        _mm_stream_si128((__m128i*) (dst + 32), c);
+        _mm_stream_si128((__m128i*) (dst + 48), d);
+        dst += 64;
+        src += 64;
+        len -= 64;
+    }
+    memcpy(dst, src, len);
+    
+    // Make the streamed bytes visible before the head moves
+    _mm_sfence();
+#else
+    memcpy(dst, src, len);
 #endif
+}
+
+// Copies into the ring memory following the copy policy
+
+static void RING_CopyIn(const RING_DATA * const ring, uint8_t *dst, const uint8_t *src, size_t len) {
+    if (ring->streaming != 0 && len >= ring->streaming)
+        RING_StreamCopy(dst, src, len);
+    else
+        memcpy(dst, src, len);
+}
 
 /* ************************************************************************** */
 /* ************************************************************************** */
@@ -92,14 +176,43 @@ static size_t RING_RoundDown(size_t x) {
  
  * Overview:        None
  
- * Note:            The macro POWER_2_OPTIMIZATION speeds up the ring buffer access
- by rounding down to the closed power of 2
+ * Note:            The size follows RING_DEFAULT_SIZE_POLICY, the macro
+ POWER_2_OPTIMIZATION selects the rounding down to the closed power of 2
  *****************************************************************************/
 RING_DATA * RING_InitBuffer(const uint8_t *buf, size_t size) {
+    return RING_InitBufferWithPolicy(buf, size, RING_DEFAULT_SIZE_POLICY);
+}
+
+/*****************************************************************************
+ * Function:        RING_DATA * RING_InitBufferWithPolicy(const uint8_t *buf, size_t size, RING_SIZE_POLICY policy)
+ 
+ * Description:     This function creates a RING_DATA object whose size follows the given policy
+ 
+ * PreCondition:    None
+ 
+ * Input:           buf is the predefined ring buffer, NULL to require a dynamic allocation
+ size is the size of the pre-allocated memory or the required memory
+ policy selects the exact size or the rounding to a power of 2
+ 
+ * Return:          Pointer to a RING_DATA type allocated in the dynamic memory
+ 
+ * Side Effects:    RING_DeinitializeBuffer() must be called to correctly release dynamic memory
+ 
+ * Overview:        The index arithmetic wraps by comparison, therefore, rings
+ with exact and power of 2 sizes run the same code without any division
+ 
+ * Note:            RING_SIZE_ROUND_UP keeps at least the required capacity, it
+ fails with a pre-allocated buffer smaller than the rounded size
+ *****************************************************************************/
+RING_DATA * RING_InitBufferWithPolicy(const uint8_t *buf, size_t size, RING_SIZE_POLICY policy) {
     
     RING_DATA *ring;
+    size_t granted;
+    
+    if (size == 0 || (granted = RING_ApplySizePolicy(size, policy)) == 0)
+        return NULL;
     
-    if (size == 0)
+    if (buf != NULL && granted > size)
         return NULL;
     
     if ((ring = malloc(sizeof (RING_DATA))) == NULL)
@@ -108,11 +221,9 @@ RING_DATA * RING_InitBuffer(const uint8_t *buf, size_t size) {
     // Reset fields
     ring->head = 0;
     ring->tail = 0;
-#ifdef POWER_2_OPTIMIZATION
-    ring->size = (size_t) RING_RoundDown(size);
-#else
-    ring->size = size;
-#endif
+    ring->streaming = 0;
+    ring->mapped = false;
+    ring->size = granted;
     
     // Check if user already allocates memory
     if (buf == NULL) {
@@ -129,6 +240,93 @@ RING_DATA * RING_InitBuffer(const uint8_t *buf, size_t size) {
     return ring;
 }
 
+/*****************************************************************************
+ * Function:        RING_DATA * RING_InitMappedBuffer(size_t size)
+ 
+ * Description:     This function creates a RING_DATA object whose memory is reserved
+ but committed only when it is first touched
+ 
+ * PreCondition:    None
+ 
+ * Input:           size is the required memory
+ 
+ * Return:          Pointer to a RING_DATA type allocated in the dynamic memory, NULL
+ when the platform does not support anonymous mappings
+ 
+ * Side Effects:    RING_DeinitializeBuffer() must be called to correctly release dynamic memory
+ 
+ * Overview:        The size follows RING_MAPPED_SIZE_POLICY, it is never rounded
+ down because the pages the head does not reach are not committed
+ 
+ * Note:            See RING_InitMappedBufferWithPolicy()
+ *****************************************************************************/
+RING_DATA * RING_InitMappedBuffer(size_t size) {
+    return RING_InitMappedBufferWithPolicy(size, RING_MAPPED_SIZE_POLICY);
+}
+
+/*****************************************************************************
+ * Function:        RING_DATA * RING_InitMappedBufferWithPolicy(size_t size, RING_SIZE_POLICY policy)
+ 
+ * Description:     This function creates a RING_DATA object whose memory is reserved
+ but committed only when it is first touched
+ 
+ * PreCondition:    None
+ 
+ * Input:           size is the required memory
+ policy tells how the required size becomes the buffer size
+ 
+ * Return:          Pointer to a RING_DATA type allocated in the dynamic memory, NULL
+ when the platform does not support anonymous mappings
+ 
+ * Side Effects:    RING_DeinitializeBuffer() must be called to correctly release dynamic memory
+ 
+ * Overview:        The buffer is an anonymous private mapping without swap
+ reservation, therefore, a ring of tens of GiB costs only the pages the head
+ has already reached
+ 
+ * Note:            RING_ReleaseFreePages() gives the pages of the free space back
+ to the system
+ *****************************************************************************/
+RING_DATA * RING_InitMappedBufferWithPolicy(size_t size, RING_SIZE_POLICY policy) {
+    
+#ifdef RING_MAPPED_STORAGE
+    RING_DATA *ring;
+    void *buf;
+    size_t granted;
+    
+    if (size == 0 || (granted = RING_ApplySizePolicy(size, policy)) == 0)
+        return NULL;
+    
+    if ((ring = malloc(sizeof (RING_DATA))) == NULL)
+        return NULL;
+    
+    // Reset fields
+    ring->head = 0;
+    ring->tail = 0;
+    ring->streaming = 0;
+    ring->size = granted;
+    
+#ifdef MAP_NORESERVE
+    buf = mmap(NULL, ring->size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+#else
+    buf = mmap(NULL, ring->size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+#endif
+    if (buf == MAP_FAILED) {
+        free(ring);
+        return NULL;
+    }
+    ring->buf = (uint8_t*) buf;
+    ring->dymamic = true;
+    ring->mapped = true;
+    
+    return ring;
+#else
+    (void) size;
+    (void) policy;
+    return NULL;
+#endif
+}
+
 /*****************************************************************************
  * Function:        RING_DeinitializeBuffer(const RING_DATA *ring)
  
@@ -147,11 +345,66 @@ RING_DATA * RING_InitBuffer(const uint8_t *buf, size_t size) {
  * Note:            None
  *****************************************************************************/
 void RING_DeinitializeBuffer(const RING_DATA *ring) {
+#ifdef RING_MAPPED_STORAGE
+    if (ring->mapped)
+        munmap(ring->buf, ring->size);
+    else
+#endif
     if (ring->dymamic)
         free((RING_DATA*) ring->buf);
     free((RING_DATA*) ring);
 }
 
+/*****************************************************************************
+ * Function:        RING_ReleaseFreePages(const RING_DATA * const ring)
+ 
+ * Description:     This function returns the whole pages of the free space to the system
+ 
+ * PreCondition:    RING_InitMappedBuffer() must be successfully called
+ 
+ * Input:           ring the RING_DATA pre-allocated object
+ 
+ * Return:          The number of released bytes, 0 for rings that are not mapped
+ 
+ * Side Effects:    The released pages read back as zero and they are committed
+ again when the head reaches them
+ 
+ * Overview:        Pages holding filled bytes are never released
+ 
+ * Note:            Typically called after a long idle period, when a burst left
+ most of the ring committed but unused
+ *****************************************************************************/
+size_t RING_ReleaseFreePages(const RING_DATA * const ring) {
+    
+#ifdef RING_MAPPED_STORAGE
+    size_t page, space, first, start, end, seg, released;
+    size_t segs[2][2];
+    
+    if (!ring->mapped)
+        return 0;
+    
+    page = (size_t) sysconf(_SC_PAGESIZE);
+    space = RING_GetFreeSpace(ring);
+    first = min(space, ring->size - ring->head);
+    segs[0][0] = ring->head;
+    segs[0][1] = ring->head + first;
+    segs[1][0] = 0;
+    segs[1][1] = space - first;
+    
+    released = 0;
+    for (seg = 0; seg < 2; seg++) {
+        start = (segs[seg][0] + page - 1) / page * page;
+        end = segs[seg][1] / page * page;
+        if (end > start && madvise(&ring->buf[start], end - start, MADV_DONTNEED) == 0)
+            released += end - start;
+    }
+    return released;
+#else
+    (void) ring;
+    return 0;
+#endif
+}
+
 /*****************************************************************************
  * Function:        RING_GetBufferSize(const RING_DATA * const ring)
  
@@ -171,7 +424,7 @@ void RING_DeinitializeBuffer(const RING_DATA *ring) {
  To know free space use RING_GetFreeSpace() or RING_GetFreeLinearSpace()
  *****************************************************************************/
 inline size_t RING_GetBufferSize(const RING_DATA * const ring) {
-    return ring->size;
+    return RING_FastGetBufferSize(ring);
 }
 
 /*****************************************************************************
@@ -192,11 +445,7 @@ inline size_t RING_GetBufferSize(const RING_DATA * const ring) {
  * Note:            The free space may not be linear
  *****************************************************************************/
 inline size_t RING_GetFreeSpace(const RING_DATA * const ring) {
-#ifdef POWER_2_OPTIMIZATION
-    return ((ring->tail + ring->size - ring->head - 1) & (ring->size - 1));
-#else
-    return ((ring->tail + ring->size - ring->head - 1) % ring->size + 1) - 1;
-#endif
+    return RING_FastGetFreeSpace(ring);
 }
 
 /*****************************************************************************
@@ -217,14 +466,7 @@ inline size_t RING_GetFreeSpace(const RING_DATA * const ring) {
  * Note:            The linear free space may be less than RING_GetFreeSpace()
  *****************************************************************************/
 inline size_t RING_GetFreeLinearSpace(const RING_DATA * const ring) {
-    if (ring->head >= ring->tail) {
-        if (ring->tail == 0)
-            return ring->size - ring->head - 1;
-        else
-            return ring->size - ring->head;
-    } else {
-        return ring->tail - ring->head - 1;
-    }
+    return RING_FastGetFreeLinearSpace(ring);
 }
 
 /*****************************************************************************
@@ -245,12 +487,7 @@ inline size_t RING_GetFreeLinearSpace(const RING_DATA * const ring) {
  * Note:            The filled space may be not linear
  *****************************************************************************/
 inline size_t RING_GetFullSpace(const RING_DATA * const ring) {
-#ifdef POWER_2_OPTIMIZATION
-    return ring->size - ((ring->tail + ring->size - ring->head - 1) & (ring->size - 1)) - 1;
-#else
-    return ring->size - (((ring->tail + ring->size - ring->head - 1) % ring->size) + 1);
-#endif
-    
+    return RING_FastGetFullSpace(ring);
 }
 
 /*****************************************************************************
@@ -271,10 +508,33 @@ inline size_t RING_GetFullSpace(const RING_DATA * const ring) {
  * Note:            The linear filled space may be less than RING_GetFullSpace()
  *****************************************************************************/
 inline size_t RING_GetFullLinearSpace(const RING_DATA *ring) {
-    if (ring->head >= ring->tail)
-        return ring->head - ring->tail;
-    else
-        return ring->size - ring->tail;
+    return RING_FastGetFullLinearSpace(ring);
+}
+
+/*****************************************************************************
+ * Function:        RING_SetCopyPolicy(RING_DATA * const ring, size_t streaming)
+ 
+ * Description:     This function selects how RING_AddBuffer() copies into the ring
+ 
+ * PreCondition:    RING_InitBuffer() must be successfully called
+ 
+ * Input:           ring the RING_DATA pre-allocated object
+ streaming the minimum size of a segment copied with non-temporal stores, 0 to disable
+ 
+ * Return:          None
+ 
+ * Side Effects:    None
+ 
+ * Overview:        Segments at least streaming bytes long are written with
+ non-temporal stores and the source is prefetched with a non-temporal hint,
+ therefore, large transfers do not evict the working set of the other cores
+ 
+ * Note:            Useful when the ring is much larger than the last level cache
+ and the consumer reads the data long after it is written. Without SSE2 it
+ has no effect.
+ *****************************************************************************/
+void RING_SetCopyPolicy(RING_DATA * const ring, size_t streaming) {
+    ring->streaming = streaming;
 }
 
 /*****************************************************************************
@@ -297,11 +557,7 @@ inline size_t RING_GetFullLinearSpace(const RING_DATA *ring) {
  * Note:            The user must care that count is less than free space
  *****************************************************************************/
 inline void RING_IncreaseHead(RING_DATA * const ring, size_t count) {
-#ifdef POWER_2_OPTIMIZATION
-    ring->head = (ring->head + count) & (ring->size - 1);
-#else
-    ring->head = (ring->head + count) % ring->size;
-#endif
+    RING_FastIncreaseHead(ring, count);
 }
 
 /*****************************************************************************
@@ -324,11 +580,7 @@ inline void RING_IncreaseHead(RING_DATA * const ring, size_t count) {
  * Note:            The user must care that count is less than full space
  *****************************************************************************/
 inline void RING_IncreaseTail(RING_DATA * const ring, size_t count) {
-#ifdef POWER_2_OPTIMIZATION
-    ring->tail = (ring->tail + count) & (ring->size - 1);
-#else
-    ring->tail = (ring->tail + count) % ring->size;
-#endif
+    RING_FastIncreaseTail(ring, count);
 }
 
 /*****************************************************************************
@@ -349,7 +601,7 @@ inline void RING_IncreaseTail(RING_DATA * const ring, size_t count) {
  * Note:            None
  *****************************************************************************/
 inline uint8_t * RING_GetHeadPointer(const RING_DATA * const ring) {
-    return ring->buf + ring->head;
+    return RING_FastGetHeadPointer(ring);
 }
 
 /*****************************************************************************
@@ -370,7 +622,7 @@ inline uint8_t * RING_GetHeadPointer(const RING_DATA * const ring) {
  * Note:            None
  *****************************************************************************/
 inline uint8_t * RING_GetTailPointer(const RING_DATA * const ring) {
-    return ring->buf + ring->tail;
+    return RING_FastGetTailPointer(ring);
 }
 
 /*****************************************************************************
@@ -392,16 +644,7 @@ inline uint8_t * RING_GetTailPointer(const RING_DATA * const ring) {
  * Note:            None
  *****************************************************************************/
 bool RING_AddByte(RING_DATA * const ring, uint8_t val) {
-    if (RING_GetFreeSpace(ring) > 0) {
-        ring->buf[ring->head] = val;
-#ifdef POWER_2_OPTIMIZATION
-        ring->head = (ring->head + 1) & (ring->size - 1);
-#else
-        ring->head = (ring->head + 1) % ring->size;
-#endif
-        return true;
-    }
-    return false;
+    return RING_FastAddByte(ring, val);
 }
 
 /*****************************************************************************
@@ -424,19 +667,15 @@ bool RING_AddByte(RING_DATA * const ring, uint8_t val) {
  * Note:            None
  *****************************************************************************/
 size_t RING_AddBuffer(RING_DATA * const ring, uint8_t *buf, size_t size) {
-    size_t i, writable;
+    size_t first, writable;
     
+    // At most two linear segments, the second one starts at the buffer begin
     writable = min(RING_GetFreeSpace(ring), size);
-    for (i = 0; i < writable; i++) {
-        ring->buf[ring->head] = buf[i];
-#ifdef POWER_2_OPTIMIZATION
-        ring->head = (ring->head + 1) & (ring->size - 1);
-#else
-        ring->head = (ring->head + 1) % ring->size;
-#endif
-        
-    }
-    return i;
+    first = min(writable, ring->size - ring->head);
+    RING_CopyIn(ring, &ring->buf[ring->head], buf, first);
+    RING_CopyIn(ring, ring->buf, &buf[first], writable - first);
+    ring->head = RING_FastAdvance(ring, ring->head, writable);
+    return writable;
 }
 
 /*****************************************************************************
@@ -463,11 +702,7 @@ uint8_t * RING_AddBufferDirectly(RING_DATA * const ring, size_t *toWrite, size_t
     
     *toWrite = min(RING_GetFreeLinearSpace(ring), size);
     ptr = &ring->buf[ring->head];
-#ifdef POWER_2_OPTIMIZATION
-    ring->head = (ring->head + *toWrite) & (ring->size - 1);
-#else
-    ring->head = (ring->head + *toWrite) % ring->size;
-#endif
+    ring->head = RING_FastAdvance(ring, ring->head, *toWrite);
     
     return ptr;
 }
@@ -491,17 +726,7 @@ uint8_t * RING_AddBufferDirectly(RING_DATA * const ring, size_t *toWrite, size_t
  * Note:            None
  *****************************************************************************/
 bool RING_GetByte(RING_DATA * const ring, uint8_t *byte) {
-    if (RING_GetFullSpace(ring) > 0) {
-        *byte = ring->buf[ring->tail];
-#ifdef POWER_2_OPTIMIZATION
-        ring->tail = (ring->tail + 1) & (ring->size - 1);
-#else
-        ring->tail = (ring->tail + 1) % ring->size;
-#endif
-        return true;
-    } else {
-        return false;
-    }
+    return RING_FastGetByte(ring, byte);
 }
 
 /*****************************************************************************
@@ -522,14 +747,7 @@ bool RING_GetByte(RING_DATA * const ring, uint8_t *byte) {
  * Note:            The user must check the byte availability
  *****************************************************************************/
 inline uint8_t RING_GetByteSimple(RING_DATA * const ring) {
-    uint8_t temp;
-    temp = ring->buf[ring->tail];
-#ifdef POWER_2_OPTIMIZATION
-    ring->tail = (ring->tail + 1) & (ring->size - 1);
-#else
-    ring->tail = (ring->tail + 1) % ring->size;
-#endif
-    return temp;
+    return RING_FastGetByteSimple(ring);
 }
 
 /*****************************************************************************
@@ -553,20 +771,15 @@ inline uint8_t RING_GetByteSimple(RING_DATA * const ring) {
  *****************************************************************************/
 size_t RING_GetBuffer(RING_DATA * const ring, uint8_t *ptr, size_t len) {
     
-    size_t i, min;
+    size_t first, min;
     
     min = min(RING_GetFullSpace(ring), len);
+    first = min(min, ring->size - ring->tail);
+    memcpy(ptr, &ring->buf[ring->tail], first);
+    memcpy(&ptr[first], ring->buf, min - first);
+    ring->tail = RING_FastAdvance(ring, ring->tail, min);
     
-    for (i = 0; i < min; i++) {
-        ptr[i] = ring->buf[ring->tail];
-#ifdef POWER_2_OPTIMIZATION
-        ring->tail = (ring->tail + 1) & (ring->size - 1);
-#else
-        ring->tail = (ring->tail + 1) % ring->size;
-#endif
-    }
-    
-    return i;
+    return min;
 }
 
 /*****************************************************************************
@@ -595,11 +808,7 @@ uint8_t * RING_GetBufferDirectly(RING_DATA * const ring, size_t *toRead, size_t
     
     *toRead = min(readable, size);
     ptr = &ring->buf[ring->tail];
-#ifdef POWER_2_OPTIMIZATION
-    ring->tail = (ring->tail + *toRead) & (ring->size - 1);
-#else
-    ring->tail = (ring->tail + *toRead) % ring->size;
-#endif
+    ring->tail = RING_FastAdvance(ring, ring->tail, *toRead);
     
     return ptr;
 }
@@ -624,20 +833,13 @@ uint8_t * RING_GetBufferDirectly(RING_DATA * const ring, size_t *toRead, size_t
  * Note:            None
  *****************************************************************************/
 size_t RING_PickBytes(const RING_DATA *ring, uint8_t *buf, size_t len) {
-    size_t i, min;
-    size_t tail;
+    size_t first, min;
     
     min = min(RING_GetFullSpace(ring), len);
-    tail = ring->tail;
-    for (i = 0; i < min; i++) {
-        buf[i] = ring->buf[tail];
-#ifdef POWER_2_OPTIMIZATION
-        tail = (tail + 1) & (ring->size - 1);
-#else
-        tail = (tail + 1) % ring->size;
-#endif
-    }
-    return i;
+    first = min(min, ring->size - ring->tail);
+    memcpy(buf, &ring->buf[ring->tail], first);
+    memcpy(&buf[first], ring->buf, min - first);
+    return min;
 }
 
 
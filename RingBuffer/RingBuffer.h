@@ -60,6 +60,14 @@ extern "C" {
     
 #define POWER_2_OPTIMIZATION
     
+#ifdef POWER_2_OPTIMIZATION
+#define RING_DEFAULT_SIZE_POLICY    RING_SIZE_ROUND_DOWN
+#define RING_MAPPED_SIZE_POLICY     RING_SIZE_ROUND_UP      // Untouched pages cost nothing
+#else
+#define RING_DEFAULT_SIZE_POLICY    RING_SIZE_EXACT
+#define RING_MAPPED_SIZE_POLICY     RING_SIZE_EXACT
+#endif
+    
 #ifndef min
 #define min(a,b)    (((a)<(b))?(a):(b))
 #endif
@@ -70,12 +78,20 @@ extern "C" {
     // *****************************************************************************
     // *****************************************************************************
     
+    typedef enum {
+        RING_SIZE_EXACT, // The buffer has the required size
+        RING_SIZE_ROUND_UP, // The buffer has the closest power of 2 not smaller than the required size
+        RING_SIZE_ROUND_DOWN, // The buffer has the closest power of 2 not bigger than the required size
+    } RING_SIZE_POLICY;
+    
     typedef struct {
         uint8_t * buf; // Buffer pointer
         size_t head; // Refers to the first free byte into the buf
         size_t tail; // Refers to the first occupied byte into the buf
         size_t size; // Buffer size. It is always bigger than free bytes
         bool dymamic; // It is true when the user delegates the creation of buf
+        size_t streaming; // Writes of at least this size bypass the cache, 0 never
+        bool mapped; // It is true when buf is an anonymous mapping
     } RING_DATA;
     
     
@@ -87,8 +103,14 @@ extern "C" {
     
     // Initialization functions
     RING_DATA * RING_InitBuffer(const uint8_t *buf, size_t size);
+    RING_DATA * RING_InitBufferWithPolicy(const uint8_t *buf, size_t size, RING_SIZE_POLICY policy);
+    RING_DATA * RING_InitMappedBuffer(size_t size);
+    RING_DATA * RING_InitMappedBufferWithPolicy(size_t size, RING_SIZE_POLICY policy);
     void RING_DeinitializeBuffer(const RING_DATA *ring);
     
+    // Mapped memory functions
+    size_t RING_ReleaseFreePages(const RING_DATA * const ring);
+    
     // Space functions
     size_t RING_GetBufferSize(const RING_DATA * const ring);
     size_t RING_GetFreeSpace(const RING_DATA * const ring);
@@ -96,6 +118,9 @@ extern "C" {
     size_t RING_GetFullSpace(const RING_DATA * const ring);
     size_t RING_GetFullLinearSpace(const RING_DATA * const ring);
     
+    // Copy policy
+    void RING_SetCopyPolicy(RING_DATA * const ring, size_t streaming);
+    
     // Pointers change
     void RING_IncreaseHead(RING_DATA * const ring, size_t count);
     void RING_IncreaseTail(RING_DATA * const ring, size_t count);
@@ -124,6 +149,9 @@ extern "C" {
 }
 #endif
 
+// Header visible fast path
+#include "RingBufferInline.h"
+
 #endif /* _RING_BUFFER_H */
 
 /* *****************************************************************************
@@ -0,0 +1,184 @@
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+ 
+ @File Name
+ RingBufferInline.h
+ 
+ @Author
+ Luca Pascarella https://lucapascarella.com
+ 
+ @Summary
+ These functions are the header visible fast path of the ring buffer.
+ 
+ @Description
+ This file implements the space, pointer and byte accessors as static
+ inline functions. The exported functions of RingBuffer.c are only visible
+ to the linker, therefore, a call from another translation unit cannot be
+ inlined without LTO. Unless RING_NO_FAST_MACROS is defined, the exported
+ names are redirected to these functions and a byte access compiles to a
+ handful of instructions. The exported symbols are still available, e.g.
+ through a function pointer or (RING_AddByte)(ring, val).
+ 
+ @License
+ Copyright (C) 2016 LP Systems
+ 
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+ 
+ https://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+#ifndef _RING_BUFFER_INLINE_H    /* Guard against multiple inclusion */
+#define _RING_BUFFER_INLINE_H
+
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#include "RingBuffer.h"
+
+/* Provide C++ Compatibility */
+#ifdef __cplusplus
+extern "C" {
+#endif
+    
+    
+    // *****************************************************************************
+    // *****************************************************************************
+    // Section: Fast Functions
+    // *****************************************************************************
+    // *****************************************************************************
+    
+    // Index arithmetic, it compares instead of masking or dividing, therefore,
+    // rings of any size share the same code without a branch per byte
+    
+    static inline size_t RING_FastAdvance(const RING_DATA * const ring, size_t index, size_t count) {
+        index += count;
+        return index >= ring->size ? index - ring->size : index;
+    }
+    
+    static inline size_t RING_FastDistance(const RING_DATA * const ring, size_t from, size_t to) {
+        return to >= from ? to - from : to + ring->size - from;
+    }
+    
+    // Space functions, see RING_GetBufferSize() and the followings
+    
+    static inline size_t RING_FastGetBufferSize(const RING_DATA * const ring) {
+        return ring->size;
+    }
+    
+    static inline size_t RING_FastGetFreeSpace(const RING_DATA * const ring) {
+        return ring->size - 1 - RING_FastDistance(ring, ring->tail, ring->head);
+    }
+    
+    static inline size_t RING_FastGetFreeLinearSpace(const RING_DATA * const ring) {
+        if (ring->head >= ring->tail) {
+            if (ring->tail == 0)
+                return ring->size - ring->head - 1;
+            else
+                return ring->size - ring->head;
+        } else {
+            return ring->tail - ring->head - 1;
+        }
+    }
+    
+    static inline size_t RING_FastGetFullSpace(const RING_DATA * const ring) {
+        return RING_FastDistance(ring, ring->tail, ring->head);
+    }
+    
+    static inline size_t RING_FastGetFullLinearSpace(const RING_DATA * const ring) {
+        if (ring->head >= ring->tail)
+            return ring->head - ring->tail;
+        else
+            return ring->size - ring->tail;
+    }
+    
+    // Pointers change
+    
+    static inline void RING_FastIncreaseHead(RING_DATA * const ring, size_t count) {
+        ring->head = RING_FastAdvance(ring, ring->head, count);
+    }
+    
+    static inline void RING_FastIncreaseTail(RING_DATA * const ring, size_t count) {
+        ring->tail = RING_FastAdvance(ring, ring->tail, count);
+    }
+    
+    // Access internal pointers
+    
+    static inline uint8_t * RING_FastGetHeadPointer(const RING_DATA * const ring) {
+        return ring->buf + ring->head;
+    }
+    
+    static inline uint8_t * RING_FastGetTailPointer(const RING_DATA * const ring) {
+        return ring->buf + ring->tail;
+    }
+    
+    // Byte functions
+    
+    static inline bool RING_FastAddByte(RING_DATA * const ring, uint8_t val) {
+        if (RING_FastGetFreeSpace(ring) > 0) {
+            ring->buf[ring->head] = val;
+            RING_FastIncreaseHead(ring, 1);
+            return true;
+        }
+        return false;
+    }
+    
+    static inline bool RING_FastGetByte(RING_DATA * const ring, uint8_t *byte) {
+        if (RING_FastGetFullSpace(ring) > 0) {
+            *byte = ring->buf[ring->tail];
+            RING_FastIncreaseTail(ring, 1);
+            return true;
+        }
+        return false;
+    }
+    
+    static inline uint8_t RING_FastGetByteSimple(RING_DATA * const ring) {
+        uint8_t temp;
+        temp = ring->buf[ring->tail];
+        RING_FastIncreaseTail(ring, 1);
+        return temp;
+    }
+    
+    
+    // *****************************************************************************
+    // *****************************************************************************
+    // Section: Redirections
+    // *****************************************************************************
+    // *****************************************************************************
+    
+#ifndef RING_NO_FAST_MACROS
+#define RING_GetBufferSize(ring)            RING_FastGetBufferSize(ring)
+#define RING_GetFreeSpace(ring)             RING_FastGetFreeSpace(ring)
+#define RING_GetFreeLinearSpace(ring)       RING_FastGetFreeLinearSpace(ring)
+#define RING_GetFullSpace(ring)             RING_FastGetFullSpace(ring)
+#define RING_GetFullLinearSpace(ring)       RING_FastGetFullLinearSpace(ring)
+#define RING_IncreaseHead(ring, count)      RING_FastIncreaseHead(ring, count)
+#define RING_IncreaseTail(ring, count)      RING_FastIncreaseTail(ring, count)
+#define RING_GetHeadPointer(ring)           RING_FastGetHeadPointer(ring)
+#define RING_GetTailPointer(ring)           RING_FastGetTailPointer(ring)
+#define RING_AddByte(ring, val)             RING_FastAddByte(ring, val)
+#define RING_GetByte(ring, byte)            RING_FastGetByte(ring, byte)
+#define RING_GetByteSimple(ring)            RING_FastGetByteSimple(ring)
+#endif
+    
+    
+    /* Provide C++ Compatibility */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RING_BUFFER_INLINE_H */
+
+/* *****************************************************************************
+ End of File
+ */
@@ -0,0 +1,484 @@
+
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+
+ @File Name
+ RingCompact.c
+
+ @Author
+ Luca Pascarella https://lucapascarella.com
+
+ @Summary
+ These functions implement compact rings sharing a pool of storage blocks.
+
+ @Description
+ This file implements rings meant to be kept in millions, e.g. one for each
+ client connection. A ring is a 32 bits handle to a 24 bytes control block
+ allocated from a slab. It has no storage until the first byte is written,
+ then it takes a block of the smallest size class that holds its data from
+ a shared pool, it moves to a bigger block when it grows, and it gives the
+ block back as soon as it drains. Memory follows the bytes in flight
+ instead of the number of rings.
+
+ @License
+ Copyright (C) 2016 LP Systems
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+
+ https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#include <string.h>
+#include "RingCompact.h"
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: File Scope or Global Data                                         */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#define RING_COMPACT_PAGE_SIZE  ((uint32_t) 1 << RING_COMPACT_PAGE_LOG)
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Local Functions                                                   */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+static inline size_t RING_ClassSize(size_t sizeClass) {
+    return (size_t) RING_COMPACT_MIN_BLOCK << sizeClass;
+}
+
+// Returns the smallest class holding size bytes
+
+static size_t RING_ClassOf(size_t size) {
+    size_t sizeClass;
+
+    for (sizeClass = 0; RING_ClassSize(sizeClass) < size; sizeClass++)
+        ;
+    return sizeClass;
+}
+
+static inline RING_COMPACT * RING_GetCompact(const RING_POOL *pool, RING_HANDLE handle) {
+    handle--;
+    return &pool->pages[handle >> RING_COMPACT_PAGE_LOG][handle & (RING_COMPACT_PAGE_SIZE - 1)];
+}
+
+// Returns the control block of a live ring, NULL for a handle never created or destroyed
+
+static inline RING_COMPACT * RING_FindCompact(const RING_POOL *pool, RING_HANDLE handle) {
+    RING_COMPACT *ring;
+
+    if (handle == RING_COMPACT_INVALID || handle >= pool->nextHandle)
+        return NULL;
+    ring = RING_GetCompact(pool, handle);
+    return ring->used ? ring : NULL;
+}
+
+// Obtains memory from malloc, it is released with the pool
+
+static void * RING_PoolChunk(RING_POOL *pool, size_t size) {
+    RING_POOL_CHUNK *chunk;
+
+    if ((chunk = malloc(sizeof (RING_POOL_CHUNK) + size)) == NULL)
+        return NULL;
+    chunk->next = pool->chunks;
+    chunk->size = size;
+    pool->chunks = chunk;
+    return chunk + 1;
+}
+
+static uint8_t * RING_AllocBlock(RING_POOL *pool, size_t sizeClass) {
+    size_t size;
+    void *block;
+
+    size = RING_ClassSize(sizeClass);
+    if ((block = pool->free[sizeClass]) != NULL) {
+        memcpy(&pool->free[sizeClass], block, sizeof (void*));
+    } else if (size < RING_COMPACT_SLAB) {
+        // Small blocks are carved from a slab
+        if (pool->slabLeft[sizeClass] == 0) {
+            if ((pool->slab[sizeClass] = RING_PoolChunk(pool, RING_COMPACT_SLAB)) == NULL)
+                return NULL;
+            pool->slabLeft[sizeClass] = RING_COMPACT_SLAB;
+        }
+        block = pool->slab[sizeClass];
+        pool->slab[sizeClass] += size;
+        pool->slabLeft[sizeClass] -= size;
+    } else if ((block = RING_PoolChunk(pool, size)) == NULL) {
+        return NULL;
+    }
+    pool->inUse += size;
+    return block;
+}
+
+static void RING_FreeBlock(RING_POOL *pool, uint8_t *block, size_t sizeClass) {
+    memcpy(block, &pool->free[sizeClass], sizeof (void*));
+    pool->free[sizeClass] = block;
+    pool->inUse -= RING_ClassSize(sizeClass);
+}
+
+// Moves the data into a block holding at least need bytes, the data starts at 0
+
+static bool RING_GrowCompact(RING_POOL *pool, RING_COMPACT *ring, size_t need) {
+    uint8_t *block;
+    size_t sizeClass, size, first;
+
+    sizeClass = RING_ClassOf(need);
+    if ((block = RING_AllocBlock(pool, sizeClass)) == NULL)
+        return false;
+    if (ring->sizeClass != 0) {
+        size = RING_ClassSize(ring->sizeClass - 1);
+        first = min(ring->count, size - ring->tail);
+        memcpy(block, &ring->buf[ring->tail], first);
+        memcpy(&block[first], ring->buf, ring->count - first);
+        RING_FreeBlock(pool, ring->buf, ring->sizeClass - 1);
+    }
+    ring->buf = block;
+    ring->tail = 0;
+    ring->sizeClass = (uint8_t) (sizeClass + 1);
+    return true;
+}
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Interface Functions                                               */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+/*****************************************************************************
+ * Function:        RING_POOL * RING_InitPool(void)
+
+ * Description:     This function creates an empty pool of compact rings
+
+ * PreCondition:    None
+
+ * Input:           None
+
+ * Return:          Pointer to a RING_POOL type allocated in the dynamic memory
+
+ * Side Effects:    RING_DeinitializePool() must be called to correctly release dynamic memory
+
+ * Overview:        None
+
+ * Note:            The pool is not thread safe, use one pool for each thread
+ *****************************************************************************/
+RING_POOL * RING_InitPool(void) {
+
+    RING_POOL *pool;
+
+    if ((pool = calloc(1, sizeof (RING_POOL))) == NULL)
+        return NULL;
+
+    pool->nextHandle = 1;
+    pool->freeHandle = RING_COMPACT_INVALID;
+
+    return pool;
+}
+
+/*****************************************************************************
+ * Function:        RING_DeinitializePool(RING_POOL *pool)
+
+ * Description:     This function releases the pool with all its rings and blocks
+
+ * PreCondition:    RING_InitPool() must be successfully called
+
+ * Input:           pool the RING_POOL pre-allocated object
+
+ * Return:          None
+
+ * Side Effects:    Dynamic memory will be released, the handles become invalid
+
+ * Overview:        None
+
+ * Note:            None
+ *****************************************************************************/
+void RING_DeinitializePool(RING_POOL *pool) {
+    RING_POOL_CHUNK *chunk;
+    uint32_t i;
+
+    while ((chunk = pool->chunks) != NULL) {
+        pool->chunks = chunk->next;
+        free(chunk);
+    }
+    for (i = 0; i < pool->pageCount; i++)
+        free(pool->pages[i]);
+    free(pool->pages);
+    free(pool);
+}
+
+/*****************************************************************************
+ * Function:        RING_CreateCompact(RING_POOL *pool, size_t capacity)
+
+ * Description:     This function creates a compact ring without storage
+
+ * PreCondition:    RING_InitPool() must be successfully called
+
+ * Input:           pool the RING_POOL pre-allocated object
+ capacity the maximum number of bytes held by the ring
+
+ * Return:          The ring handle, RING_COMPACT_INVALID on failure
+
+ * Side Effects:    None
+
+ * Overview:        Control blocks are allocated in pages and reused after
+ RING_DestroyCompact()
+
+ * Note:            capacity must not exceed RING_COMPACT_MAX_SIZE. Unlike
+ RING_DATA, the whole capacity is usable.
+ *****************************************************************************/
+RING_HANDLE RING_CreateCompact(RING_POOL *pool, size_t capacity) {
+    RING_COMPACT **pages, *ring;
+    RING_HANDLE handle;
+
+    if (capacity == 0 || capacity > RING_COMPACT_MAX_SIZE)
+        return RING_COMPACT_INVALID;
+
+    if ((handle = pool->freeHandle) != RING_COMPACT_INVALID) {
+        ring = RING_GetCompact(pool, handle);
+        pool->freeHandle = ring->tail;
+    } else {
+        if (pool->nextHandle == UINT32_MAX)
+            return RING_COMPACT_INVALID;
+        handle = pool->nextHandle;
+        if (((handle - 1) & (RING_COMPACT_PAGE_SIZE - 1)) == 0) {
+            // First handle of a new page
+            if ((pages = realloc(pool->pages, (pool->pageCount + 1) * sizeof (RING_COMPACT*))) == NULL)
+                return RING_COMPACT_INVALID;
+            pool->pages = pages;
+            if ((pages[pool->pageCount] = malloc(RING_COMPACT_PAGE_SIZE * sizeof (RING_COMPACT))) == NULL)
+                return RING_COMPACT_INVALID;
+            pool->pageCount++;
+        }
+        pool->nextHandle++;
+        ring = RING_GetCompact(pool, handle);
+    }
+
+    ring->buf = NULL;
+    ring->tail = 0;
+    ring->count = 0;
+    ring->capacity = (uint32_t) capacity;
+    ring->sizeClass = 0;
+    ring->used = true;
+
+    return handle;
+}
+
+/*****************************************************************************
+ * Function:        RING_DestroyCompact(RING_POOL *pool, RING_HANDLE handle)
+
+ * Description:     This function releases a compact ring and its storage
+
+ * PreCondition:    RING_CreateCompact() must be successfully called
+
+ * Input:           pool the RING_POOL pre-allocated object
+ handle the ring to release
+
+ * Return:          true if the ring was released, false if the handle was
+ never created or is already destroyed
+
+ * Side Effects:    The handle may be returned again by RING_CreateCompact()
+
+ * Overview:        None
+
+ * Note:            A destroyed handle is rejected by every function until it
+ is returned again by RING_CreateCompact()
+ *****************************************************************************/
+bool RING_DestroyCompact(RING_POOL *pool, RING_HANDLE handle) {
+    RING_COMPACT *ring;
+
+    if ((ring = RING_FindCompact(pool, handle)) == NULL)
+        return false;
+    if (ring->sizeClass != 0)
+        RING_FreeBlock(pool, ring->buf, ring->sizeClass - 1);
+    ring->buf = NULL;
+    ring->sizeClass = 0;
+    ring->count = 0;
+    ring->used = false;
+    ring->tail = pool->freeHandle;
+    pool->freeHandle = handle;
+    return true;
+}
+
+/*****************************************************************************
+ * Function:        RING_GetCompactFullSpace(const RING_POOL *pool, RING_HANDLE handle)
+
+ * Description:     This function returns the number of bytes held by a compact ring
+
+ * PreCondition:    RING_CreateCompact() must be successfully called
+
+ * Input:           pool the RING_POOL pre-allocated object
+ handle the ring
+
+ * Return:          The number of bytes ready to be read, 0 for an invalid handle
+
+ * Side Effects:    None
+
+ * Overview:        None
+
+ * Note:            None
+ *****************************************************************************/
+size_t RING_GetCompactFullSpace(const RING_POOL *pool, RING_HANDLE handle) {
+    const RING_COMPACT *ring;
+
+    if ((ring = RING_FindCompact(pool, handle)) == NULL)
+        return 0;
+    return ring->count;
+}
+
+/*****************************************************************************
+ * Function:        RING_GetCompactFreeSpace(const RING_POOL *pool, RING_HANDLE handle)
+
+ * Description:     This function returns the number of bytes a compact ring can still take
+
+ * PreCondition:    RING_CreateCompact() must be successfully called
+
+ * Input:           pool the RING_POOL pre-allocated object
+ handle the ring
+
+ * Return:          The capacity minus the held bytes, 0 for an invalid handle
+
+ * Side Effects:    None
+
+ * Overview:        None
+
+ * Note:            Writing may still fail when the pool cannot grow the block
+ *****************************************************************************/
+size_t RING_GetCompactFreeSpace(const RING_POOL *pool, RING_HANDLE handle) {
+    const RING_COMPACT *ring;
+
+    if ((ring = RING_FindCompact(pool, handle)) == NULL)
+        return 0;
+    return ring->capacity - ring->count;
+}
+
+/*****************************************************************************
+ * Function:        RING_GetPoolUsage(const RING_POOL *pool)
+
+ * Description:     This function returns the storage held by the rings of the pool
+
+ * PreCondition:    RING_InitPool() must be successfully called
+
+ * Input:           pool the RING_POOL pre-allocated object
+
+ * Return:          The bytes of the blocks currently owned by a ring
+
+ * Side Effects:    None
+
+ * Overview:        Free blocks kept by the pool for reuse are not counted
+
+ * Note:            None
+ *****************************************************************************/
+size_t RING_GetPoolUsage(const RING_POOL *pool) {
+    return pool->inUse;
+}
+
+/*****************************************************************************
+ * Function:        RING_AddCompactBuffer(RING_POOL *pool, RING_HANDLE handle, const uint8_t *buf, size_t size)
+
+ * Description:     This function copies the given buffer into a compact ring
+
+ * PreCondition:    RING_CreateCompact() must be successfully called
+
+ * Input:           pool the RING_POOL pre-allocated object
+ handle the ring
+ buf pointer of the buffer to copy
+ size number of bytes to copy
+
+ * Return:          The number of actual bytes copied
+
+ * Side Effects:    The ring takes or grows its block from the pool
+
+ * Overview:        A block is taken at the first write, the ring moves to the
+ smallest class holding all its bytes when the current one is too small
+
+ * Note:            0 is returned when the pool cannot provide a block or the
+ handle is invalid
+ *****************************************************************************/
+size_t RING_AddCompactBuffer(RING_POOL *pool, RING_HANDLE handle, const uint8_t *buf, size_t size) {
+    RING_COMPACT *ring;
+    size_t writable, blockSize, head, first;
+
+    if ((ring = RING_FindCompact(pool, handle)) == NULL)
+        return 0;
+    writable = min(size, (size_t) (ring->capacity - ring->count));
+    if (writable == 0)
+        return 0;
+
+    if (ring->sizeClass == 0 || RING_ClassSize(ring->sizeClass - 1) < ring->count + writable)
+        if (!RING_GrowCompact(pool, ring, ring->count + writable))
+            return 0;
+
+    blockSize = RING_ClassSize(ring->sizeClass - 1);
+    head = (ring->tail + ring->count) & (blockSize - 1);
+    first = min(writable, blockSize - head);
+    memcpy(&ring->buf[head], buf, first);
+    memcpy(ring->buf, &buf[first], writable - first);
+    ring->count += (uint32_t) writable;
+    return writable;
+}
+
+/*****************************************************************************
+ * Function:        RING_GetCompactBuffer(RING_POOL *pool, RING_HANDLE handle, uint8_t *ptr, size_t len)
+
+ * Description:     This function gets len bytes of a compact ring into user buffer
+
+ * PreCondition:    RING_CreateCompact() must be successfully called
+
+ * Input:           pool the RING_POOL pre-allocated object
+ handle the ring
+ ptr user destination buffer
+ len user destination length
+
+ * Return:          The actual number of got bytes
+
+ * Side Effects:    The block goes back to the pool when the ring drains
+
+ * Overview:        None
+
+ * Note:            0 is returned for an invalid handle
+ *****************************************************************************/
+size_t RING_GetCompactBuffer(RING_POOL *pool, RING_HANDLE handle, uint8_t *ptr, size_t len) {
+    RING_COMPACT *ring;
+    size_t readable, blockSize, first;
+
+    if ((ring = RING_FindCompact(pool, handle)) == NULL)
+        return 0;
+    readable = min(len, (size_t) ring->count);
+    if (readable == 0)
+        return 0;
+
+    blockSize = RING_ClassSize(ring->sizeClass - 1);
+    first = min(readable, blockSize - ring->tail);
+    memcpy(ptr, &ring->buf[ring->tail], first);
+    memcpy(&ptr[first], ring->buf, readable - first);
+    ring->tail = (uint32_t) ((ring->tail + readable) & (blockSize - 1));
+    ring->count -= (uint32_t) readable;
+
+    if (ring->count == 0) {
+        RING_FreeBlock(pool, ring->buf, ring->sizeClass - 1);
+        ring->buf = NULL;
+        ring->tail = 0;
+        ring->sizeClass = 0;
+    }
+    return readable;
+}
+
+
+/* *****************************************************************************
+ End of File
+ */
@@ -0,0 +1,134 @@
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+
+ @File Name
+ RingCompact.h
+
+ @Author
+ Luca Pascarella https://lucapascarella.com
+
+ @Summary
+ These functions implement compact rings sharing a pool of storage blocks.
+
+ @Description
+ This file implements rings meant to be kept in millions, e.g. one for each
+ client connection. A ring is a 32 bits handle to a 24 bytes control block
+ allocated from a slab. It has no storage until the first byte is written,
+ then it takes a block of the smallest size class that holds its data from
+ a shared pool, it moves to a bigger block when it grows, and it gives the
+ block back as soon as it drains. Memory follows the bytes in flight
+ instead of the number of rings.
+
+ @License
+ Copyright (C) 2016 LP Systems
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+
+ https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+#ifndef _RING_COMPACT_H    /* Guard against multiple inclusion */
+#define _RING_COMPACT_H
+
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#include "RingBuffer.h"
+
+/* Provide C++ Compatibility */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+    /* ************************************************************************** */
+    /* ************************************************************************** */
+    /* Section: Constants                                                         */
+    /* ************************************************************************** */
+    /* ************************************************************************** */
+
+#define RING_COMPACT_INVALID        0u          // Never returned as a valid handle
+#define RING_COMPACT_MIN_BLOCK      64u         // Size of the smallest class
+#define RING_COMPACT_CLASSES        26          // Up to 2 GiB blocks
+#define RING_COMPACT_MAX_SIZE       (RING_COMPACT_MIN_BLOCK << (RING_COMPACT_CLASSES - 1))
+#define RING_COMPACT_SLAB           65536u      // Small blocks are carved from slabs of this size
+#define RING_COMPACT_PAGE_LOG       12          // Control blocks in a page, log2
+
+    // *****************************************************************************
+    // *****************************************************************************
+    // Section: Data Types
+    // *****************************************************************************
+    // *****************************************************************************
+
+    typedef uint32_t RING_HANDLE;
+
+    typedef struct {
+        uint8_t *buf; // Storage block, NULL while the ring is empty
+        uint32_t tail; // Refers to the first occupied byte into the buf, next free handle when unused
+        uint32_t count; // Number of occupied bytes
+        uint32_t capacity; // Maximum number of occupied bytes
+        uint8_t sizeClass; // Size class of buf plus one, 0 without storage
+        bool used; // It is true from RING_CreateCompact() to RING_DestroyCompact()
+    } RING_COMPACT;
+
+    typedef struct RING_POOL_CHUNK {
+        struct RING_POOL_CHUNK *next; // Every chunk is released with the pool
+        size_t size; // Usable bytes after the header
+    } RING_POOL_CHUNK;
+
+    typedef struct {
+        void *free[RING_COMPACT_CLASSES]; // Free blocks of each class, linked through their first bytes
+        uint8_t *slab[RING_COMPACT_CLASSES]; // Unused tail of the current slab of each class
+        size_t slabLeft[RING_COMPACT_CLASSES]; // Bytes left in slab
+        RING_POOL_CHUNK *chunks; // Memory obtained from malloc
+        RING_COMPACT **pages; // Control blocks, a handle minus one selects the page and the entry
+        uint32_t pageCount; // Number of pages
+        uint32_t nextHandle; // Next never used handle
+        uint32_t freeHandle; // First released handle, RING_COMPACT_INVALID if none
+        size_t inUse; // Bytes of the blocks held by the rings
+    } RING_POOL;
+
+
+    // *****************************************************************************
+    // *****************************************************************************
+    // Section: Interface Functions
+    // *****************************************************************************
+    // *****************************************************************************
+
+    // Initialization functions
+    RING_POOL * RING_InitPool(void);
+    void RING_DeinitializePool(RING_POOL *pool);
+    RING_HANDLE RING_CreateCompact(RING_POOL *pool, size_t capacity);
+    bool RING_DestroyCompact(RING_POOL *pool, RING_HANDLE handle);
+
+    // Space functions
+    size_t RING_GetCompactFullSpace(const RING_POOL *pool, RING_HANDLE handle);
+    size_t RING_GetCompactFreeSpace(const RING_POOL *pool, RING_HANDLE handle);
+    size_t RING_GetPoolUsage(const RING_POOL *pool);
+
+    // Read and write functions
+    size_t RING_AddCompactBuffer(RING_POOL *pool, RING_HANDLE handle, const uint8_t *buf, size_t size);
+    size_t RING_GetCompactBuffer(RING_POOL *pool, RING_HANDLE handle, uint8_t *ptr, size_t len);
+
+
+    /* Provide C++ Compatibility */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RING_COMPACT_H */
+
+/* *****************************************************************************
+ End of File
+ */
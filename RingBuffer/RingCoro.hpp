@@ -0,0 +1,303 @@
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+
+ @File Name
+ RingCoro.hpp
+
+ @Author
+ Luca Pascarella https://lucapascarella.com
+
+ @Summary
+ These classes implement C++20 coroutine awaitables over a ring buffer.
+
+ @Description
+ This file wraps a RING_DATA object so that coroutines can co_await reads
+ and writes. A coroutine that finds no data, or no space, is suspended
+ and queued on the ring. It is resumed through the executor as soon as
+ the peer commits enough bytes. Awaiters live in the coroutine frame and
+ are linked intrusively, therefore, an operation never allocates. A
+ minimal single-threaded executor is provided as well.
+
+ @License
+ Copyright (C) 2016 LP Systems
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+
+ https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+#ifndef _RING_CORO_HPP    /* Guard against multiple inclusion */
+#define _RING_CORO_HPP
+
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <span>
+
+// The min() macro of RingBuffer.h must not reach the standard headers included later
+#pragma push_macro("min")
+#include "RingBuffer.h"
+#pragma pop_macro("min")
+
+namespace ring {
+
+    // *****************************************************************************
+    // *****************************************************************************
+    // Section: Executor
+    // *****************************************************************************
+    // *****************************************************************************
+
+    // Intrusive node of a suspended coroutine
+
+    struct Waiter {
+        std::coroutine_handle<> handle;
+        Waiter *next = nullptr;
+    };
+
+    // Single-threaded FIFO executor, it never allocates
+
+    class Executor {
+    public:
+        void post(Waiter &waiter) noexcept {
+            waiter.next = nullptr;
+            if (tail_ != nullptr)
+                tail_->next = &waiter;
+            else
+                head_ = &waiter;
+            tail_ = &waiter;
+        }
+
+        // Resumes a single coroutine, returns false when nothing is ready
+        bool runOne() {
+            Waiter *waiter = head_;
+            if (waiter == nullptr)
+                return false;
+            head_ = waiter->next;
+            if (head_ == nullptr)
+                tail_ = nullptr;
+            waiter->handle.resume();
+            return true;
+        }
+
+        void run() {
+            while (runOne())
+                ;
+        }
+
+    private:
+        Waiter *head_ = nullptr;
+        Waiter *tail_ = nullptr;
+    };
+
+    // Eagerly started coroutine whose frame is released on completion
+
+    struct Task {
+
+        struct promise_type {
+            Task get_return_object() noexcept { return {}; }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void() noexcept { }
+            void unhandled_exception() noexcept { std::terminate(); }
+        };
+    };
+
+    // *****************************************************************************
+    // *****************************************************************************
+    // Section: Awaitable Ring
+    // *****************************************************************************
+    // *****************************************************************************
+
+    class AsyncRing {
+    public:
+
+        AsyncRing(RING_DATA *ring, Executor &executor) noexcept : ring_(ring), executor_(executor) { }
+
+        AsyncRing(const AsyncRing &) = delete;
+        AsyncRing & operator=(const AsyncRing &) = delete;
+
+        RING_DATA * get() const noexcept {
+            return ring_;
+        }
+
+        // Common part of the read and write awaiters
+
+        class Operation : public Waiter {
+        public:
+            Operation *nextOp = nullptr;
+
+            std::size_t await_resume() const noexcept {
+                return done_;
+            }
+
+        protected:
+            Operation(AsyncRing &owner, std::size_t size) noexcept : owner_(owner), size_(size) { }
+
+            virtual std::size_t transfer() noexcept = 0;
+
+            bool complete() const noexcept {
+                return done_ == size_;
+            }
+
+            AsyncRing &owner_;
+            std::size_t size_;
+            std::size_t done_ = 0;
+
+            friend class AsyncRing;
+        };
+
+        class ReadAwaiter : public Operation {
+        public:
+            ReadAwaiter(AsyncRing &owner, std::span<std::uint8_t> dst) noexcept : Operation(owner, dst.size()), dst_(dst) { }
+
+            bool await_ready() noexcept {
+                return owner_.ready(*this, owner_.readers_);
+            }
+
+            void await_suspend(std::coroutine_handle<> handle) noexcept {
+                this->handle = handle;
+                owner_.suspend(*this, owner_.readers_);
+            }
+
+        protected:
+            std::size_t transfer() noexcept override {
+                return RING_GetBuffer(owner_.ring_, dst_.data() + done_, size_ - done_);
+            }
+
+        private:
+            std::span<std::uint8_t> dst_;
+        };
+
+        class WriteAwaiter : public Operation {
+        public:
+            WriteAwaiter(AsyncRing &owner, std::span<const std::uint8_t> src) noexcept : Operation(owner, src.size()), src_(src) { }
+
+            bool await_ready() noexcept {
+                return owner_.ready(*this, owner_.writers_);
+            }
+
+            void await_suspend(std::coroutine_handle<> handle) noexcept {
+                this->handle = handle;
+                owner_.suspend(*this, owner_.writers_);
+            }
+
+        protected:
+            std::size_t transfer() noexcept override {
+                return RING_AddBuffer(owner_.ring_, const_cast<std::uint8_t *> (src_.data()) + done_, size_ - done_);
+            }
+
+        private:
+            std::span<const std::uint8_t> src_;
+        };
+
+        // Completes when dst is completely filled
+        ReadAwaiter read(std::span<std::uint8_t> dst) noexcept {
+            return ReadAwaiter(*this, dst);
+        }
+
+        // Completes when src is completely written
+        WriteAwaiter write(std::span<const std::uint8_t> src) noexcept {
+            return WriteAwaiter(*this, src);
+        }
+
+        // Must be called after the ring is changed through the C interface
+        void notify() noexcept {
+            pump();
+        }
+
+    private:
+
+        struct Queue {
+            Operation *first = nullptr;
+            Operation *last = nullptr;
+        };
+
+        // Fast path, it only runs when nobody is queued ahead
+        bool ready(Operation &op, Queue &queue) noexcept {
+            if (queue.first != nullptr)
+                return false;
+            return progress(op);
+        }
+
+        // Any partial progress may unblock the peer
+        bool progress(Operation &op) noexcept {
+            std::size_t moved;
+
+            moved = op.transfer();
+            op.done_ += moved;
+            if (moved > 0 || op.complete())
+                pump();
+            return op.complete();
+        }
+
+        void suspend(Operation &op, Queue &queue) noexcept {
+            op.nextOp = nullptr;
+            if (queue.last != nullptr)
+                queue.last->nextOp = &op;
+            else
+                queue.first = &op;
+            queue.last = &op;
+            pump();
+        }
+
+        // Serves both queues in FIFO order until no more bytes move
+        void pump() noexcept {
+            bool moved;
+
+            if (pumping_)
+                return;
+            pumping_ = true;
+            do {
+                moved = serve(readers_) | serve(writers_);
+            } while (moved);
+            pumping_ = false;
+        }
+
+        bool serve(Queue &queue) noexcept {
+            Operation *op;
+            std::size_t count;
+            bool moved = false;
+
+            while ((op = queue.first) != nullptr) {
+                count = op->transfer();
+                op->done_ += count;
+                moved |= count > 0;
+                if (!op->complete())
+                    break;
+                queue.first = op->nextOp;
+                if (queue.first == nullptr)
+                    queue.last = nullptr;
+                executor_.post(*op);
+            }
+            return moved;
+        }
+
+        RING_DATA *ring_;
+        Executor &executor_;
+        Queue readers_;
+        Queue writers_;
+        bool pumping_ = false;
+    };
+
+}
+
+#endif /* _RING_CORO_HPP */
+
+/* *****************************************************************************
+ End of File
+ */
@@ -0,0 +1,400 @@
+
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+
+ @File Name
+ RingCrc.c
+
+ @Author
+ Luca Pascarella https://lucapascarella.com
+
+ @Summary
+ These functions compute CRC32C checksums over the ring buffer memory.
+
+ @Description
+ This file implements the CRC32C (Castagnoli) checksum over any range of
+ the filled space of a RING_DATA object, in place and across the wrap. The
+ SSE4.2 and ARMv8 crc32 instructions are used when available, otherwise a
+ slicing-by-8 table is used. A running checksum follows the head and
+ covers the new bytes each time it is queried.
+
+ @License
+ Copyright (C) 2016 LP Systems
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+
+ https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#include <stdatomic.h>
+#include <string.h>
+#include "RingCrc.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <nmmintrin.h>
+#define RING_CRC_X86
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define RING_CRC_ARM
+#endif
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: File Scope or Global Data                                         */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#define RING_CRC_POLYNOMIAL     0x82F63B78u  // Castagnoli, reflected
+
+typedef uint32_t (*RING_CRC_UPDATE)(uint32_t crc, const uint8_t *p, size_t len);
+
+static uint32_t RING_CrcTable[8][256];
+static atomic_bool RING_CrcTableReady; // Set once the table is built
+static atomic_flag RING_CrcBuilding = ATOMIC_FLAG_INIT; // Taken by the thread building the table
+static _Atomic(RING_CRC_UPDATE) RING_CrcUpdate; // Selected implementation
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Local Functions                                                   */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+// Slicing-by-8, it works on any architecture
+
+static uint32_t RING_CrcSoftware(uint32_t crc, const uint8_t *p, size_t len) {
+    uint32_t lo, hi;
+
+    while (len >= 8) {
+        lo = crc ^ ((uint32_t) p[0] | (uint32_t) p[1] << 8 | (uint32_t) p[2] << 16 | (uint32_t) p[3] << 24);
+        hi = (uint32_t) p[4] | (uint32_t) p[5] << 8 | (uint32_t) p[6] << 16 | (uint32_t) p[7] << 24;
+        crc = RING_CrcTable[7][lo & 0xFF] ^ RING_CrcTable[6][(lo >> 8) & 0xFF]
+                ^ RING_CrcTable[5][(lo >> 16) & 0xFF] ^ RING_CrcTable[4][lo >> 24]
+                ^ RING_CrcTable[3][hi & 0xFF] ^ RING_CrcTable[2][(hi >> 8) & 0xFF]
+                ^ RING_CrcTable[1][(hi >> 16) & 0xFF] ^ RING_CrcTable[0][hi >> 24];
+        p += 8;
+        len -= 8;
+    }
+    while (len--)
+        crc = (crc >> 8) ^ RING_CrcTable[0][(crc ^ *p++) & 0xFF];
+    return crc;
+}
+
+#if defined(RING_CRC_X86)
+
+__attribute__((target("sse4.2")))
+static uint32_t RING_CrcHardware(uint32_t crc, const uint8_t *p, size_t len) {
+#if defined(__x86_64__)
+    uint64_t crc64, v;
+
+    crc64 = crc;
+    while (len >= 8) {
+        memcpy(&v, p, sizeof (v));
+        crc64 = _mm_crc32_u64(crc64, v);
+        p += 8;
+        len -= 8;
+    }
+    crc = (uint32_t) crc64;
+#endif
+    while (len--)
+        crc = _mm_crc32_u8(crc, *p++);
+    return crc;
+}
+
+#elif defined(RING_CRC_ARM)
+
+static uint32_t RING_CrcHardware(uint32_t crc, const uint8_t *p, size_t len) {
+    uint64_t v;
+
+    while (len >= 8) {
+        memcpy(&v, p, sizeof (v));
+        crc = __crc32cd(crc, v);
+        p += 8;
+        len -= 8;
+    }
+    while (len--)
+        crc = __crc32cb(crc, *p++);
+    return crc;
+}
+
+#endif
+
+// Selects the implementation at the first use, it is safe from any thread
+
+// Builds the slicing-by-8 table once, it is safe from any thread
+
+static void RING_CrcInitTable(void) {
+    uint32_t i, k, crc;
+
+    if (atomic_load_explicit(&RING_CrcTableReady, memory_order_acquire))
+        return;
+
+    // A single thread builds the table, the others wait for it
+    if (atomic_flag_test_and_set_explicit(&RING_CrcBuilding, memory_order_acquire)) {
+        while (!atomic_load_explicit(&RING_CrcTableReady, memory_order_acquire))
+            ;
+        return;
+    }
+
+    for (i = 0; i < 256; i++) {
+        crc = i;
+        for (k = 0; k < 8; k++)
+            crc = (crc >> 1) ^ (RING_CRC_POLYNOMIAL & (0u - (crc & 1)));
+        RING_CrcTable[0][i] = crc;
+    }
+    for (i = 0; i < 256; i++)
+        for (k = 1; k < 8; k++)
+            RING_CrcTable[k][i] = (RING_CrcTable[k - 1][i] >> 8) ^ RING_CrcTable[0][RING_CrcTable[k - 1][i] & 0xFF];
+
+    // The table is complete before any thread can see it ready
+    atomic_store_explicit(&RING_CrcTableReady, true, memory_order_release);
+}
+
+static RING_CRC_UPDATE RING_CrcSelect(void) {
+    RING_CRC_UPDATE update;
+
+    update = atomic_load_explicit(&RING_CrcUpdate, memory_order_acquire);
+    if (update != NULL)
+        return update;
+
+#if defined(RING_CRC_X86)
+    if (__builtin_cpu_supports("sse4.2")) {
+        atomic_store_explicit(&RING_CrcUpdate, RING_CrcHardware, memory_order_release);
+        return RING_CrcHardware;
+    }
+#elif defined(RING_CRC_ARM)
+    atomic_store_explicit(&RING_CrcUpdate, RING_CrcHardware, memory_order_release);
+    return RING_CrcHardware;
+#endif
+
+    RING_CrcInitTable();
+    atomic_store_explicit(&RING_CrcUpdate, RING_CrcSoftware, memory_order_release);
+    return RING_CrcSoftware;
+}
+
+// Checksums count bytes starting at the given index, across the wrap
+
+static uint32_t RING_CrcRange(const RING_DATA * const ring, uint32_t crc, size_t index, size_t count) {
+    RING_CRC_UPDATE update;
+    size_t first;
+
+    update = RING_CrcSelect();
+    first = min(count, ring->size - index);
+    crc = ~update(~crc, &ring->buf[index], first);
+    if (count > first)
+        crc = ~update(~crc, ring->buf, count - first);
+    return crc;
+}
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Interface Functions                                               */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+/*****************************************************************************
+ * Function:        RING_Crc32c(uint32_t crc, const uint8_t *buf, size_t len)
+
+ * Description:     This function updates a CRC32C checksum with a linear buffer
+
+ * PreCondition:    None
+
+ * Input:           crc the checksum of the previous bytes, 0 to start
+ buf the bytes to add
+ len the number of bytes to add
+
+ * Return:          The updated checksum
+
+ * Side Effects:    None
+
+ * Overview:        None
+
+ * Note:            RING_Crc32c(0, "123456789", 9) is 0xE3069283
+ *****************************************************************************/
+uint32_t RING_Crc32c(uint32_t crc, const uint8_t *buf, size_t len) {
+    return ~RING_CrcSelect()(~crc, buf, len);
+}
+
+/*****************************************************************************
+ * Function:        RING_Crc32cSoftware(uint32_t crc, const uint8_t *buf, size_t len)
+
+ * Description:     This function updates a CRC32C checksum with the portable
+ slicing-by-8 implementation
+
+ * PreCondition:    None
+
+ * Input:           crc the checksum of the previous bytes, 0 to start
+ buf the bytes to add
+ len the number of bytes to add
+
+ * Return:          The updated checksum
+
+ * Side Effects:    None
+
+ * Overview:        The table is used even when the CPU has CRC32C instructions
+
+ * Note:            RING_Crc32c() selects the fastest implementation, this one
+ lets the fallback be checked on any host
+ *****************************************************************************/
+uint32_t RING_Crc32cSoftware(uint32_t crc, const uint8_t *buf, size_t len) {
+    RING_CrcInitTable();
+    return ~RING_CrcSoftware(~crc, buf, len);
+}
+
+/*****************************************************************************
+ * Function:        RING_GetCrc32c(const RING_DATA * const ring, size_t offset, size_t len, uint32_t *crc)
+
+ * Description:     This function updates a CRC32C checksum with a range of the filled space
+
+ * PreCondition:    RING_InitBuffer() must be successfully called
+
+ * Input:           ring the RING_DATA pre-allocated object
+ offset the distance of the first byte from the tail
+ len the number of bytes to add
+ crc the checksum of the previous bytes, 0 to start, it receives the updated checksum
+
+ * Return:          true if the range lays into the filled space
+
+ * Side Effects:    None
+
+ * Overview:        The ring memory is read in place, the range may wrap
+
+ * Note:            None
+ *****************************************************************************/
+bool RING_GetCrc32c(const RING_DATA * const ring, size_t offset, size_t len, uint32_t *crc) {
+    size_t start;
+
+    if (offset > RING_GetFullSpace(ring) || len > RING_GetFullSpace(ring) - offset)
+        return false;
+
+    start = ring->tail + offset;
+    if (start >= ring->size)
+        start -= ring->size;
+    *crc = RING_CrcRange(ring, *crc, start, len);
+    return true;
+}
+
+/*****************************************************************************
+ * Function:        RING_CRC * RING_InitCrc(const RING_DATA *ring)
+
+ * Description:     This function creates a running checksum of the bytes written
+ into the ring from now on
+
+ * PreCondition:    RING_InitBuffer() must be successfully called
+
+ * Input:           ring the RING_DATA pre-allocated object
+
+ * Return:          Pointer to a RING_CRC type allocated in the dynamic memory
+
+ * Side Effects:    RING_DeinitializeCrc() must be called to correctly release dynamic memory
+
+ * Overview:        None
+
+ * Note:            None
+ *****************************************************************************/
+RING_CRC * RING_InitCrc(const RING_DATA *ring) {
+
+    RING_CRC *crc;
+
+    if ((crc = malloc(sizeof (RING_CRC))) == NULL)
+        return NULL;
+
+    crc->ring = ring;
+    crc->head = ring->head;
+    crc->crc = 0;
+
+    return crc;
+}
+
+/*****************************************************************************
+ * Function:        RING_DeinitializeCrc(RING_CRC *crc)
+
+ * Description:     This function releases the running checksum
+
+ * PreCondition:    RING_InitCrc() must be successfully called
+
+ * Input:           crc the RING_CRC pre-allocated object
+
+ * Return:          None
+
+ * Side Effects:    Dynamic memory will be released
+
+ * Overview:        None
+
+ * Note:            None
+ *****************************************************************************/
+void RING_DeinitializeCrc(RING_CRC *crc) {
+    free(crc);
+}
+
+/*****************************************************************************
+ * Function:        RING_GetRunningCrc(RING_CRC *crc)
+
+ * Description:     This function adds the bytes written since the last call and
+ returns the running checksum
+
+ * PreCondition:    RING_InitCrc() must be successfully called
+
+ * Input:           crc the RING_CRC pre-allocated object
+
+ * Return:          The checksum of the bytes written since the last reset
+
+ * Side Effects:    None
+
+ * Overview:        Only the new bytes between the last seen head and the current
+ head are read, in place
+
+ * Note:            It must be called before the new bytes are consumed
+ *****************************************************************************/
+uint32_t RING_GetRunningCrc(RING_CRC *crc) {
+    const RING_DATA *ring;
+    size_t count;
+
+    ring = crc->ring;
+    count = RING_FastDistance(ring, crc->head, ring->head);
+    if (count > 0) {
+        crc->crc = RING_CrcRange(ring, crc->crc, crc->head, count);
+        crc->head = ring->head;
+    }
+    return crc->crc;
+}
+
+/*****************************************************************************
+ * Function:        RING_ResetRunningCrc(RING_CRC *crc)
+
+ * Description:     This function restarts the running checksum from the current head
+
+ * PreCondition:    RING_InitCrc() must be successfully called
+
+ * Input:           crc the RING_CRC pre-allocated object
+
+ * Return:          None
+
+ * Side Effects:    None
+
+ * Overview:        None
+
+ * Note:            Typically called at every frame boundary
+ *****************************************************************************/
+void RING_ResetRunningCrc(RING_CRC *crc) {
+    crc->head = crc->ring->head;
+    crc->crc = 0;
+}
+
+
+/* *****************************************************************************
+ End of File
+ */
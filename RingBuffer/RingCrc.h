@@ -0,0 +1,93 @@
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+
+ @File Name
+ RingCrc.h
+
+ @Author
+ Luca Pascarella https://lucapascarella.com
+
+ @Summary
+ These functions compute CRC32C checksums over the ring buffer memory.
+
+ @Description
+ This file implements the CRC32C (Castagnoli) checksum over any range of
+ the filled space of a RING_DATA object, in place and across the wrap. The
+ SSE4.2 and ARMv8 crc32 instructions are used when available, otherwise a
+ slicing-by-8 table is used. A running checksum follows the head and
+ covers the new bytes each time it is queried.
+
+ @License
+ Copyright (C) 2016 LP Systems
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+
+ https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+#ifndef _RING_CRC_H    /* Guard against multiple inclusion */
+#define _RING_CRC_H
+
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#include "RingBuffer.h"
+
+/* Provide C++ Compatibility */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+    // *****************************************************************************
+    // *****************************************************************************
+    // Section: Data Types
+    // *****************************************************************************
+    // *****************************************************************************
+
+    typedef struct {
+        const RING_DATA *ring; // The tracked ring
+        size_t head; // Refers to the first byte not yet checksummed
+        uint32_t crc; // Checksum of the bytes written since the last reset
+    } RING_CRC;
+
+
+    // *****************************************************************************
+    // *****************************************************************************
+    // Section: Interface Functions
+    // *****************************************************************************
+    // *****************************************************************************
+
+    // Checksum functions
+    uint32_t RING_Crc32c(uint32_t crc, const uint8_t *buf, size_t len);
+    uint32_t RING_Crc32cSoftware(uint32_t crc, const uint8_t *buf, size_t len);
+    bool RING_GetCrc32c(const RING_DATA * const ring, size_t offset, size_t len, uint32_t *crc);
+
+    // Running checksum functions
+    RING_CRC * RING_InitCrc(const RING_DATA *ring);
+    void RING_DeinitializeCrc(RING_CRC *crc);
+    uint32_t RING_GetRunningCrc(RING_CRC *crc);
+    void RING_ResetRunningCrc(RING_CRC *crc);
+
+
+    /* Provide C++ Compatibility */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RING_CRC_H */
+
+/* *****************************************************************************
+ End of File
+ */
@@ -0,0 +1,427 @@
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+
+ @File Name
+ RingCursor.h
+
+ @Author
+ Luca Pascarella https://lucapascarella.com
+
+ @Summary
+ These functions decode binary fields straight from the ring buffer memory.
+
+ @Description
+ This file implements a read cursor that starts at the tail and decodes
+ little and big endian integers, LEB128 varints and byte fields without
+ copying the frame out with RING_PickBytes(). A field that does not cross
+ the wrap is read with a single load. The cursor keeps a sticky error, the
+ fields are checked against the frame bounds and the whole frame is either
+ committed or abandoned. All functions are static inline, therefore, a field
+ decode compiles to a few instructions in the caller.
+
+ @License
+ Copyright (C) 2016 LP Systems
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+
+ https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+#ifndef _RING_CURSOR_H    /* Guard against multiple inclusion */
+#define _RING_CURSOR_H
+
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#include <string.h>
+#include "RingBuffer.h"
+
+/* Provide C++ Compatibility */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+    /* ************************************************************************** */
+    /* ************************************************************************** */
+    /* Section: Constants                                                         */
+    /* ************************************************************************** */
+    /* ************************************************************************** */
+
+#define RING_CURSOR_MAX_VARINT      10      // Bytes of a 64 bits LEB128 value
+
+#if defined(__GNUC__)
+#define RING_CURSOR_COLD            __attribute__((noinline, cold, unused))
+#else
+#define RING_CURSOR_COLD
+#endif
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define RING_CURSOR_LE16(x)         __builtin_bswap16(x)
+#define RING_CURSOR_LE32(x)         __builtin_bswap32(x)
+#define RING_CURSOR_LE64(x)         __builtin_bswap64(x)
+#define RING_CURSOR_BE16(x)         (x)
+#define RING_CURSOR_BE32(x)         (x)
+#define RING_CURSOR_BE64(x)         (x)
+#else
+#define RING_CURSOR_LE16(x)         (x)
+#define RING_CURSOR_LE32(x)         (x)
+#define RING_CURSOR_LE64(x)         (x)
+#define RING_CURSOR_BE16(x)         __builtin_bswap16(x)
+#define RING_CURSOR_BE32(x)         __builtin_bswap32(x)
+#define RING_CURSOR_BE64(x)         __builtin_bswap64(x)
+#endif
+
+    // *****************************************************************************
+    // *****************************************************************************
+    // Section: Data Types
+    // *****************************************************************************
+    // *****************************************************************************
+
+    typedef struct {
+        RING_DATA *ring; // Decoded ring
+        size_t index; // Refers to the next byte to decode into the buf
+        size_t offset; // Number of bytes decoded from the tail
+        size_t limit; // Number of bytes of the frame
+        bool error; // It is true once a field exceeds the frame
+    } RING_CURSOR;
+
+
+    // *****************************************************************************
+    // *****************************************************************************
+    // Section: Local Functions
+    // *****************************************************************************
+    // *****************************************************************************
+
+    // Slow path of RING_CursorTake(), kept out of line
+
+    RING_CURSOR_COLD static bool RING_CursorTakeWrapped(RING_CURSOR *cursor, void *dst, size_t n) {
+        const RING_DATA *ring = cursor->ring;
+        uint8_t *p = (uint8_t*) dst;
+        size_t i;
+
+        if (n > cursor->limit - cursor->offset) {
+            cursor->error = true;
+            cursor->offset = cursor->limit;
+            return false;
+        }
+        for (i = 0; i < n; i++) {
+            p[i] = ring->buf[cursor->index];
+            if (++cursor->index == ring->size)
+                cursor->index = 0;
+        }
+        cursor->offset += n;
+        return true;
+    }
+
+    // Copies n bytes of the frame and moves the cursor, false if they exceed the frame
+
+    static inline bool RING_CursorTake(RING_CURSOR *cursor, void *dst, size_t n) {
+        if (n <= cursor->limit - cursor->offset && cursor->index + n < cursor->ring->size) {
+            // Fast path, the field does not reach the end of the buffer
+            memcpy(dst, &cursor->ring->buf[cursor->index], n);
+            cursor->index += n;
+            cursor->offset += n;
+            return true;
+        }
+        return RING_CursorTakeWrapped(cursor, dst, n);
+    }
+
+
+    // *****************************************************************************
+    // *****************************************************************************
+    // Section: Interface Functions
+    // *****************************************************************************
+    // *****************************************************************************
+
+    /*****************************************************************************
+     * Function:        RING_OpenCursor(RING_CURSOR *cursor, RING_DATA * const ring, size_t frame)
+
+     * Description:     This function starts decoding a frame at the tail
+
+     * PreCondition:    RING_InitBuffer() must be successfully called
+
+     * Input:           cursor the RING_CURSOR to initialize, usually on the stack
+     ring the RING_DATA pre-allocated object
+     frame the frame length, 0 to take all the filled space
+
+     * Return:          true if the ring holds the whole frame
+
+     * Side Effects:    None
+
+     * Overview:        The filled space is read once here, the fields are only
+     compared against the frame length
+
+     * Note:            The producer may keep writing, the new bytes are not seen
+     *****************************************************************************/
+    static inline bool RING_OpenCursor(RING_CURSOR *cursor, RING_DATA * const ring, size_t frame) {
+        size_t full;
+
+        full = RING_GetFullSpace(ring);
+        cursor->ring = ring;
+        cursor->index = ring->tail;
+        cursor->offset = 0;
+        cursor->limit = frame == 0 ? full : frame;
+        cursor->error = frame > full;
+        if (cursor->error)
+            cursor->limit = 0;
+        return !cursor->error;
+    }
+
+    /*****************************************************************************
+     * Function:        RING_CursorU8(RING_CURSOR *cursor) and the U16, U32 and
+     U64 readers in little (LE) and big (BE) endian order
+
+     * Description:     These functions decode an unsigned integer and move the cursor
+
+     * PreCondition:    RING_OpenCursor() must be successfully called
+
+     * Input:           cursor the RING_CURSOR object
+
+     * Return:          The decoded value, 0 if it exceeds the frame
+
+     * Side Effects:    The cursor error is set when the field exceeds the frame
+
+     * Overview:        None
+
+     * Note:            Check RING_IsCursorValid() once after the last field
+     *****************************************************************************/
+    static inline uint8_t RING_CursorU8(RING_CURSOR *cursor) {
+        uint8_t v = 0;
+        RING_CursorTake(cursor, &v, sizeof (v));
+        return v;
+    }
+
+    static inline uint16_t RING_CursorU16LE(RING_CURSOR *cursor) {
+        uint16_t v = 0;
+        RING_CursorTake(cursor, &v, sizeof (v));
+        return RING_CURSOR_LE16(v);
+    }
+
+    static inline uint16_t RING_CursorU16BE(RING_CURSOR *cursor) {
+        uint16_t v = 0;
+        RING_CursorTake(cursor, &v, sizeof (v));
+        return RING_CURSOR_BE16(v);
+    }
+
+    static inline uint32_t RING_CursorU32LE(RING_CURSOR *cursor) {
+        uint32_t v = 0;
+        RING_CursorTake(cursor, &v, sizeof (v));
+        return RING_CURSOR_LE32(v);
+    }
+
+    static inline uint32_t RING_CursorU32BE(RING_CURSOR *cursor) {
+        uint32_t v = 0;
+        RING_CursorTake(cursor, &v, sizeof (v));
+        return RING_CURSOR_BE32(v);
+    }
+
+    static inline uint64_t RING_CursorU64LE(RING_CURSOR *cursor) {
+        uint64_t v = 0;
+        RING_CursorTake(cursor, &v, sizeof (v));
+        return RING_CURSOR_LE64(v);
+    }
+
+    static inline uint64_t RING_CursorU64BE(RING_CURSOR *cursor) {
+        uint64_t v = 0;
+        RING_CursorTake(cursor, &v, sizeof (v));
+        return RING_CURSOR_BE64(v);
+    }
+
+    /*****************************************************************************
+     * Function:        RING_CursorVarint(RING_CURSOR *cursor)
+
+     * Description:     This function decodes an unsigned LEB128 value and moves the cursor
+
+     * PreCondition:    RING_OpenCursor() must be successfully called
+
+     * Input:           cursor the RING_CURSOR object
+
+     * Return:          The decoded value, 0 if it is truncated or longer than 10 bytes
+
+     * Side Effects:    The cursor error is set when the value is invalid
+
+     * Overview:        A value that lays in a linear segment of the frame is decoded
+     straight from the ring memory
+
+     * Note:            None
+     *****************************************************************************/
+    static inline uint64_t RING_CursorVarint(RING_CURSOR *cursor) {
+        const RING_DATA *ring = cursor->ring;
+        const uint8_t *p;
+        uint64_t v = 0;
+        size_t i, linear;
+        uint8_t byte;
+
+        linear = min(ring->size - cursor->index, cursor->limit - cursor->offset);
+        if (linear >= RING_CURSOR_MAX_VARINT) {
+            p = &ring->buf[cursor->index];
+            for (i = 0; i < RING_CURSOR_MAX_VARINT; i++) {
+                v |= (uint64_t) (p[i] & 0x7F) << (7 * i);
+                if ((p[i] & 0x80) == 0) {
+                    cursor->index += i + 1;
+                    if (cursor->index == ring->size)
+                        cursor->index = 0;
+                    cursor->offset += i + 1;
+                    return v;
+                }
+            }
+        } else {
+            for (i = 0; i < RING_CURSOR_MAX_VARINT && RING_CursorTake(cursor, &byte, 1); i++) {
+                v |= (uint64_t) (byte & 0x7F) << (7 * i);
+                if ((byte & 0x80) == 0)
+                    return v;
+            }
+        }
+        cursor->error = true;
+        cursor->offset = cursor->limit;
+        return 0;
+    }
+
+    /*****************************************************************************
+     * Function:        RING_CursorBytes(RING_CURSOR *cursor, uint8_t *dst, size_t n)
+
+     * Description:     This function copies a fixed length field, dst may be NULL to skip it
+
+     * PreCondition:    RING_OpenCursor() must be successfully called
+
+     * Input:           cursor the RING_CURSOR object
+     dst the field destination, NULL to skip the field
+     n the field length
+
+     * Return:          true if the field lays into the frame
+
+     * Side Effects:    The cursor error is set when the field exceeds the frame
+
+     * Overview:        None
+
+     * Note:            None
+     *****************************************************************************/
+    static inline bool RING_CursorBytes(RING_CURSOR *cursor, uint8_t *dst, size_t n) {
+        if (dst != NULL)
+            return RING_CursorTake(cursor, dst, n);
+        if (n > cursor->limit - cursor->offset) {
+            cursor->error = true;
+            cursor->offset = cursor->limit;
+            return false;
+        }
+        cursor->index += n;
+        if (cursor->index >= cursor->ring->size)
+            cursor->index -= cursor->ring->size;
+        cursor->offset += n;
+        return true;
+    }
+
+    /*****************************************************************************
+     * Function:        RING_GetCursorRemaining(const RING_CURSOR *cursor)
+
+     * Description:     This function returns the number of undecoded bytes of the frame
+
+     * PreCondition:    RING_OpenCursor() must be successfully called
+
+     * Input:           cursor the RING_CURSOR object
+
+     * Return:          The number of bytes still to decode
+
+     * Side Effects:    None
+
+     * Overview:        None
+
+     * Note:            None
+     *****************************************************************************/
+    static inline size_t RING_GetCursorRemaining(const RING_CURSOR *cursor) {
+        return cursor->limit - cursor->offset;
+    }
+
+    /*****************************************************************************
+     * Function:        RING_IsCursorValid(const RING_CURSOR *cursor)
+
+     * Description:     This function tells whether all the fields decoded so far lay into the frame
+
+     * PreCondition:    RING_OpenCursor() must be successfully called
+
+     * Input:           cursor the RING_CURSOR object
+
+     * Return:          true if no field exceeded the frame
+
+     * Side Effects:    None
+
+     * Overview:        None
+
+     * Note:            None
+     *****************************************************************************/
+    static inline bool RING_IsCursorValid(const RING_CURSOR *cursor) {
+        return !cursor->error;
+    }
+
+    /*****************************************************************************
+     * Function:        RING_CommitCursor(RING_CURSOR *cursor)
+
+     * Description:     This function consumes the decoded bytes from the ring
+
+     * PreCondition:    RING_OpenCursor() must be successfully called
+
+     * Input:           cursor the RING_CURSOR object
+
+     * Return:          true if the frame is consumed, false if a field was invalid
+
+     * Side Effects:    The ring tail moves to the cursor
+
+     * Overview:        Nothing is consumed when a field exceeded the frame
+
+     * Note:            Call RING_CursorBytes(cursor, NULL, n) first to drop the
+     undecoded rest of a frame
+     *****************************************************************************/
+    static inline bool RING_CommitCursor(RING_CURSOR *cursor) {
+        if (cursor->error)
+            return false;
+        cursor->ring->tail = cursor->index;
+        return true;
+    }
+
+    /*****************************************************************************
+     * Function:        RING_AbandonCursor(RING_CURSOR *cursor)
+
+     * Description:     This function rewinds the cursor to the tail
+
+     * PreCondition:    RING_OpenCursor() must be successfully called
+
+     * Input:           cursor the RING_CURSOR object
+
+     * Return:          None
+
+     * Side Effects:    None
+
+     * Overview:        The ring is untouched, the frame can be decoded again once
+     more bytes are received
+
+     * Note:            None
+     *****************************************************************************/
+    static inline void RING_AbandonCursor(RING_CURSOR *cursor) {
+        cursor->index = cursor->ring->tail;
+        cursor->offset = 0;
+        cursor->error = false;
+    }
+
+
+    /* Provide C++ Compatibility */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RING_CURSOR_H */
+
+/* *****************************************************************************
+ End of File
+ */
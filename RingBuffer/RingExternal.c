@@ -0,0 +1,276 @@
+
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+
+ @File Name
+ RingExternal.c
+
+ @Author
+ Luca Pascarella https://lucapascarella.com
+
+ @Summary
+ These functions read a ring filled by an external producer.
+
+ @Description
+ This file implements a consumer view of memory written by a producer that
+ keeps its own write position, e.g. a cycling DMA, a capture buffer mapped
+ from the kernel or another process. The head of the RING_DATA object is
+ refreshed on demand from the producer's index or free running counter and
+ the data is read in place with the usual linear access functions. With a
+ counter, a producer lapping the consumer is detected and the overwritten
+ bytes are skipped and reported as lost.
+ @License
+ Copyright (C) 2016 LP Systems
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+
+ https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#include <stdatomic.h>
+#include "RingExternal.h"
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Local Functions                                                   */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+// Stream position of the producer, a 32 bits counter is extended around the
+// consumer. A 64 bits counter is only accepted where it is read in one access
+
+static uint64_t RING_LoadProduced(const RING_EXTERNAL *external) {
+    uint64_t produced;
+
+    if (external->mode == RING_EXTERNAL_COUNTER64)
+        produced = *(const volatile uint64_t *) external->position;
+    else
+        produced = external->consumed + (uint32_t) (*(const volatile uint32_t *) external->position - (uint32_t) external->consumed);
+    // The bytes are read after the position that covers them
+    atomic_thread_fence(memory_order_acquire);
+    return produced;
+}
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Interface Functions                                               */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+/*****************************************************************************
+ * Function:        RING_EXTERNAL * RING_InitExternal(uint8_t *buf, size_t size, const volatile void *position, RING_EXTERNAL_MODE mode)
+
+ * Description:     This function creates a consumer view of a memory written by
+ an external producer
+
+ * PreCondition:    None
+
+ * Input:           buf the memory written by the producer
+ size the exact size of the memory, it is never rounded
+ position the producer's write index or counter, read at every synchronization
+ mode the meaning and the width of position, the byte of counter value c is at
+ offset c % size
+
+ * Return:          Pointer to a RING_EXTERNAL type allocated in the dynamic memory
+
+ * Side Effects:    RING_DeinitializeExternal() must be called to correctly release dynamic memory
+
+ * Overview:        The view starts empty at the current producer position.
+ A counter mode position must be aligned to its width, so it is read in a
+ single access. RING_EXTERNAL_COUNTER32 requires a power of 2 size.
+ RING_EXTERNAL_COUNTER64 requires a 64 bits platform, NULL is returned otherwise
+
+ * Note:            As every RING_DATA object the view holds at most size - 1
+ bytes, a producer running size bytes ahead already costs the oldest byte.
+ Only the counter modes detect the overruns
+ *****************************************************************************/
+RING_EXTERNAL * RING_InitExternal(uint8_t *buf, size_t size, const volatile void *position, RING_EXTERNAL_MODE mode) {
+
+    RING_EXTERNAL *external;
+    uint64_t produced;
+
+    if (buf == NULL || size < 2 || position == NULL)
+        return NULL;
+
+    // The offset of a 32 bits counter stays consistent across its wrap
+    if (mode == RING_EXTERNAL_COUNTER32 && (size & (size - 1)) != 0)
+        return NULL;
+
+    // A 32 bits platform reads a 64 bits counter in two halves, a producer
+    // carrying between them gives a position off by 4 GiB
+    if (mode == RING_EXTERNAL_COUNTER64 && sizeof (void*) < sizeof (uint64_t))
+        return NULL;
+
+    if ((external = malloc(sizeof (RING_EXTERNAL))) == NULL)
+        return NULL;
+
+    if ((external->ring = RING_InitBufferWithPolicy(buf, size, RING_SIZE_EXACT)) == NULL) {
+        free(external);
+        return NULL;
+    }
+
+    external->mode = mode;
+    external->position = position;
+    external->consumed = 0;
+    external->lost = 0;
+
+    if (mode == RING_EXTERNAL_INDEX32) {
+        external->ring->head = *(const volatile uint32_t *) position % size;
+    } else {
+        produced = RING_LoadProduced(external);
+        external->consumed = produced;
+        external->ring->head = (size_t) (produced % size);
+    }
+    external->ring->tail = external->ring->head;
+    external->tail = external->ring->tail;
+
+    return external;
+}
+
+/*****************************************************************************
+ * Function:        RING_DeinitializeExternal(RING_EXTERNAL *external)
+
+ * Description:     This function releases the view, the external memory is kept
+
+ * PreCondition:    RING_InitExternal() must be successfully called
+
+ * Input:           external the RING_EXTERNAL pre-allocated object
+
+ * Return:          None
+
+ * Side Effects:    Dynamic memory will be released
+
+ * Overview:        None
+
+ * Note:            None
+ *****************************************************************************/
+void RING_DeinitializeExternal(RING_EXTERNAL *external) {
+    RING_DeinitializeBuffer(external->ring);
+    free(external);
+}
+
+/*****************************************************************************
+ * Function:        RING_SyncExternal(RING_EXTERNAL *external)
+
+ * Description:     This function moves the head to the producer's position
+
+ * PreCondition:    RING_InitExternal() must be successfully called
+
+ * Input:           external the RING_EXTERNAL pre-allocated object
+
+ * Return:          The number of bytes overwritten by the producer since the
+ last synchronization
+
+ * Side Effects:    On overrun the tail skips to the oldest byte still held
+
+ * Overview:        The tail moves of the consumer are accounted first, then the
+ producer's lead is compared with the ring capacity. It costs a single read
+ of the position, the data is not touched
+
+ * Note:            Call it before reading, the filled space is then read in
+ place through RING_GetFullLinearSpace(), RING_GetTailPointer() and
+ RING_IncreaseTail() or any other consumer function of external->ring
+ *****************************************************************************/
+size_t RING_SyncExternal(RING_EXTERNAL *external) {
+    RING_DATA *ring = external->ring;
+    uint64_t produced, ahead, lost;
+    size_t index;
+
+    if (external->mode == RING_EXTERNAL_INDEX32) {
+        index = *(const volatile uint32_t *) external->position;
+        atomic_thread_fence(memory_order_acquire);
+        if (index < ring->size)
+            ring->head = index;
+        return 0;
+    }
+
+    external->consumed += RING_FastDistance(ring, external->tail, ring->tail);
+    produced = RING_LoadProduced(external);
+    ahead = produced - external->consumed;
+
+    lost = 0;
+    if (ahead > ring->size - 1) {
+        lost = ahead - (ring->size - 1);
+        external->consumed += lost;
+        external->lost += lost;
+        ring->tail = (size_t) (external->consumed % ring->size);
+        ahead = ring->size - 1;
+    }
+    external->tail = ring->tail;
+    ring->head = RING_FastAdvance(ring, ring->tail, (size_t) ahead);
+
+    return (size_t) lost;
+}
+
+/*****************************************************************************
+ * Function:        RING_IsExternalIntact(const RING_EXTERNAL *external)
+
+ * Description:     This function checks that the bytes from the tail on were not
+ overwritten in the meantime
+
+ * PreCondition:    RING_SyncExternal() must be called before reading
+
+ * Input:           external the RING_EXTERNAL pre-allocated object
+
+ * Return:          true if the producer did not reach the bytes not yet consumed
+
+ * Side Effects:    None
+
+ * Overview:        Call it after copying or parsing in place and before moving
+ the tail, a false result means the data just read may be torn and must be
+ discarded. The next RING_SyncExternal() accounts the loss
+
+ * Note:            It always returns true in RING_EXTERNAL_INDEX32 mode
+ *****************************************************************************/
+bool RING_IsExternalIntact(const RING_EXTERNAL *external) {
+    uint64_t produced, consumed;
+
+    if (external->mode == RING_EXTERNAL_INDEX32)
+        return true;
+
+    // The reads of the data complete before the position is read again
+    atomic_thread_fence(memory_order_acquire);
+    produced = RING_LoadProduced(external);
+    consumed = external->consumed + RING_FastDistance(external->ring, external->tail, external->ring->tail);
+    return produced - consumed <= external->ring->size;
+}
+
+/*****************************************************************************
+ * Function:        RING_GetExternalLost(const RING_EXTERNAL *external)
+
+ * Description:     This function returns the total number of lost bytes
+
+ * PreCondition:    RING_InitExternal() must be successfully called
+
+ * Input:           external the RING_EXTERNAL pre-allocated object
+
+ * Return:          The bytes overwritten before being read since the creation
+
+ * Side Effects:    None
+
+ * Overview:        None
+
+ * Note:            None
+ *****************************************************************************/
+uint64_t RING_GetExternalLost(const RING_EXTERNAL *external) {
+    return external->lost;
+}
+
+
+/* *****************************************************************************
+ End of File
+ */
@@ -0,0 +1,101 @@
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+
+ @File Name
+ RingExternal.h
+
+ @Author
+ Luca Pascarella https://lucapascarella.com
+
+ @Summary
+ These functions read a ring filled by an external producer.
+
+ @Description
+ This file implements a consumer view of memory written by a producer that
+ keeps its own write position, e.g. a cycling DMA, a capture buffer mapped
+ from the kernel or another process. The head of the RING_DATA object is
+ refreshed on demand from the producer's index or free running counter and
+ the data is read in place with the usual linear access functions. With a
+ counter, a producer lapping the consumer is detected and the overwritten
+ bytes are skipped and reported as lost.
+ @License
+ Copyright (C) 2016 LP Systems
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+
+ https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+#ifndef _RING_EXTERNAL_H    /* Guard against multiple inclusion */
+#define _RING_EXTERNAL_H
+
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#include "RingBuffer.h"
+
+/* Provide C++ Compatibility */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+    // *****************************************************************************
+    // *****************************************************************************
+    // Section: Data Types
+    // *****************************************************************************
+    // *****************************************************************************
+
+    typedef enum {
+        RING_EXTERNAL_INDEX32, // 32 bits write index into the memory, laps are not visible
+        RING_EXTERNAL_COUNTER32, // 32 bits free running count of written bytes
+        RING_EXTERNAL_COUNTER64, // 64 bits free running count of written bytes, 64 bits platforms only
+    } RING_EXTERNAL_MODE;
+
+    typedef struct {
+        RING_DATA *ring; // View of the external memory, the consumer moves its tail
+        RING_EXTERNAL_MODE mode; // Meaning and width of the producer's position
+        const volatile void *position; // Producer's write position
+        uint64_t consumed; // Stream position of the tail
+        size_t tail; // Tail seen at the last synchronization
+        uint64_t lost; // Bytes overwritten before being read
+    } RING_EXTERNAL;
+
+
+    // *****************************************************************************
+    // *****************************************************************************
+    // Section: Interface Functions
+    // *****************************************************************************
+    // *****************************************************************************
+
+    // Initialization functions
+    RING_EXTERNAL * RING_InitExternal(uint8_t *buf, size_t size, const volatile void *position, RING_EXTERNAL_MODE mode);
+    void RING_DeinitializeExternal(RING_EXTERNAL *external);
+
+    // Synchronization functions
+    size_t RING_SyncExternal(RING_EXTERNAL *external);
+    bool RING_IsExternalIntact(const RING_EXTERNAL *external);
+    uint64_t RING_GetExternalLost(const RING_EXTERNAL *external);
+
+
+    /* Provide C++ Compatibility */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RING_EXTERNAL_H */
+
+/* *****************************************************************************
+ End of File
+ */
@@ -0,0 +1,340 @@
+
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+
+ @File Name
+ RingFanIn.c
+
+ @Author
+ Luca Pascarella https://lucapascarella.com
+
+ @Summary
+ These functions implement a multi-producer single-consumer fan-in of rings.
+
+ @Description
+ This file implements an aggregator that gives each producer its own ring.
+ Producers never share a ring, therefore, they never contend. A single
+ consumer drains all the rings in a round-robin order serving at most a
+ quantum of bytes from each ring per pass. A shared bitmap marks the rings
+ that may hold data, so the consumer skips idle producers cheaply.
+
+ @License
+ Copyright (C) 2016 LP Systems
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+
+ https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#include <string.h>
+#include "RingFanIn.h"
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: File Scope or Global Data                                         */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#define RING_FANIN_WORD_BITS    64
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Local Functions                                                   */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+// Serves at most a quantum of bytes from a single producer ring
+
+static size_t RING_ServeFanIn(RING_FANIN *fanin, size_t producer, RING_FANIN_SINK sink, void *ctx) {
+    RING_DATA *ring;
+    RING_FANIN_INDEX *index;
+    uint_least64_t bit;
+    size_t word, served, chunk, head, tail;
+
+    ring = fanin->rings[producer];
+    index = &fanin->index[producer];
+    word = producer / RING_FANIN_WORD_BITS;
+    bit = (uint_least64_t) 1 << (producer % RING_FANIN_WORD_BITS);
+
+    // Clear before reading, a producer adding afterwards will set it again. The
+    // fence pairs with the producer one: either the head loads below see its
+    // bytes or the producer sees the bit cleared
+    atomic_fetch_and_explicit(&fanin->pending[word], ~bit, memory_order_acq_rel);
+    atomic_thread_fence(memory_order_seq_cst);
+
+    tail = atomic_load_explicit(&index->tail, memory_order_relaxed);
+    served = 0;
+    while (served < fanin->quantum) {
+        // The bytes are read after the head that covers them
+        head = atomic_load_explicit(&index->head, memory_order_acquire);
+        chunk = min((head >= tail) ? head - tail : ring->size - tail, fanin->quantum - served);
+        if (chunk == 0)
+            break;
+        sink(ctx, producer, &ring->buf[tail], chunk);
+        tail += chunk;
+        if (tail == ring->size)
+            tail = 0;
+        // The sink is done with the bytes before the producer reuses them
+        atomic_store_explicit(&index->tail, tail, memory_order_release);
+        served += chunk;
+    }
+
+    // The quantum is over but the producer is still ahead
+    if (atomic_load_explicit(&index->head, memory_order_relaxed) != tail)
+        atomic_fetch_or_explicit(&fanin->pending[word], bit, memory_order_release);
+
+    return served;
+}
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Interface Functions                                               */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+/*****************************************************************************
+ * Function:        RING_FANIN * RING_InitFanIn(size_t count, size_t size, size_t quantum)
+
+ * Description:     This function creates a RING_FANIN object with a dynamically
+ allocated ring for each producer
+
+ * PreCondition:    None
+
+ * Input:           count the number of producers
+ size the size of each producer ring, it follows the RING_InitBuffer() rounding
+ quantum the maximum number of bytes served from a ring in a single pass
+
+ * Return:          Pointer to a RING_FANIN type allocated in the dynamic memory
+
+ * Side Effects:    RING_DeinitializeFanIn() must be called to correctly release dynamic memory
+
+ * Overview:        None
+
+ * Note:            None
+ *****************************************************************************/
+RING_FANIN * RING_InitFanIn(size_t count, size_t size, size_t quantum) {
+
+    RING_FANIN *fanin;
+    size_t i;
+
+    if (count == 0 || size == 0 || quantum == 0)
+        return NULL;
+
+    if ((fanin = malloc(sizeof (RING_FANIN))) == NULL)
+        return NULL;
+
+    fanin->count = count;
+    fanin->quantum = quantum;
+    fanin->next = 0;
+    fanin->words = (count + RING_FANIN_WORD_BITS - 1) / RING_FANIN_WORD_BITS;
+    fanin->rings = calloc(count, sizeof (RING_DATA*));
+    fanin->index = aligned_alloc(RING_FANIN_CACHE_LINE, count * sizeof (RING_FANIN_INDEX));
+    fanin->pending = malloc(fanin->words * sizeof (atomic_uint_least64_t));
+    if (fanin->rings == NULL || fanin->index == NULL || fanin->pending == NULL) {
+        free(fanin->rings);
+        free(fanin->index);
+        free(fanin->pending);
+        free(fanin);
+        return NULL;
+    }
+
+    for (i = 0; i < fanin->words; i++)
+        atomic_init(&fanin->pending[i], 0);
+    for (i = 0; i < count; i++) {
+        atomic_init(&fanin->index[i].head, 0);
+        atomic_init(&fanin->index[i].tail, 0);
+    }
+
+    for (i = 0; i < count; i++) {
+        if ((fanin->rings[i] = RING_InitBuffer(NULL, size)) == NULL) {
+            RING_DeinitializeFanIn(fanin);
+            return NULL;
+        }
+    }
+
+    return fanin;
+}
+
+/*****************************************************************************
+ * Function:        RING_DeinitializeFanIn(RING_FANIN *fanin)
+
+ * Description:     This function releases the producer rings and the fan-in itself
+
+ * PreCondition:    RING_InitFanIn() must be successfully called
+
+ * Input:           fanin the RING_FANIN pre-allocated object
+
+ * Return:          None
+
+ * Side Effects:    Dynamic memory will be released
+
+ * Overview:        None
+
+ * Note:            None
+ *****************************************************************************/
+void RING_DeinitializeFanIn(RING_FANIN *fanin) {
+    size_t i;
+
+    for (i = 0; i < fanin->count; i++)
+        if (fanin->rings[i] != NULL)
+            RING_DeinitializeBuffer(fanin->rings[i]);
+    free(fanin->rings);
+    free(fanin->index);
+    free(fanin->pending);
+    free(fanin);
+}
+
+/*****************************************************************************
+ * Function:        RING_AddFanInBuffer(RING_FANIN *fanin, size_t producer, uint8_t *buf, size_t size)
+
+ * Description:     This function copies the given buffer into the producer ring
+ and flags it as pending
+
+ * PreCondition:    RING_InitFanIn() must be successfully called
+
+ * Input:           fanin the RING_FANIN pre-allocated object
+ producer the index of the calling producer
+ buf pointer of the buffer to copy
+ size number of bytes to copy
+
+ * Return:          The number of actual bytes copied
+
+ * Side Effects:    None
+
+ * Overview:        None
+
+ * Note:            Each producer index must be used by a single thread
+ *****************************************************************************/
+size_t RING_AddFanInBuffer(RING_FANIN *fanin, size_t producer, uint8_t *buf, size_t size) {
+    RING_DATA *ring;
+    RING_FANIN_INDEX *index;
+    atomic_uint_least64_t *pending;
+    uint_least64_t bit;
+    size_t added, first, head, tail;
+
+    ring = fanin->rings[producer];
+    index = &fanin->index[producer];
+    head = atomic_load_explicit(&index->head, memory_order_relaxed);
+    // The bytes are overwritten after the tail that freed them
+    tail = atomic_load_explicit(&index->tail, memory_order_acquire);
+
+    // One byte is always kept free as in RING_DATA
+    added = min((tail > head) ? tail - head - 1 : ring->size - head + tail - 1, size);
+    first = min(added, ring->size - head);
+    memcpy(&ring->buf[head], buf, first);
+    memcpy(ring->buf, &buf[first], added - first);
+    head += added;
+    if (head >= ring->size)
+        head -= ring->size;
+    // The bytes are visible before the head that covers them
+    atomic_store_explicit(&index->head, head, memory_order_release);
+
+    if (added > 0) {
+        pending = &fanin->pending[producer / RING_FANIN_WORD_BITS];
+        bit = (uint_least64_t) 1 << (producer % RING_FANIN_WORD_BITS);
+        // A bit already set needs no write, so the shared word is not taken
+        // exclusively on every add. The consumer clears a bit and then reads the
+        // head, the producer stores the head and then reads the bit, the two
+        // fences order both sides: a bit seen set is cleared, if ever, by a
+        // consumer that then reads the new head
+        atomic_thread_fence(memory_order_seq_cst);
+        if ((atomic_load_explicit(pending, memory_order_relaxed) & bit) == 0)
+            atomic_fetch_or_explicit(pending, bit, memory_order_release);
+    }
+
+    return added;
+}
+
+/*****************************************************************************
+ * Function:        RING_IsFanInPending(const RING_FANIN *fanin)
+
+ * Description:     This function checks whether any producer ring may hold data
+
+ * PreCondition:    RING_InitFanIn() must be successfully called
+
+ * Input:           fanin the RING_FANIN pre-allocated object
+
+ * Return:          true if at least one ring is flagged as pending
+
+ * Side Effects:    None
+
+ * Overview:        Only the bitmap is read, the rings are not touched
+
+ * Note:            None
+ *****************************************************************************/
+bool RING_IsFanInPending(const RING_FANIN *fanin) {
+    size_t i;
+
+    for (i = 0; i < fanin->words; i++)
+        if (atomic_load_explicit(&fanin->pending[i], memory_order_relaxed) != 0)
+            return true;
+    return false;
+}
+
+/*****************************************************************************
+ * Function:        RING_DrainFanIn(RING_FANIN *fanin, RING_FANIN_SINK sink, void *ctx)
+
+ * Description:     This function performs a single round-robin pass over the
+ pending rings passing at most a quantum of bytes of each ring to the sink
+
+ * PreCondition:    RING_InitFanIn() must be successfully called
+
+ * Input:           fanin the RING_FANIN pre-allocated object
+ sink the function receiving the linear chunks in place
+ ctx the user context passed to the sink
+
+ * Return:          The number of bytes passed to the sink
+
+ * Side Effects:    The sink is called with the producer index and a pointer into its ring
+
+ * Overview:        The pass starts after the last served ring, so every producer
+ gets the same share of a busy consumer
+
+ * Note:            Must be called by a single consumer thread
+ *****************************************************************************/
+size_t RING_DrainFanIn(RING_FANIN *fanin, RING_FANIN_SINK sink, void *ctx) {
+    uint_least64_t bits;
+    size_t n, word, first, offset, producer, total;
+
+    total = 0;
+    first = fanin->next / RING_FANIN_WORD_BITS;
+    offset = fanin->next % RING_FANIN_WORD_BITS;
+
+    // Visit the first word twice: upper bits first, lower bits at the end
+    for (n = 0; n <= fanin->words; n++) {
+        word = (first + n) % fanin->words;
+        bits = atomic_load_explicit(&fanin->pending[word], memory_order_acquire);
+        if (n == 0)
+            bits &= ~(uint_least64_t) 0 << offset;
+        else if (n == fanin->words)
+            bits &= ((uint_least64_t) 1 << offset) - 1;
+
+        while (bits != 0) {
+            producer = word * RING_FANIN_WORD_BITS + (size_t) __builtin_ctzll(bits);
+            bits &= bits - 1;
+            total += RING_ServeFanIn(fanin, producer, sink, ctx);
+            fanin->next = (producer + 1) % fanin->count;
+        }
+    }
+
+    return total;
+}
+
+
+/* *****************************************************************************
+ End of File
+ */
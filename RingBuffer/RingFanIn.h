@@ -0,0 +1,118 @@
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+
+ @File Name
+ RingFanIn.h
+
+ @Author
+ Luca Pascarella https://lucapascarella.com
+
+ @Summary
+ These functions implement a multi-producer single-consumer fan-in of rings.
+
+ @Description
+ This file implements an aggregator that gives each producer its own ring.
+ Producers never share a ring, therefore, they never contend. A single
+ consumer drains all the rings in a round-robin order serving at most a
+ quantum of bytes from each ring per pass. A shared bitmap marks the rings
+ that may hold data, so the consumer skips idle producers cheaply.
+
+ @License
+ Copyright (C) 2016 LP Systems
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+
+ https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+#ifndef _RING_FAN_IN_H    /* Guard against multiple inclusion */
+#define _RING_FAN_IN_H
+
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#include <stdatomic.h>
+#include "RingBuffer.h"
+
+/* Provide C++ Compatibility */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+    /* ************************************************************************** */
+    /* ************************************************************************** */
+    /* Section: Constants                                                         */
+    /* ************************************************************************** */
+    /* ************************************************************************** */
+
+#ifndef RING_FANIN_CACHE_LINE
+#define RING_FANIN_CACHE_LINE   64      // Alignment of the producer positions
+#endif
+
+    // *****************************************************************************
+    // *****************************************************************************
+    // Section: Data Types
+    // *****************************************************************************
+    // *****************************************************************************
+
+    // Called by the consumer for each linear chunk of a producer ring
+    typedef void (*RING_FANIN_SINK)(void *ctx, size_t producer, const uint8_t *buf, size_t len);
+
+    // Positions of a producer ring shared by the producer and the consumer, each
+    // pair has its own cache line so producers do not contend with each other
+    typedef struct {
+        _Alignas(RING_FANIN_CACHE_LINE) atomic_size_t head; // Written by the producer only
+        atomic_size_t tail; // Written by the consumer only
+    } RING_FANIN_INDEX;
+
+    typedef struct {
+        RING_DATA **rings; // Memory of each producer ring, their head and tail are not used
+        RING_FANIN_INDEX *index; // Positions of each producer ring
+        size_t count; // Number of producers
+        size_t quantum; // Maximum number of bytes served from a ring per pass
+        size_t next; // Round-robin position of the consumer
+        size_t words; // Number of bitmap words
+        atomic_uint_least64_t *pending; // One bit for each ring that may hold data
+    } RING_FANIN;
+
+
+    // *****************************************************************************
+    // *****************************************************************************
+    // Section: Interface Functions
+    // *****************************************************************************
+    // *****************************************************************************
+
+    // Initialization functions
+    RING_FANIN * RING_InitFanIn(size_t count, size_t size, size_t quantum);
+    void RING_DeinitializeFanIn(RING_FANIN *fanin);
+
+    // Producer functions
+    size_t RING_AddFanInBuffer(RING_FANIN *fanin, size_t producer, uint8_t *buf, size_t size);
+
+    // Consumer functions
+    bool RING_IsFanInPending(const RING_FANIN *fanin);
+    size_t RING_DrainFanIn(RING_FANIN *fanin, RING_FANIN_SINK sink, void *ctx);
+
+
+    /* Provide C++ Compatibility */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RING_FAN_IN_H */
+
+/* *****************************************************************************
+ End of File
+ */
@@ -0,0 +1,493 @@
+
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+
+ @File Name
+ RingFraming.c
+
+ @Author
+ Luca Pascarella https://lucapascarella.com
+
+ @Summary
+ These functions implement SLIP and COBS framing stages over ring buffers.
+
+ @Description
+ This file implements a decoder that scans the filled segments of a ring
+ for frame delimiters, decodes the complete frames run by run and appends
+ them to a message ring, each one preceded by its 16 bits length. The
+ encoder writes a framed message straight into the free space of a ring.
+ Delimiters and escapes are searched a block at a time instead of calling
+ RING_GetByte() for every byte.
+
+ @License
+ Copyright (C) 2016 LP Systems
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+
+ https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#include <string.h>
+#include "RingFraming.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: File Scope or Global Data                                         */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#define RING_SLIP_END           0xC0
+#define RING_SLIP_ESC           0xDB
+#define RING_SLIP_ESC_END       0xDC
+#define RING_SLIP_ESC_ESC       0xDD
+
+#define RING_COBS_DELIMITER     0x00
+#define RING_COBS_MAX_RUN       254
+
+typedef struct {
+    RING_DATA *ring; // Ring being written
+    size_t index; // Refers to the next byte to write
+    size_t count; // Number of bytes written so far
+} RING_FRAMING_WRITER;
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Local Functions                                                   */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+// Converts a distance from the tail into a buffer index
+
+static inline size_t RING_FramingIndex(const RING_DATA * const ring, size_t offset) {
+    size_t index;
+
+    index = ring->tail + offset;
+    if (index >= ring->size)
+        index -= ring->size;
+    return index;
+}
+
+static inline uint8_t RING_FramingByte(const RING_DATA * const ring, size_t offset) {
+    return ring->buf[RING_FramingIndex(ring, offset)];
+}
+
+// Returns the distance from the tail of the first delimiter in [from, end), end if none
+
+static size_t RING_FramingFind(const RING_DATA * const ring, uint8_t delimiter, size_t from, size_t end) {
+    const uint8_t *p;
+    size_t start, first;
+
+    if (from >= end)
+        return end;
+    start = RING_FramingIndex(ring, from);
+    first = min(end - from, ring->size - start);
+    if ((p = memchr(&ring->buf[start], delimiter, first)) != NULL)
+        return from + (size_t) (p - &ring->buf[start]);
+    if (end - from > first && (p = memchr(ring->buf, delimiter, end - from - first)) != NULL)
+        return from + first + (size_t) (p - ring->buf);
+    return end;
+}
+
+// Returns the index of the first byte equal to a or b, len if none
+
+static size_t RING_FramingSpan(const uint8_t *p, size_t len, uint8_t a, uint8_t b) {
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    __m128i va, vb, v;
+    int mask;
+
+    va = _mm_set1_epi8((char) a);
+    vb = _mm_set1_epi8((char) b);
+    for (; i + 16 <= len; i += 16) {
+        v = _mm_loadu_si128((const __m128i *) &p[i]);
+        mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, va), _mm_cmpeq_epi8(v, vb)));
+        if (mask != 0)
+            return i + (size_t) __builtin_ctz((unsigned) mask);
+    }
+#endif
+    for (; i < len; i++)
+        if (p[i] == a || p[i] == b)
+            return i;
+    return len;
+}
+
+static void RING_FramingPut(RING_FRAMING_WRITER *writer, const uint8_t *p, size_t n) {
+    RING_DATA *ring;
+    size_t first;
+
+    ring = writer->ring;
+    first = min(n, ring->size - writer->index);
+    memcpy(&ring->buf[writer->index], p, first);
+    memcpy(ring->buf, p + first, n - first);
+    writer->index += n;
+    if (writer->index >= ring->size)
+        writer->index -= ring->size;
+    writer->count += n;
+}
+
+static void RING_FramingPutByte(RING_FRAMING_WRITER *writer, uint8_t byte) {
+    RING_FramingPut(writer, &byte, 1);
+}
+
+// Copies n bytes of the source starting at offset from the tail, across the wrap
+
+static void RING_FramingCopy(RING_FRAMING_WRITER *writer, const RING_DATA * const src, size_t offset, size_t n) {
+    size_t start, first;
+
+    start = RING_FramingIndex(src, offset);
+    first = min(n, src->size - start);
+    RING_FramingPut(writer, &src->buf[start], first);
+    if (n > first)
+        RING_FramingPut(writer, src->buf, n - first);
+}
+
+// Decodes the len bytes of a SLIP frame body, copying the runs between escapes
+
+static bool RING_FramingDecodeSlip(RING_FRAMING_WRITER *writer, const RING_DATA * const src, size_t len) {
+    size_t offset, escape;
+    uint8_t byte;
+
+    offset = 0;
+    while (offset < len) {
+        escape = RING_FramingFind(src, RING_SLIP_ESC, offset, len);
+        RING_FramingCopy(writer, src, offset, escape - offset);
+        if ((offset = escape) == len)
+            break;
+        if (offset + 1 == len)
+            return false;
+        byte = RING_FramingByte(src, offset + 1);
+        if (byte == RING_SLIP_ESC_END)
+            RING_FramingPutByte(writer, RING_SLIP_END);
+        else if (byte == RING_SLIP_ESC_ESC)
+            RING_FramingPutByte(writer, RING_SLIP_ESC);
+        else
+            return false;
+        offset += 2;
+    }
+    return true;
+}
+
+// Decodes the len bytes of a COBS frame body, copying one code block at a time
+
+static bool RING_FramingDecodeCobs(RING_FRAMING_WRITER *writer, const RING_DATA * const src, size_t len) {
+    size_t offset, run;
+    uint8_t code;
+
+    offset = 0;
+    while (offset < len) {
+        code = RING_FramingByte(src, offset++);
+        run = (size_t) code - 1;
+        if (run > len - offset)
+            return false;
+        RING_FramingCopy(writer, src, offset, run);
+        offset += run;
+        if (code != 0xFF && offset < len)
+            RING_FramingPutByte(writer, 0x00);
+    }
+    return true;
+}
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Interface Functions                                               */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+/*****************************************************************************
+ * Function:        RING_FRAMING * RING_InitFraming(RING_FRAMING_TYPE type, size_t maxFrame)
+
+ * Description:     This function creates the state of a framing stage
+
+ * PreCondition:    None
+
+ * Input:           type the framing protocol
+ maxFrame the maximum decoded frame size, 0 for RING_FRAME_MAX_SIZE
+
+ * Return:          Pointer to a RING_FRAMING type allocated in the dynamic memory
+
+ * Side Effects:    RING_DeinitializeFraming() must be called to correctly release dynamic memory
+
+ * Overview:        None
+
+ * Note:            maxFrame is clamped to RING_FRAME_MAX_SIZE
+ *****************************************************************************/
+RING_FRAMING * RING_InitFraming(RING_FRAMING_TYPE type, size_t maxFrame) {
+
+    RING_FRAMING *framing;
+
+    if (type != RING_FRAMING_SLIP && type != RING_FRAMING_COBS)
+        return NULL;
+
+    if ((framing = malloc(sizeof (RING_FRAMING))) == NULL)
+        return NULL;
+
+    framing->type = type;
+    framing->maxFrame = (maxFrame == 0 || maxFrame > RING_FRAME_MAX_SIZE) ? RING_FRAME_MAX_SIZE : maxFrame;
+    framing->scanned = 0;
+    framing->dropping = false;
+    framing->errors = 0;
+
+    return framing;
+}
+
+/*****************************************************************************
+ * Function:        RING_DeinitializeFraming(RING_FRAMING *framing)
+
+ * Description:     This function releases the state of a framing stage
+
+ * PreCondition:    RING_InitFraming() must be successfully called
+
+ * Input:           framing the RING_FRAMING pre-allocated object
+
+ * Return:          None
+
+ * Side Effects:    Dynamic memory will be released
+
+ * Overview:        None
+
+ * Note:            None
+ *****************************************************************************/
+void RING_DeinitializeFraming(RING_FRAMING *framing) {
+    free(framing);
+}
+
+/*****************************************************************************
+ * Function:        RING_DecodeFrames(RING_FRAMING *framing, RING_DATA * const msg, RING_DATA * const src)
+
+ * Description:     This function decodes the complete frames of the source ring
+ and appends them to the message ring
+
+ * PreCondition:    RING_InitFraming() must be successfully called
+
+ * Input:           framing the RING_FRAMING pre-allocated object
+ msg the RING_DATA receiving the decoded messages
+ src the RING_DATA holding the encoded stream
+
+ * Return:          The number of messages appended to msg
+
+ * Side Effects:    The decoded frames and their delimiters are consumed from src
+
+ * Overview:        Each message is a 16 bits little endian length followed by
+ the decoded bytes, RING_GetFrame() reads it back. Bytes after the last
+ delimiter stay in src and they are not scanned again at the next call.
+
+ * Note:            Empty frames are skipped. Invalid and oversized frames are
+ dropped and counted in errors. Decoding stops when msg has less free space
+ than the length prefix plus the encoded frame, src is left untouched from
+ that frame on, therefore, msg must be larger than twice maxFrame.
+ *****************************************************************************/
+size_t RING_DecodeFrames(RING_FRAMING *framing, RING_DATA * const msg, RING_DATA * const src) {
+    RING_FRAMING_WRITER writer;
+    size_t full, end, limit, frames;
+    uint8_t delimiter, header[RING_FRAME_HEADER_SIZE];
+    bool valid;
+
+    if (framing->type == RING_FRAMING_SLIP) {
+        delimiter = RING_SLIP_END;
+        limit = 2 * framing->maxFrame;
+    } else {
+        delimiter = RING_COBS_DELIMITER;
+        limit = framing->maxFrame + framing->maxFrame / RING_COBS_MAX_RUN + 1;
+    }
+
+    frames = 0;
+    for (;;) {
+        full = RING_GetFullSpace(src);
+        end = RING_FramingFind(src, delimiter, framing->scanned, full);
+
+        if (end == full) {
+            // No delimiter yet, give up the frame when it can no longer be valid
+            framing->scanned = full;
+            if (full > limit || (full > 0 && RING_GetFreeSpace(src) == 0)) {
+                if (!framing->dropping)
+                    framing->errors++;
+                framing->dropping = true;
+                RING_IncreaseTail(src, full);
+                framing->scanned = 0;
+            }
+            break;
+        }
+
+        if (framing->dropping || end == 0) {
+            // Tail of a dropped frame or empty frame
+            framing->dropping = false;
+            RING_IncreaseTail(src, end + 1);
+            framing->scanned = 0;
+            continue;
+        }
+
+        // A decoded frame is never longer than its encoding
+        if (end <= limit && RING_GetFreeSpace(msg) < RING_FRAME_HEADER_SIZE + end) {
+            framing->scanned = end;
+            break;
+        }
+
+        writer.ring = msg;
+        writer.index = msg->head + RING_FRAME_HEADER_SIZE;
+        if (writer.index >= msg->size)
+            writer.index -= msg->size;
+        writer.count = 0;
+        if (end > limit) {
+            valid = false;
+        } else {
+            if (framing->type == RING_FRAMING_SLIP)
+                valid = RING_FramingDecodeSlip(&writer, src, end);
+            else
+                valid = RING_FramingDecodeCobs(&writer, src, end);
+        }
+
+        if (valid && writer.count <= framing->maxFrame) {
+            header[0] = (uint8_t) writer.count;
+            header[1] = (uint8_t) (writer.count >> 8);
+            writer.index = msg->head;
+            RING_FramingPut(&writer, header, RING_FRAME_HEADER_SIZE);
+            RING_IncreaseHead(msg, writer.count);
+            frames++;
+        } else {
+            framing->errors++;
+        }
+        RING_IncreaseTail(src, end + 1);
+        framing->scanned = 0;
+    }
+
+    return frames;
+}
+
+/*****************************************************************************
+ * Function:        RING_EncodeFrame(const RING_FRAMING *framing, RING_DATA * const dst, const uint8_t *frame, size_t len)
+
+ * Description:     This function encodes a frame into the free space of a ring
+
+ * PreCondition:    RING_InitFraming() must be successfully called
+
+ * Input:           framing the RING_FRAMING pre-allocated object
+ dst the RING_DATA receiving the encoded stream
+ frame the bytes to encode
+ len the number of bytes to encode
+
+ * Return:          true if the whole encoded frame has been written
+
+ * Side Effects:    None
+
+ * Overview:        The encoded bytes are written in place after the head and the
+ head is moved once, the frame is terminated by its delimiter
+
+ * Note:            Nothing is written when dst has not enough free space
+ *****************************************************************************/
+bool RING_EncodeFrame(const RING_FRAMING *framing, RING_DATA * const dst, const uint8_t *frame, size_t len) {
+    RING_FRAMING_WRITER writer;
+    const uint8_t *zero;
+    size_t offset, run, total;
+
+    writer.ring = dst;
+    writer.index = dst->head;
+    writer.count = 0;
+
+    if (framing->type == RING_FRAMING_SLIP) {
+        total = len + 1;
+        for (offset = 0; (offset += RING_FramingSpan(&frame[offset], len - offset, RING_SLIP_END, RING_SLIP_ESC)) < len; offset++)
+            total++;
+        if (RING_GetFreeSpace(dst) < total)
+            return false;
+
+        offset = 0;
+        while (offset < len) {
+            run = RING_FramingSpan(&frame[offset], len - offset, RING_SLIP_END, RING_SLIP_ESC);
+            RING_FramingPut(&writer, &frame[offset], run);
+            if ((offset += run) == len)
+                break;
+            RING_FramingPutByte(&writer, RING_SLIP_ESC);
+            RING_FramingPutByte(&writer, frame[offset] == RING_SLIP_END ? RING_SLIP_ESC_END : RING_SLIP_ESC_ESC);
+            offset++;
+        }
+        RING_FramingPutByte(&writer, RING_SLIP_END);
+    } else {
+        // Worst case, the exact size would need a second scan
+        if (RING_GetFreeSpace(dst) < len + len / RING_COBS_MAX_RUN + 2)
+            return false;
+
+        offset = 0;
+        for (;;) {
+            run = min(len - offset, RING_COBS_MAX_RUN);
+            if ((zero = memchr(&frame[offset], 0x00, run)) != NULL) {
+                run = (size_t) (zero - &frame[offset]);
+                RING_FramingPutByte(&writer, (uint8_t) (run + 1));
+                RING_FramingPut(&writer, &frame[offset], run);
+                offset += run + 1;
+            } else {
+                RING_FramingPutByte(&writer, (uint8_t) (run + 1));
+                RING_FramingPut(&writer, &frame[offset], run);
+                offset += run;
+                if (run < RING_COBS_MAX_RUN)
+                    break;
+            }
+        }
+        RING_FramingPutByte(&writer, RING_COBS_DELIMITER);
+    }
+
+    RING_IncreaseHead(dst, writer.count);
+    return true;
+}
+
+/*****************************************************************************
+ * Function:        RING_GetFrame(RING_DATA * const msg, uint8_t *buf, size_t size, size_t *len)
+
+ * Description:     This function reads a decoded message
+
+ * PreCondition:    RING_DecodeFrames() must be called to fill msg
+
+ * Input:           msg the RING_DATA holding the decoded messages
+ buf the destination of the message
+ size the size of buf
+ len it receives the length of the message
+
+ * Return:          true if a message has been read
+
+ * Side Effects:    The message is consumed from msg
+
+ * Overview:        None
+
+ * Note:            len may exceed size, in that case only size bytes are copied
+ and the rest of the message is discarded
+ *****************************************************************************/
+bool RING_GetFrame(RING_DATA * const msg, uint8_t *buf, size_t size, size_t *len) {
+    uint8_t header[RING_FRAME_HEADER_SIZE];
+    size_t length;
+
+    if (RING_PickBytes(msg, header, RING_FRAME_HEADER_SIZE) < RING_FRAME_HEADER_SIZE)
+        return false;
+    length = (size_t) header[0] | (size_t) header[1] << 8;
+    if (RING_GetFullSpace(msg) < RING_FRAME_HEADER_SIZE + length)
+        return false;
+
+    RING_IncreaseTail(msg, RING_FRAME_HEADER_SIZE);
+    RING_GetBuffer(msg, buf, min(length, size));
+    if (length > size)
+        RING_IncreaseTail(msg, length - size);
+    *len = length;
+    return true;
+}
+
+
+/* *****************************************************************************
+ End of File
+ */
@@ -0,0 +1,110 @@
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+
+ @File Name
+ RingFraming.h
+
+ @Author
+ Luca Pascarella https://lucapascarella.com
+
+ @Summary
+ These functions implement SLIP and COBS framing stages over ring buffers.
+
+ @Description
+ This file implements a decoder that scans the filled segments of a ring
+ for frame delimiters, decodes the complete frames run by run and appends
+ them to a message ring, each one preceded by its 16 bits length. The
+ encoder writes a framed message straight into the free space of a ring.
+ Delimiters and escapes are searched a block at a time instead of calling
+ RING_GetByte() for every byte.
+
+ @License
+ Copyright (C) 2016 LP Systems
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+
+ https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+#ifndef _RING_FRAMING_H    /* Guard against multiple inclusion */
+#define _RING_FRAMING_H
+
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#include "RingBuffer.h"
+
+/* Provide C++ Compatibility */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+    /* ************************************************************************** */
+    /* ************************************************************************** */
+    /* Section: Constants                                                         */
+    /* ************************************************************************** */
+    /* ************************************************************************** */
+
+#define RING_FRAME_HEADER_SIZE      2       // Length prefix of a message
+#define RING_FRAME_MAX_SIZE         0xFFFF
+
+    // *****************************************************************************
+    // *****************************************************************************
+    // Section: Data Types
+    // *****************************************************************************
+    // *****************************************************************************
+
+    typedef enum {
+        RING_FRAMING_SLIP, // RFC 1055, 0xC0 terminated
+        RING_FRAMING_COBS, // Consistent Overhead Byte Stuffing, 0x00 terminated
+    } RING_FRAMING_TYPE;
+
+    typedef struct {
+        RING_FRAMING_TYPE type; // Framing protocol
+        size_t maxFrame; // Maximum decoded frame size
+        size_t scanned; // Bytes after the tail already known to be delimiter free
+        bool dropping; // It is true while an oversized frame is skipped
+        size_t errors; // Number of dropped frames
+    } RING_FRAMING;
+
+
+    // *****************************************************************************
+    // *****************************************************************************
+    // Section: Interface Functions
+    // *****************************************************************************
+    // *****************************************************************************
+
+    // Initialization functions
+    RING_FRAMING * RING_InitFraming(RING_FRAMING_TYPE type, size_t maxFrame);
+    void RING_DeinitializeFraming(RING_FRAMING *framing);
+
+    // Stage functions
+    size_t RING_DecodeFrames(RING_FRAMING *framing, RING_DATA * const msg, RING_DATA * const src);
+    bool RING_EncodeFrame(const RING_FRAMING *framing, RING_DATA * const dst, const uint8_t *frame, size_t len);
+
+    // Message functions
+    bool RING_GetFrame(RING_DATA * const msg, uint8_t *buf, size_t size, size_t *len);
+
+
+    /* Provide C++ Compatibility */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RING_FRAMING_H */
+
+/* *****************************************************************************
+ End of File
+ */
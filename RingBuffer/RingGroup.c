@@ -0,0 +1,310 @@
+
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+
+ @File Name
+ RingGroup.c
+
+ @Author
+ Luca Pascarella https://lucapascarella.com
+
+ @Summary
+ These functions implement a group of ring buffers sharded per worker.
+
+ @Description
+ This file implements a set of RING_DATA objects, one for each worker core.
+ Producers push into their local shard while consumers drain their own shard
+ first and steal batches from the other shards when it is empty. An optional
+ pair of lock callbacks protects each shard when it is shared among threads.
+
+ @License
+ Copyright (C) 2016 LP Systems
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+
+ https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#include "RingGroup.h"
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Local Functions                                                   */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+static inline void RING_LockShard(const RING_GROUP *group, size_t shard) {
+    if (group->lock != NULL)
+        group->lock(group->ctx, shard);
+}
+
+static inline void RING_UnlockShard(const RING_GROUP *group, size_t shard) {
+    if (group->unlock != NULL)
+        group->unlock(group->ctx, shard);
+}
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Interface Functions                                               */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+/*****************************************************************************
+ * Function:        RING_GROUP * RING_InitGroup(size_t count, size_t size, size_t batch)
+
+ * Description:     This function creates a RING_GROUP object made of count
+ dynamically allocated rings of the given size
+
+ * PreCondition:    None
+
+ * Input:           count the number of shards, usually one for each worker core
+ size the size of each shard, it follows the RING_InitBuffer() rounding
+ batch the maximum number of bytes stolen from a remote shard
+
+ * Return:          Pointer to a RING_GROUP type allocated in the dynamic memory
+
+ * Side Effects:    RING_DeinitializeGroup() must be called to correctly release dynamic memory
+
+ * Overview:        None
+
+ * Note:            A batch of 0 disables work stealing
+ *****************************************************************************/
+RING_GROUP * RING_InitGroup(size_t count, size_t size, size_t batch) {
+
+    RING_GROUP *group;
+    size_t i;
+
+    if (count == 0 || size == 0)
+        return NULL;
+
+    if ((group = malloc(sizeof (RING_GROUP))) == NULL)
+        return NULL;
+
+    if ((group->shards = calloc(count, sizeof (RING_DATA*))) == NULL) {
+        free(group);
+        return NULL;
+    }
+
+    group->count = count;
+    group->batch = batch;
+    group->lock = NULL;
+    group->unlock = NULL;
+    group->ctx = NULL;
+
+    for (i = 0; i < count; i++) {
+        if ((group->shards[i] = RING_InitBuffer(NULL, size)) == NULL) {
+            RING_DeinitializeGroup(group);
+            return NULL;
+        }
+    }
+
+    return group;
+}
+
+/*****************************************************************************
+ * Function:        RING_DeinitializeGroup(RING_GROUP *group)
+
+ * Description:     This function releases the shards and the group itself
+
+ * PreCondition:    RING_InitGroup() must be successfully called
+
+ * Input:           group the RING_GROUP pre-allocated object
+
+ * Return:          None
+
+ * Side Effects:    Dynamic memory will be released
+
+ * Overview:        None
+
+ * Note:            None
+ *****************************************************************************/
+void RING_DeinitializeGroup(RING_GROUP *group) {
+    size_t i;
+
+    for (i = 0; i < group->count; i++)
+        if (group->shards[i] != NULL)
+            RING_DeinitializeBuffer(group->shards[i]);
+    free(group->shards);
+    free(group);
+}
+
+/*****************************************************************************
+ * Function:        RING_SetGroupLock(RING_GROUP *group, RING_GROUP_LOCK lock, RING_GROUP_LOCK unlock, void *ctx)
+
+ * Description:     This function installs the callbacks used to serialize the
+ access to a single shard
+
+ * PreCondition:    RING_InitGroup() must be successfully called
+
+ * Input:           group the RING_GROUP pre-allocated object
+ lock the function called before touching a shard
+ unlock the function called after touching a shard
+ ctx the user context passed to both callbacks
+
+ * Return:          None
+
+ * Side Effects:    None
+
+ * Overview:        None
+
+ * Note:            Without callbacks each shard must be accessed by a single thread,
+ therefore, work stealing must be disabled or externally serialized
+ *****************************************************************************/
+void RING_SetGroupLock(RING_GROUP *group, RING_GROUP_LOCK lock, RING_GROUP_LOCK unlock, void *ctx) {
+    group->lock = lock;
+    group->unlock = unlock;
+    group->ctx = ctx;
+}
+
+/*****************************************************************************
+ * Function:        RING_GetGroupFullSpace(const RING_GROUP *group)
+
+ * Description:     This function returns the filled space of all the shards
+
+ * PreCondition:    RING_InitGroup() must be successfully called
+
+ * Input:           group the RING_GROUP pre-allocated object
+
+ * Return:          The number of filled bytes
+
+ * Side Effects:    None
+
+ * Overview:        None
+
+ * Note:            The value is a snapshot, shards are locked one at a time
+ *****************************************************************************/
+size_t RING_GetGroupFullSpace(const RING_GROUP *group) {
+    size_t i, full;
+
+    full = 0;
+    for (i = 0; i < group->count; i++) {
+        RING_LockShard(group, i);
+        full += RING_GetFullSpace(group->shards[i]);
+        RING_UnlockShard(group, i);
+    }
+    return full;
+}
+
+/*****************************************************************************
+ * Function:        RING_IsGroupEmpty(const RING_GROUP *group)
+
+ * Description:     This function checks whether all the shards are empty
+
+ * PreCondition:    RING_InitGroup() must be successfully called
+
+ * Input:           group the RING_GROUP pre-allocated object
+
+ * Return:          true if no shard holds data
+
+ * Side Effects:    None
+
+ * Overview:        None
+
+ * Note:            It stops at the first non-empty shard, shards are locked one
+ at a time
+ *****************************************************************************/
+bool RING_IsGroupEmpty(const RING_GROUP *group) {
+    size_t i;
+    bool empty;
+
+    empty = true;
+    for (i = 0; i < group->count && empty; i++) {
+        RING_LockShard(group, i);
+        empty = (RING_GetFullSpace(group->shards[i]) == 0);
+        RING_UnlockShard(group, i);
+    }
+    return empty;
+}
+
+/*****************************************************************************
+ * Function:        RING_AddGroupBuffer(RING_GROUP *group, size_t shard, uint8_t *buf, size_t size)
+
+ * Description:     This function copies the given buffer into the local shard
+
+ * PreCondition:    RING_InitGroup() must be successfully called
+
+ * Input:           group the RING_GROUP pre-allocated object
+ shard the index of the producer's local shard
+ buf pointer of the buffer to copy
+ size number of bytes to copy
+
+ * Return:          The number of actual bytes copied
+
+ * Side Effects:    None
+
+ * Overview:        None
+
+ * Note:            Producers never spill into remote shards
+ *****************************************************************************/
+size_t RING_AddGroupBuffer(RING_GROUP *group, size_t shard, uint8_t *buf, size_t size) {
+    size_t added;
+
+    RING_LockShard(group, shard);
+    added = RING_AddBuffer(group->shards[shard], buf, size);
+    RING_UnlockShard(group, shard);
+
+    return added;
+}
+
+/*****************************************************************************
+ * Function:        RING_GetGroupBuffer(RING_GROUP *group, size_t shard, uint8_t *ptr, size_t len)
+
+ * Description:     This function gets up to len bytes from the local shard. When
+ the local shard is empty, a single batch is stolen from the next non-empty shard
+
+ * PreCondition:    RING_InitGroup() must be successfully called
+
+ * Input:           group the RING_GROUP pre-allocated object
+ shard the index of the consumer's local shard
+ ptr user destination buffer
+ len user destination length
+
+ * Return:          the actual number of got bytes
+
+ * Side Effects:    None
+
+ * Overview:        Victims are visited starting from the next shard to spread the stealing load
+
+ * Note:            Stolen bytes keep their order within the victim shard only
+ *****************************************************************************/
+size_t RING_GetGroupBuffer(RING_GROUP *group, size_t shard, uint8_t *ptr, size_t len) {
+    size_t i, victim, got;
+
+    RING_LockShard(group, shard);
+    got = RING_GetBuffer(group->shards[shard], ptr, len);
+    RING_UnlockShard(group, shard);
+
+    if (got > 0 || group->batch == 0)
+        return got;
+
+    for (i = 1; i < group->count; i++) {
+        victim = (shard + i) % group->count;
+        // An empty victim only costs a lock, its owner may be writing it
+        RING_LockShard(group, victim);
+        got = RING_GetBuffer(group->shards[victim], ptr, min(group->batch, len));
+        RING_UnlockShard(group, victim);
+        if (got > 0)
+            break;
+    }
+
+    return got;
+}
+
+
+/* *****************************************************************************
+ End of File
+ */
@@ -0,0 +1,99 @@
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+
+ @File Name
+ RingGroup.h
+
+ @Author
+ Luca Pascarella https://lucapascarella.com
+
+ @Summary
+ These functions implement a group of ring buffers sharded per worker.
+
+ @Description
+ This file implements a set of RING_DATA objects, one for each worker core.
+ Producers push into their local shard while consumers drain their own shard
+ first and steal batches from the other shards when it is empty. An optional
+ pair of lock callbacks protects each shard when it is shared among threads.
+
+ @License
+ Copyright (C) 2016 LP Systems
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+
+ https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+#ifndef _RING_GROUP_H    /* Guard against multiple inclusion */
+#define _RING_GROUP_H
+
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#include "RingBuffer.h"
+
+/* Provide C++ Compatibility */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+    // *****************************************************************************
+    // *****************************************************************************
+    // Section: Data Types
+    // *****************************************************************************
+    // *****************************************************************************
+
+    typedef void (*RING_GROUP_LOCK)(void *ctx, size_t shard);
+
+    typedef struct {
+        RING_DATA **shards; // One ring for each worker
+        size_t count; // Number of shards
+        size_t batch; // Maximum number of bytes stolen from a remote shard
+        RING_GROUP_LOCK lock; // Optional shard lock, NULL when not shared
+        RING_GROUP_LOCK unlock; // Optional shard unlock, NULL when not shared
+        void *ctx; // User context passed to lock and unlock
+    } RING_GROUP;
+
+
+    // *****************************************************************************
+    // *****************************************************************************
+    // Section: Interface Functions
+    // *****************************************************************************
+    // *****************************************************************************
+
+    // Initialization functions
+    RING_GROUP * RING_InitGroup(size_t count, size_t size, size_t batch);
+    void RING_DeinitializeGroup(RING_GROUP *group);
+    void RING_SetGroupLock(RING_GROUP *group, RING_GROUP_LOCK lock, RING_GROUP_LOCK unlock, void *ctx);
+
+    // Space functions
+    size_t RING_GetGroupFullSpace(const RING_GROUP *group);
+    bool RING_IsGroupEmpty(const RING_GROUP *group);
+
+    // Write and read functions
+    size_t RING_AddGroupBuffer(RING_GROUP *group, size_t shard, uint8_t *buf, size_t size);
+    size_t RING_GetGroupBuffer(RING_GROUP *group, size_t shard, uint8_t *ptr, size_t len);
+
+
+    /* Provide C++ Compatibility */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RING_GROUP_H */
+
+/* *****************************************************************************
+ End of File
+ */
@@ -0,0 +1,349 @@
+
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+
+ @File Name
+ RingLanes.c
+
+ @Author
+ Luca Pascarella https://lucapascarella.com
+
+ @Summary
+ These functions implement prioritized lanes of ring buffers.
+
+ @Description
+ This file implements a queue made of several RING_DATA objects, one for
+ each class of traffic. The consumer drains the lanes in strict priority
+ order, lanes sharing a priority are served by deficit round-robin with a
+ byte quantum proportional to their weight. A bitmap ordered by priority
+ marks the lanes that may hold data, so the emptiness check is a single
+ load and the next lane to serve is found with a bit scan.
+ @License
+ Copyright (C) 2016 LP Systems
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+
+ https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#include <string.h>
+#include "RingLanes.h"
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Local Functions                                                   */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+static inline uint_least64_t RING_LaneBit(size_t rank) {
+    return (uint_least64_t) 1 << rank;
+}
+
+// Next pending rank after the given one, wrapping inside the priority
+
+static inline size_t RING_NextLane(uint_least64_t mask, size_t rank) {
+    uint_least64_t after;
+
+    after = mask & ((~(uint_least64_t) 0 << rank) << 1);
+    return (size_t) __builtin_ctzll(after != 0 ? after : mask);
+}
+
+// Filled space of a lane seen by the consumer, the bytes before the head are visible
+
+static inline size_t RING_LaneFullSpace(RING_LANE *lane) {
+    size_t head;
+
+    head = atomic_load_explicit(&lane->head, memory_order_acquire);
+    return RING_FastDistance(lane->ring, atomic_load_explicit(&lane->tail, memory_order_relaxed), head);
+}
+
+// Passes at most count bytes of a lane to the sink
+
+static size_t RING_ServeLane(RING_LANE *lane, size_t count, RING_LANES_SINK sink, void *ctx) {
+    RING_DATA *ring;
+    size_t served, chunk, head, tail;
+
+    ring = lane->ring;
+    tail = atomic_load_explicit(&lane->tail, memory_order_relaxed);
+    served = 0;
+    while (served < count) {
+        // The bytes are read after the head that covers them
+        head = atomic_load_explicit(&lane->head, memory_order_acquire);
+        chunk = min((head >= tail) ? head - tail : ring->size - tail, count - served);
+        if (chunk == 0)
+            break;
+        sink(ctx, lane->lane, &ring->buf[tail], chunk);
+        tail = RING_FastAdvance(ring, tail, chunk);
+        // The sink is done with the bytes before the producer reuses them
+        atomic_store_explicit(&lane->tail, tail, memory_order_release);
+        served += chunk;
+    }
+    return served;
+}
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Interface Functions                                               */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+/*****************************************************************************
+ * Function:        RING_LANES * RING_InitLanes(const RING_LANE_CONFIG *config, size_t count)
+
+ * Description:     This function creates a RING_LANES object with a dynamically
+ allocated ring for each lane
+
+ * PreCondition:    None
+
+ * Input:           config the size, priority and weight of each lane
+ count the number of lanes, at most RING_LANES_MAX
+
+ * Return:          Pointer to a RING_LANES type allocated in the dynamic memory
+
+ * Side Effects:    RING_DeinitializeLanes() must be called to correctly release dynamic memory
+
+ * Overview:        The lanes are ranked by decreasing priority, the user index
+ order is kept among lanes of the same priority
+
+ * Note:            The weight of a lane must not be 0
+ *****************************************************************************/
+RING_LANES * RING_InitLanes(const RING_LANE_CONFIG *config, size_t count) {
+
+    RING_LANES *lanes;
+    RING_LANE *lane;
+    size_t i, k, rank;
+
+    if (count == 0 || count > RING_LANES_MAX)
+        return NULL;
+    for (i = 0; i < count; i++)
+        if (config[i].size == 0 || config[i].weight == 0)
+            return NULL;
+
+    if ((lanes = malloc(sizeof (RING_LANES))) == NULL)
+        return NULL;
+
+    lanes->count = count;
+    lanes->lanes = calloc(count, sizeof (RING_LANE));
+    lanes->ranks = malloc(count * sizeof (size_t));
+    if (lanes->lanes == NULL || lanes->ranks == NULL) {
+        free(lanes->lanes);
+        free(lanes->ranks);
+        free(lanes);
+        return NULL;
+    }
+    atomic_init(&lanes->pending, 0);
+
+    // Stable insertion by decreasing priority
+    for (i = 0; i < count; i++) {
+        for (rank = i; rank > 0 && config[lanes->lanes[rank - 1].lane].priority < config[i].priority; rank--)
+            lanes->lanes[rank] = lanes->lanes[rank - 1];
+        lanes->lanes[rank].lane = i;
+    }
+
+    for (rank = 0; rank < count; rank++) {
+        lane = &lanes->lanes[rank];
+        lane->weight = config[lane->lane].weight;
+        lane->deficit = 0;
+        lanes->ranks[lane->lane] = rank;
+        if (rank > 0 && config[lanes->lanes[rank - 1].lane].priority == config[lane->lane].priority)
+            lane->first = lanes->lanes[rank - 1].first;
+        else
+            lane->first = rank;
+        lane->turn = rank;
+        lanes->lanes[lane->first].level |= RING_LaneBit(rank);
+    }
+    for (rank = 0; rank < count; rank++)
+        lanes->lanes[rank].level = lanes->lanes[lanes->lanes[rank].first].level;
+
+    for (k = 0; k < count; k++) {
+        lane = &lanes->lanes[lanes->ranks[k]];
+        if ((lane->ring = RING_InitBuffer(NULL, config[k].size)) == NULL) {
+            RING_DeinitializeLanes(lanes);
+            return NULL;
+        }
+        atomic_init(&lane->head, 0);
+        atomic_init(&lane->tail, 0);
+    }
+
+    return lanes;
+}
+
+/*****************************************************************************
+ * Function:        RING_DeinitializeLanes(RING_LANES *lanes)
+
+ * Description:     This function releases the lane rings and the lanes object itself
+
+ * PreCondition:    RING_InitLanes() must be successfully called
+
+ * Input:           lanes the RING_LANES pre-allocated object
+
+ * Return:          None
+
+ * Side Effects:    Dynamic memory will be released
+
+ * Overview:        None
+
+ * Note:            None
+ *****************************************************************************/
+void RING_DeinitializeLanes(RING_LANES *lanes) {
+    size_t i;
+
+    for (i = 0; i < lanes->count; i++)
+        if (lanes->lanes[i].ring != NULL)
+            RING_DeinitializeBuffer(lanes->lanes[i].ring);
+    free(lanes->lanes);
+    free(lanes->ranks);
+    free(lanes);
+}
+
+/*****************************************************************************
+ * Function:        RING_AddLaneBuffer(RING_LANES *lanes, size_t lane, uint8_t *buf, size_t size)
+
+ * Description:     This function copies the given buffer into a lane and flags
+ it as pending
+
+ * PreCondition:    RING_InitLanes() must be successfully called
+
+ * Input:           lanes the RING_LANES pre-allocated object
+ lane the user index of the lane
+ buf pointer of the buffer to copy
+ size number of bytes to copy
+
+ * Return:          The number of actual bytes copied
+
+ * Side Effects:    None
+
+ * Overview:        None
+
+ * Note:            Each lane must be written by a single thread
+ *****************************************************************************/
+size_t RING_AddLaneBuffer(RING_LANES *lanes, size_t lane, uint8_t *buf, size_t size) {
+    RING_LANE *target;
+    RING_DATA *ring;
+    size_t rank, added, first, head, tail;
+
+    rank = lanes->ranks[lane];
+    target = &lanes->lanes[rank];
+    ring = target->ring;
+    head = atomic_load_explicit(&target->head, memory_order_relaxed);
+    // The bytes are overwritten after the tail that freed them
+    tail = atomic_load_explicit(&target->tail, memory_order_acquire);
+
+    // One byte is always kept free as in RING_DATA
+    added = min(ring->size - 1 - RING_FastDistance(ring, tail, head), size);
+    first = min(added, ring->size - head);
+    memcpy(&ring->buf[head], buf, first);
+    memcpy(ring->buf, &buf[first], added - first);
+    // The bytes are visible before the head that covers them
+    atomic_store_explicit(&target->head, RING_FastAdvance(ring, head, added), memory_order_release);
+
+    if (added > 0)
+        atomic_fetch_or_explicit(&lanes->pending, RING_LaneBit(rank), memory_order_release);
+
+    return added;
+}
+
+/*****************************************************************************
+ * Function:        RING_IsLanesPending(const RING_LANES *lanes)
+
+ * Description:     This function checks whether any lane may hold data
+
+ * PreCondition:    RING_InitLanes() must be successfully called
+
+ * Input:           lanes the RING_LANES pre-allocated object
+
+ * Return:          true if at least one lane is flagged as pending
+
+ * Side Effects:    None
+
+ * Overview:        A single load of the bitmap, the rings are not touched
+
+ * Note:            None
+ *****************************************************************************/
+bool RING_IsLanesPending(const RING_LANES *lanes) {
+    return atomic_load_explicit(&lanes->pending, memory_order_relaxed) != 0;
+}
+
+/*****************************************************************************
+ * Function:        RING_DrainLanes(RING_LANES *lanes, size_t budget, RING_LANES_SINK sink, void *ctx)
+
+ * Description:     This function passes up to budget bytes of the pending lanes
+ to the sink
+
+ * PreCondition:    RING_InitLanes() must be successfully called
+
+ * Input:           lanes the RING_LANES pre-allocated object
+ budget the maximum number of bytes to serve
+ sink the function receiving the linear chunks in place
+ ctx the user context passed to the sink
+
+ * Return:          The number of bytes passed to the sink
+
+ * Side Effects:    The sink is called with the user lane index and a pointer into its ring
+
+ * Overview:        The bitmap is read again after each lane turn, so data added
+ to a higher priority lane preempts a lower priority backlog within a quantum.
+ Among lanes of the same priority a lane serves up to its weight in bytes per
+ round, the unused quantum of a lane that runs empty is dropped
+
+ * Note:            Must be called by a single consumer thread
+ *****************************************************************************/
+size_t RING_DrainLanes(RING_LANES *lanes, size_t budget, RING_LANES_SINK sink, void *ctx) {
+    RING_LANE *level, *lane;
+    uint_least64_t bits, mask;
+    size_t rank, served, total;
+
+    total = 0;
+    while (total < budget) {
+        bits = atomic_load_explicit(&lanes->pending, memory_order_acquire);
+        if (bits == 0)
+            break;
+
+        // The lowest pending rank belongs to the highest pending priority
+        rank = (size_t) __builtin_ctzll(bits);
+        level = &lanes->lanes[lanes->lanes[rank].first];
+        mask = bits & level->level;
+
+        // A new round starts when the lane in service used its quantum
+        lane = &lanes->lanes[level->turn];
+        if (lane->deficit == 0) {
+            level->turn = RING_NextLane(mask, level->turn);
+            lane = &lanes->lanes[level->turn];
+            lane->deficit = lane->weight;
+        }
+
+        served = RING_ServeLane(lane, min(lane->deficit, budget - total), sink, ctx);
+        lane->deficit -= served;
+        total += served;
+
+        if (RING_LaneFullSpace(lane) == 0) {
+            // Clear before checking again, a producer adding afterwards will set it again
+            atomic_fetch_and_explicit(&lanes->pending, ~RING_LaneBit(level->turn), memory_order_acq_rel);
+            if (RING_LaneFullSpace(lane) > 0)
+                atomic_fetch_or_explicit(&lanes->pending, RING_LaneBit(level->turn), memory_order_release);
+            else
+                lane->deficit = 0;
+        }
+    }
+
+    return total;
+}
+
+
+/* *****************************************************************************
+ End of File
+ */
@@ -0,0 +1,124 @@
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+
+ @File Name
+ RingLanes.h
+
+ @Author
+ Luca Pascarella https://lucapascarella.com
+
+ @Summary
+ These functions implement prioritized lanes of ring buffers.
+
+ @Description
+ This file implements a queue made of several RING_DATA objects, one for
+ each class of traffic. The consumer drains the lanes in strict priority
+ order, lanes sharing a priority are served by deficit round-robin with a
+ byte quantum proportional to their weight. A bitmap ordered by priority
+ marks the lanes that may hold data, so the emptiness check is a single
+ load and the next lane to serve is found with a bit scan.
+ @License
+ Copyright (C) 2016 LP Systems
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+
+ https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+#ifndef _RING_LANES_H    /* Guard against multiple inclusion */
+#define _RING_LANES_H
+
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#include <stdatomic.h>
+#include "RingBuffer.h"
+
+/* Provide C++ Compatibility */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+    /* ************************************************************************** */
+    /* ************************************************************************** */
+    /* Section: Constants                                                         */
+    /* ************************************************************************** */
+    /* ************************************************************************** */
+
+#define RING_LANES_MAX      64      // One bit of the pending bitmap for each lane
+
+    // *****************************************************************************
+    // *****************************************************************************
+    // Section: Data Types
+    // *****************************************************************************
+    // *****************************************************************************
+
+    // Called by the consumer for each linear chunk of a lane
+    typedef void (*RING_LANES_SINK)(void *ctx, size_t lane, const uint8_t *buf, size_t len);
+
+    typedef struct {
+        size_t size; // Ring size, it follows the RING_InitBuffer() rounding
+        unsigned priority; // Higher priorities are always served first
+        size_t weight; // Bytes served per round among lanes of the same priority
+    } RING_LANE_CONFIG;
+
+    typedef struct {
+        RING_DATA *ring; // Lane memory and size, its head and tail are not used
+        atomic_size_t head; // Written by the lane producer only
+        atomic_size_t tail; // Written by the consumer only
+        size_t lane; // User index of the lane
+        size_t weight; // Deficit round-robin quantum
+        size_t deficit; // Bytes left in the current round
+        size_t first; // Rank of the first lane with the same priority
+        size_t turn; // Rank in service, kept by the first lane of a priority only
+        uint_least64_t level; // Bitmap of the lanes with the same priority
+    } RING_LANE;
+
+    typedef struct {
+        RING_LANE *lanes; // Lanes sorted by decreasing priority
+        size_t *ranks; // Rank of each user lane
+        size_t count; // Number of lanes
+        atomic_uint_least64_t pending; // One bit for each rank that may hold data
+    } RING_LANES;
+
+
+    // *****************************************************************************
+    // *****************************************************************************
+    // Section: Interface Functions
+    // *****************************************************************************
+    // *****************************************************************************
+
+    // Initialization functions
+    RING_LANES * RING_InitLanes(const RING_LANE_CONFIG *config, size_t count);
+    void RING_DeinitializeLanes(RING_LANES *lanes);
+
+    // Producer functions
+    size_t RING_AddLaneBuffer(RING_LANES *lanes, size_t lane, uint8_t *buf, size_t size);
+
+    // Consumer functions
+    bool RING_IsLanesPending(const RING_LANES *lanes);
+    size_t RING_DrainLanes(RING_LANES *lanes, size_t budget, RING_LANES_SINK sink, void *ctx);
+
+
+    /* Provide C++ Compatibility */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RING_LANES_H */
+
+/* *****************************************************************************
+ End of File
+ */
@@ -0,0 +1,422 @@
+
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+
+ @File Name
+ RingLatency.c
+
+ @Author
+ Luca Pascarella https://lucapascarella.com
+
+ @Summary
+ These functions measure how long the bytes sit in a ring buffer.
+
+ @Description
+ This file implements an optional latency probe for a RING_DATA object.
+ The producer stamps one write out of N with the stream position of its
+ last byte, the consumer completes the sample when the tail passes that
+ position and adds the sojourn time to a log-linear histogram. Unsampled
+ writes cost a counter decrement, the histogram counters are atomic, so
+ percentiles can be exported at any time from any thread.
+ @License
+ Copyright (C) 2016 LP Systems
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+
+ https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#if defined(__unix__) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L     // clock_gettime()
+#endif
+
+#include "RingLatency.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <time.h>
+#define RING_LATENCY_MONOTONIC
+#endif
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Local Functions                                                   */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#ifdef RING_LATENCY_MONOTONIC
+
+// Default clock, nanoseconds of CLOCK_MONOTONIC
+
+static uint64_t RING_LatencyMonotonic(void *ctx) {
+    struct timespec now;
+
+    (void) ctx;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000u + (uint64_t) now.tv_nsec;
+}
+#endif
+
+// Log-linear bucket, values below 2^SUB_BITS are exact, the others keep
+// SUB_BITS bits after the leading one
+
+static inline size_t RING_LatencyBucket(uint64_t value) {
+    unsigned exponent;
+
+    if (value < ((uint64_t) 1 << RING_LATENCY_SUB_BITS))
+        return (size_t) value;
+    exponent = 63 - (unsigned) __builtin_clzll(value);
+    return ((size_t) (exponent - RING_LATENCY_SUB_BITS + 1) << RING_LATENCY_SUB_BITS)
+            + (size_t) ((value >> (exponent - RING_LATENCY_SUB_BITS)) & (((uint64_t) 1 << RING_LATENCY_SUB_BITS) - 1));
+}
+
+// Highest value falling into a bucket
+
+static inline uint64_t RING_LatencyBucketValue(size_t bucket) {
+    unsigned shift;
+    uint64_t sub;
+
+    if (bucket < ((size_t) 1 << RING_LATENCY_SUB_BITS))
+        return bucket;
+    shift = (unsigned) (bucket >> RING_LATENCY_SUB_BITS) - 1;
+    sub = (uint64_t) (bucket & (((size_t) 1 << RING_LATENCY_SUB_BITS) - 1)) | ((uint64_t) 1 << RING_LATENCY_SUB_BITS);
+    return ((sub + 1) << shift) - 1;
+}
+
+static void RING_LatencyRecord(RING_LATENCY *latency, uint64_t value) {
+    uint64_t max;
+
+    atomic_fetch_add_explicit(&latency->buckets[RING_LatencyBucket(value)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&latency->count, 1, memory_order_relaxed);
+    max = atomic_load_explicit(&latency->max, memory_order_relaxed);
+    while (value > max && !atomic_compare_exchange_weak_explicit(&latency->max, &max, value, memory_order_relaxed, memory_order_relaxed))
+        ;
+}
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Interface Functions                                               */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+/*****************************************************************************
+ * Function:        RING_LATENCY * RING_InitLatency(RING_DATA *ring, size_t sampling, RING_LATENCY_CLOCK clock, void *ctx)
+
+ * Description:     This function creates a latency probe over a ring
+
+ * PreCondition:    RING_InitBuffer() must be successfully called
+
+ * Input:           ring the RING_DATA pre-allocated object
+ sampling one write out of sampling is measured, 1 to measure every write
+ clock the timestamp source, NULL for the nanoseconds of CLOCK_MONOTONIC
+ ctx the user context passed to clock
+
+ * Return:          Pointer to a RING_LATENCY type allocated in the dynamic memory
+
+ * Side Effects:    RING_DeinitializeLatency() must be called to correctly release dynamic memory
+
+ * Overview:        The bytes already in the ring are not measured
+
+ * Note:            The histogram takes RING_LATENCY_BUCKETS 64 bits counters
+ *****************************************************************************/
+RING_LATENCY * RING_InitLatency(RING_DATA *ring, size_t sampling, RING_LATENCY_CLOCK clock, void *ctx) {
+
+    RING_LATENCY *latency;
+    size_t i;
+
+    if (sampling == 0)
+        return NULL;
+
+#ifdef RING_LATENCY_MONOTONIC
+    if (clock == NULL)
+        clock = RING_LatencyMonotonic;
+#else
+    if (clock == NULL)
+        return NULL;
+#endif
+
+    if ((latency = malloc(sizeof (RING_LATENCY))) == NULL)
+        return NULL;
+
+    latency->ring = ring;
+    latency->clock = clock;
+    latency->ctx = ctx;
+    latency->sampling = sampling;
+    latency->countdown = sampling;
+    latency->head = ring->head;
+    latency->produced = RING_GetFullSpace(ring);
+    latency->tail = ring->tail;
+    latency->consumed = 0;
+    atomic_init(&latency->sampleHead, 0);
+    atomic_init(&latency->sampleTail, 0);
+    for (i = 0; i < RING_LATENCY_BUCKETS; i++)
+        atomic_init(&latency->buckets[i], 0);
+    atomic_init(&latency->count, 0);
+    atomic_init(&latency->max, 0);
+
+    return latency;
+}
+
+/*****************************************************************************
+ * Function:        RING_DeinitializeLatency(RING_LATENCY *latency)
+
+ * Description:     This function releases the latency probe, the ring is kept
+
+ * PreCondition:    RING_InitLatency() must be successfully called
+
+ * Input:           latency the RING_LATENCY pre-allocated object
+
+ * Return:          None
+
+ * Side Effects:    Dynamic memory will be released
+
+ * Overview:        None
+
+ * Note:            None
+ *****************************************************************************/
+void RING_DeinitializeLatency(RING_LATENCY *latency) {
+    free(latency);
+}
+
+/*****************************************************************************
+ * Function:        RING_LatencyEnqueued(RING_LATENCY *latency)
+
+ * Description:     This function accounts the bytes written since the last call
+ and stamps one call out of sampling
+
+ * PreCondition:    RING_InitLatency() must be successfully called
+
+ * Input:           latency the RING_LATENCY pre-allocated object
+
+ * Return:          None
+
+ * Side Effects:    None
+
+ * Overview:        The clock is only read for the sampled calls. A sample is
+ skipped when RING_LATENCY_SAMPLES samples are still in flight
+
+ * Note:            Must be called by the producer after each write
+ *****************************************************************************/
+void RING_LatencyEnqueued(RING_LATENCY *latency) {
+    RING_LATENCY_SAMPLE *sample;
+    size_t head, stamped;
+
+    head = latency->ring->head;
+    latency->produced += RING_FastDistance(latency->ring, latency->head, head);
+    latency->head = head;
+
+    if (--latency->countdown > 0)
+        return;
+    latency->countdown = latency->sampling;
+
+    stamped = atomic_load_explicit(&latency->sampleHead, memory_order_relaxed);
+    if (stamped - atomic_load_explicit(&latency->sampleTail, memory_order_acquire) == RING_LATENCY_SAMPLES)
+        return;
+    sample = &latency->samples[stamped % RING_LATENCY_SAMPLES];
+    sample->position = latency->produced;
+    sample->time = latency->clock(latency->ctx);
+    atomic_store_explicit(&latency->sampleHead, stamped + 1, memory_order_release);
+}
+
+/*****************************************************************************
+ * Function:        RING_LatencyDequeued(RING_LATENCY *latency)
+
+ * Description:     This function accounts the bytes read since the last call
+ and measures the samples whose last byte was read
+
+ * PreCondition:    RING_InitLatency() must be successfully called
+
+ * Input:           latency the RING_LATENCY pre-allocated object
+
+ * Return:          None
+
+ * Side Effects:    None
+
+ * Overview:        The clock is read once if at least a sample is completed
+
+ * Note:            Must be called by the consumer after each read
+ *****************************************************************************/
+void RING_LatencyDequeued(RING_LATENCY *latency) {
+    const RING_LATENCY_SAMPLE *sample;
+    size_t tail, completed;
+    uint64_t now;
+    bool clocked;
+
+    tail = latency->ring->tail;
+    latency->consumed += RING_FastDistance(latency->ring, latency->tail, tail);
+    latency->tail = tail;
+
+    clocked = false;
+    now = 0;
+    completed = atomic_load_explicit(&latency->sampleTail, memory_order_relaxed);
+    while (completed != atomic_load_explicit(&latency->sampleHead, memory_order_acquire)) {
+        sample = &latency->samples[completed % RING_LATENCY_SAMPLES];
+        if (sample->position > latency->consumed)
+            break;
+        if (!clocked) {
+            now = latency->clock(latency->ctx);
+            clocked = true;
+        }
+        RING_LatencyRecord(latency, now > sample->time ? now - sample->time : 0);
+        atomic_store_explicit(&latency->sampleTail, ++completed, memory_order_release);
+    }
+}
+
+/*****************************************************************************
+ * Function:        RING_AddLatencyBuffer(RING_LATENCY *latency, uint8_t *buf, size_t size)
+
+ * Description:     This function copies the given buffer into the ring and
+ accounts the write
+
+ * PreCondition:    RING_InitLatency() must be successfully called
+
+ * Input:           latency the RING_LATENCY pre-allocated object
+ buf pointer of the buffer to copy
+ size number of bytes to copy
+
+ * Return:          The number of actual bytes copied
+
+ * Side Effects:    None
+
+ * Overview:        See RING_AddBuffer()
+
+ * Note:            Writes adding no byte are not sampled
+ *****************************************************************************/
+size_t RING_AddLatencyBuffer(RING_LATENCY *latency, uint8_t *buf, size_t size) {
+    size_t added;
+
+    added = RING_AddBuffer(latency->ring, buf, size);
+    if (added > 0)
+        RING_LatencyEnqueued(latency);
+    return added;
+}
+
+/*****************************************************************************
+ * Function:        RING_GetLatencyBuffer(RING_LATENCY *latency, uint8_t *ptr, size_t len)
+
+ * Description:     This function gets up to len bytes from the ring and
+ accounts the read
+
+ * PreCondition:    RING_InitLatency() must be successfully called
+
+ * Input:           latency the RING_LATENCY pre-allocated object
+ ptr user destination buffer
+ len user destination length
+
+ * Return:          the actual number of got bytes
+
+ * Side Effects:    None
+
+ * Overview:        See RING_GetBuffer()
+
+ * Note:            None
+ *****************************************************************************/
+size_t RING_GetLatencyBuffer(RING_LATENCY *latency, uint8_t *ptr, size_t len) {
+    size_t got;
+
+    got = RING_GetBuffer(latency->ring, ptr, len);
+    if (got > 0)
+        RING_LatencyDequeued(latency);
+    return got;
+}
+
+/*****************************************************************************
+ * Function:        RING_GetLatencyCount(const RING_LATENCY *latency)
+
+ * Description:     This function returns the number of measures
+
+ * PreCondition:    RING_InitLatency() must be successfully called
+
+ * Input:           latency the RING_LATENCY pre-allocated object
+
+ * Return:          The number of completed samples
+
+ * Side Effects:    None
+
+ * Overview:        None
+
+ * Note:            None
+ *****************************************************************************/
+uint64_t RING_GetLatencyCount(const RING_LATENCY *latency) {
+    return atomic_load_explicit(&latency->count, memory_order_relaxed);
+}
+
+/*****************************************************************************
+ * Function:        RING_GetLatencyMax(const RING_LATENCY *latency)
+
+ * Description:     This function returns the longest measure
+
+ * PreCondition:    RING_InitLatency() must be successfully called
+
+ * Input:           latency the RING_LATENCY pre-allocated object
+
+ * Return:          The exact longest sojourn time, in clock units
+
+ * Side Effects:    None
+
+ * Overview:        None
+
+ * Note:            None
+ *****************************************************************************/
+uint64_t RING_GetLatencyMax(const RING_LATENCY *latency) {
+    return atomic_load_explicit(&latency->max, memory_order_relaxed);
+}
+
+/*****************************************************************************
+ * Function:        RING_GetLatencyPercentile(const RING_LATENCY *latency, double percentile)
+
+ * Description:     This function returns a percentile of the sojourn time
+
+ * PreCondition:    RING_InitLatency() must be successfully called
+
+ * Input:           latency the RING_LATENCY pre-allocated object
+ percentile the percentile, e.g. 50.0 or 99.9
+
+ * Return:          The highest value of the bucket holding the percentile, in
+ clock units, 0 when nothing was measured
+
+ * Side Effects:    None
+
+ * Overview:        The counters are read one by one while the consumer may
+ add measures, the result is a close snapshot
+
+ * Note:            The value never exceeds RING_GetLatencyMax()
+ *****************************************************************************/
+uint64_t RING_GetLatencyPercentile(const RING_LATENCY *latency, double percentile) {
+    uint64_t count, target, seen;
+    size_t i;
+
+    count = atomic_load_explicit(&latency->count, memory_order_relaxed);
+    if (count == 0)
+        return 0;
+
+    target = (uint64_t) ((double) count * percentile / 100.0 + 0.5);
+    if (target == 0)
+        target = 1;
+
+    seen = 0;
+    for (i = 0; i < RING_LATENCY_BUCKETS - 1; i++) {
+        seen += atomic_load_explicit(&latency->buckets[i], memory_order_relaxed);
+        if (seen >= target)
+            break;
+    }
+    return min(RING_LatencyBucketValue(i), RING_GetLatencyMax(latency));
+}
+
+
+/* *****************************************************************************
+ End of File
+ */
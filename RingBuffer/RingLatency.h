@@ -0,0 +1,132 @@
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+
+ @File Name
+ RingLatency.h
+
+ @Author
+ Luca Pascarella https://lucapascarella.com
+
+ @Summary
+ These functions measure how long the bytes sit in a ring buffer.
+
+ @Description
+ This file implements an optional latency probe for a RING_DATA object.
+ The producer stamps one write out of N with the stream position of its
+ last byte, the consumer completes the sample when the tail passes that
+ position and adds the sojourn time to a log-linear histogram. Unsampled
+ writes cost a counter decrement, the histogram counters are atomic, so
+ percentiles can be exported at any time from any thread.
+ @License
+ Copyright (C) 2016 LP Systems
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+
+ https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+#ifndef _RING_LATENCY_H    /* Guard against multiple inclusion */
+#define _RING_LATENCY_H
+
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#include <stdatomic.h>
+#include "RingBuffer.h"
+
+/* Provide C++ Compatibility */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+    /* ************************************************************************** */
+    /* ************************************************************************** */
+    /* Section: Constants                                                         */
+    /* ************************************************************************** */
+    /* ************************************************************************** */
+
+#define RING_LATENCY_SUB_BITS   4       // Linear buckets of each power of 2, 6% resolution
+#define RING_LATENCY_BUCKETS    ((64 - RING_LATENCY_SUB_BITS + 1) << RING_LATENCY_SUB_BITS)
+#define RING_LATENCY_SAMPLES    64      // Samples in flight, further writes are not sampled
+
+    // *****************************************************************************
+    // *****************************************************************************
+    // Section: Data Types
+    // *****************************************************************************
+    // *****************************************************************************
+
+    // Returns the current time, any monotonic unit
+    typedef uint64_t (*RING_LATENCY_CLOCK)(void *ctx);
+
+    typedef struct {
+        uint64_t position; // Stream position of the last byte of the sampled write
+        uint64_t time; // Enqueue timestamp
+    } RING_LATENCY_SAMPLE;
+
+    typedef struct {
+        RING_DATA *ring; // The measured ring
+        RING_LATENCY_CLOCK clock; // Timestamp source
+        void *ctx; // User context passed to clock
+        size_t sampling; // One write out of sampling is stamped
+        // Producer side
+        size_t countdown; // Writes before the next sample
+        size_t head; // Last head seen by the producer
+        uint64_t produced; // Bytes written since the creation
+        // Consumer side
+        size_t tail; // Last tail seen by the consumer
+        uint64_t consumed; // Bytes read since the creation
+        // Samples in flight from the producer to the consumer
+        RING_LATENCY_SAMPLE samples[RING_LATENCY_SAMPLES];
+        atomic_size_t sampleHead; // Samples stamped
+        atomic_size_t sampleTail; // Samples completed
+        // Histogram
+        atomic_uint_least64_t buckets[RING_LATENCY_BUCKETS];
+        atomic_uint_least64_t count; // Number of measures
+        atomic_uint_least64_t max; // Longest measure
+    } RING_LATENCY;
+
+
+    // *****************************************************************************
+    // *****************************************************************************
+    // Section: Interface Functions
+    // *****************************************************************************
+    // *****************************************************************************
+
+    // Initialization functions
+    RING_LATENCY * RING_InitLatency(RING_DATA *ring, size_t sampling, RING_LATENCY_CLOCK clock, void *ctx);
+    void RING_DeinitializeLatency(RING_LATENCY *latency);
+
+    // Probe functions
+    void RING_LatencyEnqueued(RING_LATENCY *latency);
+    void RING_LatencyDequeued(RING_LATENCY *latency);
+    size_t RING_AddLatencyBuffer(RING_LATENCY *latency, uint8_t *buf, size_t size);
+    size_t RING_GetLatencyBuffer(RING_LATENCY *latency, uint8_t *ptr, size_t len);
+
+    // Export functions
+    uint64_t RING_GetLatencyCount(const RING_LATENCY *latency);
+    uint64_t RING_GetLatencyMax(const RING_LATENCY *latency);
+    uint64_t RING_GetLatencyPercentile(const RING_LATENCY *latency, double percentile);
+
+
+    /* Provide C++ Compatibility */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RING_LATENCY_H */
+
+/* *****************************************************************************
+ End of File
+ */
@@ -0,0 +1,510 @@
+
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+
+ @File Name
+ RingLz4.c
+
+ @Author
+ Luca Pascarella https://lucapascarella.com
+
+ @Summary
+ These functions implement an LZ4 block compression stage between ring buffers.
+
+ @Description
+ This file implements a streaming compressor that reads the filled segments
+ of a source ring in place and emits LZ4 compressed blocks into a
+ destination ring, and the matching decompressor. Each block is preceded by
+ an 8 bytes header holding the raw and the payload lengths. The history of
+ the previous blocks is kept as a dictionary, therefore, matches can refer
+ to data across block boundaries.
+
+ @License
+ Copyright (C) 2016 LP Systems
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+
+ https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#include <string.h>
+#include "RingLz4.h"
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: File Scope or Global Data                                         */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#define RING_LZ4_HASH_LOG       12
+#define RING_LZ4_MIN_MATCH      4
+#define RING_LZ4_MF_LIMIT       12  // A match cannot start in the last bytes of a block
+#define RING_LZ4_LAST_LITERALS  5   // A block always ends with literals
+#define RING_LZ4_SKIP_STRENGTH  6   // Incompressible data is skipped faster
+#define RING_LZ4_STORED         0x80000000u
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Local Functions                                                   */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+static inline uint32_t RING_Lz4Read32(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof (v));
+    return v;
+}
+
+// Returns the number of equal bytes of a and b, a never goes beyond end
+
+static inline size_t RING_Lz4Count(const uint8_t *a, const uint8_t *b, const uint8_t *end) {
+    const uint8_t *start;
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    uint64_t x, y;
+
+    start = a;
+    while (a + sizeof (x) <= end) {
+        memcpy(&x, a, sizeof (x));
+        memcpy(&y, b, sizeof (y));
+        if (x != y)
+            return (size_t) (a - start) + ((size_t) __builtin_ctzll(x ^ y) >> 3);
+        a += sizeof (x);
+        b += sizeof (y);
+    }
+#else
+    start = a;
+#endif
+    while (a < end && *a == *b) {
+        a++;
+        b++;
+    }
+    return (size_t) (a - start);
+}
+
+static inline uint32_t RING_Lz4Hash(uint32_t v) {
+    return (v * 2654435761u) >> (32 - RING_LZ4_HASH_LOG);
+}
+
+static inline void RING_Lz4Write32LE(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t) v;
+    p[1] = (uint8_t) (v >> 8);
+    p[2] = (uint8_t) (v >> 16);
+    p[3] = (uint8_t) (v >> 24);
+}
+
+static inline uint32_t RING_Lz4Read32LE(const uint8_t *p) {
+    return (uint32_t) p[0] | (uint32_t) p[1] << 8 | (uint32_t) p[2] << 16 | (uint32_t) p[3] << 24;
+}
+
+static inline uint8_t * RING_Lz4WriteLength(uint8_t *op, size_t len) {
+    while (len >= 255) {
+        *op++ = 255;
+        len -= 255;
+    }
+    *op++ = (uint8_t) len;
+    return op;
+}
+
+static uint8_t * RING_Lz4WriteSequence(uint8_t *op, const uint8_t *literals, size_t lit, size_t dist, size_t match) {
+    uint8_t *token;
+
+    token = op++;
+    *token = (uint8_t) ((lit >= 15 ? 15 : lit) << 4);
+    if (lit >= 15)
+        op = RING_Lz4WriteLength(op, lit - 15);
+    memcpy(op, literals, lit);
+    op += lit;
+    if (match == 0)
+        return op;
+
+    op[0] = (uint8_t) dist;
+    op[1] = (uint8_t) (dist >> 8);
+    op += 2;
+    match -= RING_LZ4_MIN_MATCH;
+    *token |= (uint8_t) (match >= 15 ? 15 : match);
+    if (match >= 15)
+        op = RING_Lz4WriteLength(op, match - 15);
+    return op;
+}
+
+// Compresses n bytes of src, the dictionary logically precedes src
+
+static size_t RING_Lz4CompressBlock(RING_LZ4 *lz4, const uint8_t *src, size_t n, uint8_t *dst) {
+    const uint8_t *dict, *match;
+    uint8_t *op;
+    size_t i, anchor, end, dist, back, len, attempts;
+    uint32_t cur, ref, h;
+
+    dict = lz4->window;
+    op = dst;
+    anchor = 0;
+
+    if (n >= RING_LZ4_MF_LIMIT) {
+        end = n - RING_LZ4_LAST_LITERALS;
+        i = 0;
+        attempts = 0;
+        while (i <= n - RING_LZ4_MF_LIMIT) {
+            cur = lz4->position + (uint32_t) i;
+            h = RING_Lz4Hash(RING_Lz4Read32(&src[i]));
+            ref = lz4->table[h];
+            lz4->table[h] = cur;
+            dist = (uint32_t) (cur - ref);
+
+            // Candidates must be recent and still in memory
+            match = NULL;
+            back = 0;
+            if (dist > 0 && dist <= RING_LZ4_MAX_DICTIONARY && dist <= lz4->dictLen + i) {
+                if (dist <= i) {
+                    match = &src[i - dist];
+                } else {
+                    back = dist - i;
+                    if (back >= RING_LZ4_MIN_MATCH)
+                        match = &dict[lz4->dictLen - back];
+                }
+            }
+            if (match == NULL || RING_Lz4Read32(match) != RING_Lz4Read32(&src[i])) {
+                i += 1 + (attempts++ >> RING_LZ4_SKIP_STRENGTH);
+                continue;
+            }
+            attempts = 0;
+
+            // Extend, a dictionary match may continue at the beginning of src
+            len = RING_LZ4_MIN_MATCH;
+            if (back == 0) {
+                len += RING_Lz4Count(&src[i + len], &match[len], &src[end]);
+            } else {
+                len += RING_Lz4Count(&src[i + len], &match[len], &src[min(end, i + back)]);
+                if (len == back)
+                    len += RING_Lz4Count(&src[i + len], src, &src[end]);
+            }
+
+            op = RING_Lz4WriteSequence(op, &src[anchor], i - anchor, dist, len);
+            i += len;
+            anchor = i;
+            lz4->table[RING_Lz4Hash(RING_Lz4Read32(&src[i - 2]))] = lz4->position + (uint32_t) (i - 2);
+        }
+    }
+
+    return (size_t) (RING_Lz4WriteSequence(op, &src[anchor], n - anchor, 0, 0) - dst);
+}
+
+// Decompresses a block into out, history bytes before out can be referenced
+
+static bool RING_Lz4DecompressBlock(const uint8_t *src, size_t srcLen, uint8_t *out, size_t outLen, size_t history) {
+    const uint8_t *ip, *iend;
+    size_t op, lit, match, offset, k;
+    uint8_t token, b;
+
+    ip = src;
+    iend = src + srcLen;
+    op = 0;
+
+    while (ip < iend) {
+        token = *ip++;
+        lit = token >> 4;
+        if (lit == 15) {
+            do {
+                if (ip >= iend)
+                    return false;
+                b = *ip++;
+                lit += b;
+            } while (b == 255);
+        }
+        if (lit > (size_t) (iend - ip) || lit > outLen - op)
+            return false;
+        memcpy(&out[op], ip, lit);
+        ip += lit;
+        op += lit;
+        if (ip == iend)
+            break;
+
+        if (iend - ip < 2)
+            return false;
+        offset = (size_t) ip[0] | (size_t) ip[1] << 8;
+        ip += 2;
+        if (offset == 0 || offset > op + history)
+            return false;
+        match = token & 15;
+        if (match == 15) {
+            do {
+                if (ip >= iend)
+                    return false;
+                b = *ip++;
+                match += b;
+            } while (b == 255);
+        }
+        match += RING_LZ4_MIN_MATCH;
+        if (match > outLen - op)
+            return false;
+
+        if (offset >= match) {
+            memcpy(&out[op], &out[op - offset], match);
+        } else {
+            // Overlapping copy repeats the last offset bytes
+            for (k = 0; k < match; k++)
+                out[op + k] = out[op + k - offset];
+        }
+        op += match;
+    }
+
+    return op == outLen;
+}
+
+// Keeps the last dictSize bytes of the stream after a block of n bytes
+
+static void RING_Lz4SaveDictionary(RING_LZ4 *lz4, const uint8_t *src, size_t n) {
+    size_t keep;
+
+    if (n >= lz4->dictSize) {
+        memcpy(lz4->window, &src[n - lz4->dictSize], lz4->dictSize);
+        lz4->dictLen = lz4->dictSize;
+    } else {
+        keep = min(lz4->dictLen, lz4->dictSize - n);
+        memmove(lz4->window, &lz4->window[lz4->dictLen - keep], keep);
+        memcpy(&lz4->window[keep], src, n);
+        lz4->dictLen = keep + n;
+    }
+    lz4->position += (uint32_t) n;
+}
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Interface Functions                                               */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+/*****************************************************************************
+ * Function:        RING_LZ4 * RING_InitLz4(size_t blockSize, size_t dictSize)
+
+ * Description:     This function creates the state of a compression or a
+ decompression stage
+
+ * PreCondition:    None
+
+ * Input:           blockSize the maximum number of raw bytes in a block
+ dictSize the number of history bytes kept across blocks, 0 for independent blocks
+
+ * Return:          Pointer to a RING_LZ4 type allocated in the dynamic memory
+
+ * Side Effects:    RING_DeinitializeLz4() must be called to correctly release dynamic memory
+
+ * Overview:        None
+
+ * Note:            A stage works in a single direction, the compressor and the decompressor
+ of the same stream must use the same block and dictionary sizes
+ *****************************************************************************/
+RING_LZ4 * RING_InitLz4(size_t blockSize, size_t dictSize) {
+
+    RING_LZ4 *lz4;
+
+    if (blockSize == 0 || blockSize > RING_LZ4_MAX_BLOCK || dictSize > RING_LZ4_MAX_DICTIONARY)
+        return NULL;
+
+    if ((lz4 = calloc(1, sizeof (RING_LZ4))) == NULL)
+        return NULL;
+
+    lz4->blockSize = blockSize;
+    lz4->dictSize = dictSize;
+    lz4->window = malloc(dictSize + blockSize);
+    lz4->table = calloc((size_t) 1 << RING_LZ4_HASH_LOG, sizeof (uint32_t));
+    lz4->scratch = malloc(RING_LZ4_HEADER_SIZE + RING_LZ4_BOUND(blockSize));
+    if (lz4->window == NULL || lz4->table == NULL || lz4->scratch == NULL) {
+        RING_DeinitializeLz4(lz4);
+        return NULL;
+    }
+
+    // Positions start far from the empty table entries
+    lz4->position = RING_LZ4_MAX_DICTIONARY + 1;
+
+    return lz4;
+}
+
+/*****************************************************************************
+ * Function:        RING_DeinitializeLz4(RING_LZ4 *lz4)
+
+ * Description:     This function releases dynamically allocated memories
+
+ * PreCondition:    RING_InitLz4() must be successfully called
+
+ * Input:           lz4 the RING_LZ4 pre-allocated object
+
+ * Return:          None
+
+ * Side Effects:    Dynamic memory will be released
+
+ * Overview:        None
+
+ * Note:            None
+ *****************************************************************************/
+void RING_DeinitializeLz4(RING_LZ4 *lz4) {
+    free(lz4->window);
+    free(lz4->table);
+    free(lz4->scratch);
+    free(lz4);
+}
+
+/*****************************************************************************
+ * Function:        RING_CompressLz4(RING_LZ4 *lz4, RING_DATA * const dst, RING_DATA * const src, bool flush)
+
+ * Description:     This function compresses the filled space of src into blocks
+ appended to dst
+
+ * PreCondition:    RING_InitLz4() must be successfully called
+
+ * Input:           lz4 the RING_LZ4 compressor object
+ dst the ring receiving the compressed blocks
+ src the ring holding the raw data
+ flush true to compress a partial block as well
+
+ * Return:          The number of raw bytes consumed from src
+
+ * Side Effects:    None
+
+ * Overview:        Blocks are compressed straight from the linear segments of src,
+ so a block also ends at the end of the src buffer. The output is written straight
+ into dst when its linear free space is enough, otherwise it is staged
+
+ * Note:            It stops when dst has no room for a worst case block
+ *****************************************************************************/
+size_t RING_CompressLz4(RING_LZ4 *lz4, RING_DATA * const dst, RING_DATA * const src, bool flush) {
+    size_t n, need, len, total;
+    uint32_t stored;
+    uint8_t *in, *out;
+    bool direct;
+
+    total = 0;
+    for (;;) {
+        n = min(RING_GetFullLinearSpace(src), lz4->blockSize);
+        if (n == 0)
+            break;
+        if (n < lz4->blockSize && !flush && RING_GetFullSpace(src) == n)
+            break;
+
+        need = RING_LZ4_HEADER_SIZE + RING_LZ4_BOUND(n);
+        if (RING_GetFreeLinearSpace(dst) >= need) {
+            out = RING_GetHeadPointer(dst);
+            direct = true;
+        } else if (RING_GetFreeSpace(dst) >= need) {
+            out = lz4->scratch;
+            direct = false;
+        } else {
+            break;
+        }
+
+        in = RING_GetTailPointer(src);
+        len = RING_Lz4CompressBlock(lz4, in, n, &out[RING_LZ4_HEADER_SIZE]);
+        stored = 0;
+        if (len >= n) {
+            memcpy(&out[RING_LZ4_HEADER_SIZE], in, n);
+            len = n;
+            stored = RING_LZ4_STORED;
+        }
+        RING_Lz4Write32LE(out, (uint32_t) n | stored);
+        RING_Lz4Write32LE(&out[4], (uint32_t) len);
+
+        if (direct)
+            RING_IncreaseHead(dst, RING_LZ4_HEADER_SIZE + len);
+        else
+            RING_AddBuffer(dst, out, RING_LZ4_HEADER_SIZE + len);
+
+        RING_Lz4SaveDictionary(lz4, in, n);
+        RING_IncreaseTail(src, n);
+        total += n;
+    }
+
+    return total;
+}
+
+/*****************************************************************************
+ * Function:        RING_DecompressLz4(RING_LZ4 *lz4, RING_DATA * const dst, RING_DATA * const src)
+
+ * Description:     This function decompresses the complete blocks held by src
+ appending the raw data to dst
+
+ * PreCondition:    RING_InitLz4() must be successfully called
+
+ * Input:           lz4 the RING_LZ4 decompressor object
+ dst the ring receiving the raw data
+ src the ring holding the compressed blocks
+
+ * Return:          The number of raw bytes appended to dst
+
+ * Side Effects:    The corrupted field is set when an invalid block is met
+
+ * Overview:        Blocks are decoded in place when they are linear into src. The
+ output is decoded after the history kept in window and then appended to dst
+
+ * Note:            It stops at the first incomplete block or when dst has no room for it
+ *****************************************************************************/
+size_t RING_DecompressLz4(RING_LZ4 *lz4, RING_DATA * const dst, RING_DATA * const src) {
+    uint8_t header[RING_LZ4_HEADER_SIZE];
+    const uint8_t *in;
+    uint8_t *out;
+    size_t full, raw, len, keep, total;
+    bool stored;
+
+    total = 0;
+    while (!lz4->corrupted) {
+        full = RING_GetFullSpace(src);
+        if (full < RING_LZ4_HEADER_SIZE)
+            break;
+        RING_PickBytes(src, header, RING_LZ4_HEADER_SIZE);
+        raw = RING_Lz4Read32LE(header) & ~RING_LZ4_STORED;
+        stored = (RING_Lz4Read32LE(header) & RING_LZ4_STORED) != 0;
+        len = RING_Lz4Read32LE(&header[4]);
+        if (raw > lz4->blockSize || len > RING_LZ4_BOUND(lz4->blockSize) || (stored && len != raw)) {
+            lz4->corrupted = true;
+            break;
+        }
+        if (full < RING_LZ4_HEADER_SIZE + len || RING_GetFreeSpace(dst) < raw)
+            break;
+
+        if (RING_GetFullLinearSpace(src) >= RING_LZ4_HEADER_SIZE + len) {
+            in = RING_GetTailPointer(src) + RING_LZ4_HEADER_SIZE;
+        } else {
+            RING_PickBytes(src, lz4->scratch, RING_LZ4_HEADER_SIZE + len);
+            in = &lz4->scratch[RING_LZ4_HEADER_SIZE];
+        }
+
+        // Slide the history to make room for the block
+        if (lz4->dictLen + raw > lz4->dictSize + lz4->blockSize) {
+            keep = min(lz4->dictLen, lz4->dictSize);
+            memmove(lz4->window, &lz4->window[lz4->dictLen - keep], keep);
+            lz4->dictLen = keep;
+        }
+        out = &lz4->window[lz4->dictLen];
+
+        if (stored) {
+            memcpy(out, in, raw);
+        } else if (!RING_Lz4DecompressBlock(in, len, out, raw, min(lz4->dictLen, lz4->dictSize))) {
+            lz4->corrupted = true;
+            break;
+        }
+
+        RING_AddBuffer(dst, out, raw);
+        lz4->dictLen += raw;
+        RING_IncreaseTail(src, RING_LZ4_HEADER_SIZE + len);
+        total += raw;
+    }
+
+    return total;
+}
+
+
+/* *****************************************************************************
+ End of File
+ */
@@ -0,0 +1,107 @@
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+
+ @File Name
+ RingLz4.h
+
+ @Author
+ Luca Pascarella https://lucapascarella.com
+
+ @Summary
+ These functions implement an LZ4 block compression stage between ring buffers.
+
+ @Description
+ This file implements a streaming compressor that reads the filled segments
+ of a source ring in place and emits LZ4 compressed blocks into a
+ destination ring, and the matching decompressor. Each block is preceded by
+ an 8 bytes header holding the raw and the payload lengths. The history of
+ the previous blocks is kept as a dictionary, therefore, matches can refer
+ to data across block boundaries.
+
+ @License
+ Copyright (C) 2016 LP Systems
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+
+ https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+#ifndef _RING_LZ4_H    /* Guard against multiple inclusion */
+#define _RING_LZ4_H
+
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#include "RingBuffer.h"
+
+/* Provide C++ Compatibility */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+    /* ************************************************************************** */
+    /* ************************************************************************** */
+    /* Section: Constants                                                         */
+    /* ************************************************************************** */
+    /* ************************************************************************** */
+
+#define RING_LZ4_HEADER_SIZE        8
+#define RING_LZ4_MAX_DICTIONARY     65535
+#define RING_LZ4_MAX_BLOCK          0x00400000
+#define RING_LZ4_BOUND(n)           ((n) + (n) / 255 + 16)
+
+    // *****************************************************************************
+    // *****************************************************************************
+    // Section: Data Types
+    // *****************************************************************************
+    // *****************************************************************************
+
+    typedef struct {
+        size_t blockSize; // Maximum number of raw bytes in a block
+        size_t dictSize; // Maximum number of history bytes kept across blocks
+        uint8_t *window; // History followed by the block being decompressed
+        size_t dictLen; // Number of valid history bytes in window
+        uint32_t position; // Stream position of the next raw byte
+        uint32_t *table; // Hash table of stream positions, compressor only
+        uint8_t *scratch; // Staging for blocks that do not fit a linear segment
+        bool corrupted; // It is true when the decompressor met an invalid block
+    } RING_LZ4;
+
+
+    // *****************************************************************************
+    // *****************************************************************************
+    // Section: Interface Functions
+    // *****************************************************************************
+    // *****************************************************************************
+
+    // Initialization functions
+    RING_LZ4 * RING_InitLz4(size_t blockSize, size_t dictSize);
+    void RING_DeinitializeLz4(RING_LZ4 *lz4);
+
+    // Stage functions
+    size_t RING_CompressLz4(RING_LZ4 *lz4, RING_DATA * const dst, RING_DATA * const src, bool flush);
+    size_t RING_DecompressLz4(RING_LZ4 *lz4, RING_DATA * const dst, RING_DATA * const src);
+
+
+    /* Provide C++ Compatibility */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RING_LZ4_H */
+
+/* *****************************************************************************
+ End of File
+ */
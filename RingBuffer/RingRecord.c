@@ -0,0 +1,380 @@
+
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+
+ @File Name
+ RingRecord.c
+
+ @Author
+ Luca Pascarella https://lucapascarella.com
+
+ @Summary
+ These functions store timestamped records into a ring buffer.
+
+ @Description
+ This file implements a record mode on top of a RING_DATA object. Each
+ record is stamped with a monotonic timestamp when it is added and every
+ few records a mark with its timestamp and stream position is kept in a
+ sparse index. Dropping the records older than a given time and finding
+ the first record of a time range are a binary search on the marks plus a
+ scan of a few records, the payloads are returned as spans of the ring
+ memory without copying.
+
+ @License
+ Copyright (C) 2016 LP Systems
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+
+ https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#if defined(__unix__) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L     // clock_gettime()
+#endif
+
+#include <string.h>
+#include "RingRecord.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <time.h>
+#define RING_RECORD_MONOTONIC
+#endif
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Local Functions                                                   */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#ifdef RING_RECORD_MONOTONIC
+
+// Default clock, nanoseconds of CLOCK_MONOTONIC
+
+static uint64_t RING_RecordMonotonic(void *ctx) {
+    struct timespec now;
+
+    (void) ctx;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000u + (uint64_t) now.tv_nsec;
+}
+#endif
+
+// Converts a stream position into a buffer index
+
+static inline size_t RING_RecordIndex(const RING_RECORD *record, uint64_t position) {
+    return RING_FastAdvance(record->ring, record->ring->tail, (size_t) (position - record->tail));
+}
+
+static void RING_RecordHeader(const RING_RECORD *record, uint64_t position, uint64_t *time, uint32_t *len) {
+    const RING_DATA *ring = record->ring;
+    uint8_t header[RING_RECORD_HEADER_SIZE];
+    size_t index, first;
+
+    index = RING_RecordIndex(record, position);
+    first = min((size_t) RING_RECORD_HEADER_SIZE, ring->size - index);
+    memcpy(header, &ring->buf[index], first);
+    memcpy(&header[first], ring->buf, RING_RECORD_HEADER_SIZE - first);
+    memcpy(time, header, sizeof (*time));
+    memcpy(len, &header[sizeof (*time)], sizeof (*len));
+}
+
+static inline const RING_RECORD_MARK * RING_GetMark(const RING_RECORD *record, size_t i) {
+    return &record->marks[(record->markFirst + i) % record->markMax];
+}
+
+// Moves the tail to a record boundary and forgets the marks before it
+
+static void RING_RecordMoveTail(RING_RECORD *record, uint64_t position) {
+    RING_IncreaseTail(record->ring, (size_t) (position - record->tail));
+    record->tail = position;
+    while (record->markCount > 0 && RING_GetMark(record, 0)->position < position) {
+        record->markFirst = (record->markFirst + 1) % record->markMax;
+        record->markCount--;
+    }
+}
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Interface Functions                                               */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+/*****************************************************************************
+ * Function:        RING_RECORD * RING_InitRecord(RING_DATA *ring, size_t stride, RING_RECORD_CLOCK clock, void *ctx)
+
+ * Description:     This function creates a record mode over an empty ring
+
+ * PreCondition:    RING_InitBuffer() must be successfully called
+
+ * Input:           ring the RING_DATA pre-allocated object, it must be empty
+ stride a record every stride is kept in the sparse index
+ clock the timestamp source, NULL for the nanoseconds of CLOCK_MONOTONIC
+ ctx the user context passed to clock
+
+ * Return:          Pointer to a RING_RECORD type allocated in the dynamic memory
+
+ * Side Effects:    RING_DeinitializeRecord() must be called to correctly release dynamic memory
+
+ * Overview:        The index is sized for a ring full of empty records, it is
+ never reallocated
+
+ * Note:            The ring must only be accessed through this object
+ *****************************************************************************/
+RING_RECORD * RING_InitRecord(RING_DATA *ring, size_t stride, RING_RECORD_CLOCK clock, void *ctx) {
+
+    RING_RECORD *record;
+
+    if (stride == 0 || RING_GetFullSpace(ring) != 0)
+        return NULL;
+
+#ifdef RING_RECORD_MONOTONIC
+    if (clock == NULL)
+        clock = RING_RecordMonotonic;
+#else
+    if (clock == NULL)
+        return NULL;
+#endif
+
+    if ((record = malloc(sizeof (RING_RECORD))) == NULL)
+        return NULL;
+
+    record->markMax = ring->size / (RING_RECORD_HEADER_SIZE * stride) + 2;
+    if ((record->marks = malloc(record->markMax * sizeof (RING_RECORD_MARK))) == NULL) {
+        free(record);
+        return NULL;
+    }
+
+    record->ring = ring;
+    record->clock = clock;
+    record->ctx = ctx;
+    record->head = 0;
+    record->tail = 0;
+    record->last = 0;
+    record->stride = stride;
+    record->unmarked = 0;
+    record->markFirst = 0;
+    record->markCount = 0;
+
+    return record;
+}
+
+/*****************************************************************************
+ * Function:        RING_DeinitializeRecord(RING_RECORD *record)
+
+ * Description:     This function releases the record mode, the ring is kept
+
+ * PreCondition:    RING_InitRecord() must be successfully called
+
+ * Input:           record the RING_RECORD pre-allocated object
+
+ * Return:          None
+
+ * Side Effects:    Dynamic memory will be released
+
+ * Overview:        None
+
+ * Note:            None
+ *****************************************************************************/
+void RING_DeinitializeRecord(RING_RECORD *record) {
+    free(record->marks);
+    free(record);
+}
+
+/*****************************************************************************
+ * Function:        RING_AddRecord(RING_RECORD *record, const uint8_t *buf, size_t len)
+
+ * Description:     This function stamps and appends a record
+
+ * PreCondition:    RING_InitRecord() must be successfully called
+
+ * Input:           record the RING_RECORD pre-allocated object
+ buf the record payload
+ len the payload length
+
+ * Return:          true if the record is added, false if it can never fit the ring
+
+ * Side Effects:    The oldest records are dropped to make room
+
+ * Overview:        The timestamp never goes back, a clock reading older than
+ the previous record is raised to the previous timestamp
+
+ * Note:            None
+ *****************************************************************************/
+bool RING_AddRecord(RING_RECORD *record, const uint8_t *buf, size_t len) {
+    RING_DATA *ring = record->ring;
+    RING_RECORD_MARK *mark;
+    uint8_t header[RING_RECORD_HEADER_SIZE];
+    uint64_t time, oldest;
+    uint32_t length;
+
+    if (len > UINT32_MAX || len > RING_GetBufferSize(ring) - 1 - RING_RECORD_HEADER_SIZE)
+        return false;
+
+    while (RING_GetFreeSpace(ring) < RING_RECORD_HEADER_SIZE + len) {
+        RING_RecordHeader(record, record->tail, &oldest, &length);
+        RING_RecordMoveTail(record, record->tail + RING_RECORD_HEADER_SIZE + length);
+    }
+
+    time = record->clock(record->ctx);
+    if (time < record->last)
+        time = record->last;
+    record->last = time;
+
+    length = (uint32_t) len;
+    memcpy(header, &time, sizeof (time));
+    memcpy(&header[sizeof (time)], &length, sizeof (length));
+    RING_AddBuffer(ring, header, RING_RECORD_HEADER_SIZE);
+    RING_AddBuffer(ring, (uint8_t*) buf, len);
+
+    if (record->unmarked == 0) {
+        if (record->markCount == record->markMax) {
+            record->markFirst = (record->markFirst + 1) % record->markMax;
+            record->markCount--;
+        }
+        mark = &record->marks[(record->markFirst + record->markCount) % record->markMax];
+        mark->time = time;
+        mark->position = record->head;
+        record->markCount++;
+    }
+    if (++record->unmarked == record->stride)
+        record->unmarked = 0;
+
+    record->head += RING_RECORD_HEADER_SIZE + len;
+    return true;
+}
+
+/*****************************************************************************
+ * Function:        RING_SeekRecord(const RING_RECORD *record, uint64_t time)
+
+ * Description:     This function finds the first record not older than time
+
+ * PreCondition:    RING_InitRecord() must be successfully called
+
+ * Input:           record the RING_RECORD pre-allocated object
+ time the searched timestamp
+
+ * Return:          The stream position of the record, the head position if
+ every record is older
+
+ * Side Effects:    None
+
+ * Overview:        A binary search on the marks selects the last mark older than
+ time, then at most stride headers are read
+
+ * Note:            The position is the input of RING_GetRecordSpan()
+ *****************************************************************************/
+uint64_t RING_SeekRecord(const RING_RECORD *record, uint64_t time) {
+    uint64_t position, stamp;
+    uint32_t length;
+    size_t lo, hi, mid;
+
+    lo = 0;
+    hi = record->markCount;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (RING_GetMark(record, mid)->time < time)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    position = lo == 0 ? record->tail : RING_GetMark(record, lo - 1)->position;
+    while (position != record->head) {
+        RING_RecordHeader(record, position, &stamp, &length);
+        if (stamp >= time)
+            break;
+        position += RING_RECORD_HEADER_SIZE + length;
+    }
+    return position;
+}
+
+/*****************************************************************************
+ * Function:        RING_EvictRecords(RING_RECORD *record, uint64_t time)
+
+ * Description:     This function drops every record older than time
+
+ * PreCondition:    RING_InitRecord() must be successfully called
+
+ * Input:           record the RING_RECORD pre-allocated object
+ time the timestamp of the oldest record to keep
+
+ * Return:          The number of bytes released
+
+ * Side Effects:    The ring tail moves
+
+ * Overview:        The dropped records are not read, see RING_SeekRecord()
+
+ * Note:            None
+ *****************************************************************************/
+size_t RING_EvictRecords(RING_RECORD *record, uint64_t time) {
+    uint64_t position;
+    size_t released;
+
+    position = RING_SeekRecord(record, time);
+    released = (size_t) (position - record->tail);
+    RING_RecordMoveTail(record, position);
+    return released;
+}
+
+/*****************************************************************************
+ * Function:        RING_GetRecordSpan(const RING_RECORD *record, uint64_t *position, uint64_t until, RING_RECORD_SPAN *span)
+
+ * Description:     This function returns the payload of a record in place
+
+ * PreCondition:    RING_SeekRecord() must be called to obtain the first position
+
+ * Input:           record the RING_RECORD pre-allocated object
+ position the stream position of the record, it receives the next one
+ until the first excluded timestamp
+ span it receives the timestamp and the payload parts
+
+ * Return:          true if a record older than until is returned
+
+ * Side Effects:    None
+
+ * Overview:        Calling it in a loop walks the records of a time range
+
+ * Note:            The spans are valid until the records are dropped, false is
+ returned for a position dropped in the meantime
+ *****************************************************************************/
+bool RING_GetRecordSpan(const RING_RECORD *record, uint64_t *position, uint64_t until, RING_RECORD_SPAN *span) {
+    const RING_DATA *ring = record->ring;
+    uint64_t time;
+    uint32_t length;
+    size_t index;
+
+    if (*position < record->tail || *position >= record->head)
+        return false;
+
+    RING_RecordHeader(record, *position, &time, &length);
+    if (time >= until)
+        return false;
+
+    index = RING_RecordIndex(record, *position + RING_RECORD_HEADER_SIZE);
+    span->time = time;
+    span->len[0] = min((size_t) length, ring->size - index);
+    span->len[1] = length - span->len[0];
+    span->data[0] = &ring->buf[index];
+    span->data[1] = ring->buf;
+    *position += RING_RECORD_HEADER_SIZE + length;
+    return true;
+}
+
+
+/* *****************************************************************************
+ End of File
+ */
@@ -0,0 +1,126 @@
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+
+ @File Name
+ RingRecord.h
+
+ @Author
+ Luca Pascarella https://lucapascarella.com
+
+ @Summary
+ These functions store timestamped records into a ring buffer.
+
+ @Description
+ This file implements a record mode on top of a RING_DATA object. Each
+ record is stamped with a monotonic timestamp when it is added and every
+ few records a mark with its timestamp and stream position is kept in a
+ sparse index. Dropping the records older than a given time and finding
+ the first record of a time range are a binary search on the marks plus a
+ scan of a few records, the payloads are returned as spans of the ring
+ memory without copying.
+
+ @License
+ Copyright (C) 2016 LP Systems
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+
+ https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+#ifndef _RING_RECORD_H    /* Guard against multiple inclusion */
+#define _RING_RECORD_H
+
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#include "RingBuffer.h"
+
+/* Provide C++ Compatibility */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+    /* ************************************************************************** */
+    /* ************************************************************************** */
+    /* Section: Constants                                                         */
+    /* ************************************************************************** */
+    /* ************************************************************************** */
+
+#define RING_RECORD_HEADER_SIZE     12      // 64 bits timestamp and 32 bits length
+
+    // *****************************************************************************
+    // *****************************************************************************
+    // Section: Data Types
+    // *****************************************************************************
+    // *****************************************************************************
+
+    typedef uint64_t (*RING_RECORD_CLOCK)(void *ctx);
+
+    typedef struct {
+        uint64_t time; // Timestamp of the marked record
+        uint64_t position; // Stream position of its header
+    } RING_RECORD_MARK;
+
+    typedef struct {
+        RING_DATA *ring; // Ring holding the records
+        RING_RECORD_CLOCK clock; // Timestamp source
+        void *ctx; // User context passed to clock
+        uint64_t head; // Stream position of the ring head
+        uint64_t tail; // Stream position of the ring tail
+        uint64_t last; // Timestamp of the newest record
+        size_t stride; // A record every stride is marked
+        size_t unmarked; // Records added since the last mark
+        RING_RECORD_MARK *marks; // Sparse index, oldest first from markFirst
+        size_t markMax; // Capacity of marks
+        size_t markFirst; // Oldest mark
+        size_t markCount; // Number of marks
+    } RING_RECORD;
+
+    typedef struct {
+        uint64_t time; // Timestamp of the record
+        const uint8_t *data[2]; // Payload, data[1] holds the part after the wrap
+        size_t len[2]; // Length of each payload part
+    } RING_RECORD_SPAN;
+
+
+    // *****************************************************************************
+    // *****************************************************************************
+    // Section: Interface Functions
+    // *****************************************************************************
+    // *****************************************************************************
+
+    // Initialization functions
+    RING_RECORD * RING_InitRecord(RING_DATA *ring, size_t stride, RING_RECORD_CLOCK clock, void *ctx);
+    void RING_DeinitializeRecord(RING_RECORD *record);
+
+    // Record functions
+    bool RING_AddRecord(RING_RECORD *record, const uint8_t *buf, size_t len);
+    size_t RING_EvictRecords(RING_RECORD *record, uint64_t time);
+
+    // Query functions
+    uint64_t RING_SeekRecord(const RING_RECORD *record, uint64_t time);
+    bool RING_GetRecordSpan(const RING_RECORD *record, uint64_t *position, uint64_t until, RING_RECORD_SPAN *span);
+
+
+    /* Provide C++ Compatibility */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RING_RECORD_H */
+
+/* *****************************************************************************
+ End of File
+ */
@@ -0,0 +1,337 @@
+
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+
+ @File Name
+ RingReserve.c
+
+ @Author
+ Luca Pascarella https://lucapascarella.com
+
+ @Summary
+ These functions implement a multi-producer ring of variable-size records.
+
+ @Description
+ This file implements a byte ring where multiple producers concurrently
+ reserve variable-length records. A reservation is a single atomic update
+ of the head, so producers never wait for each other. Each record starts
+ with a header that flags it as busy until the producer commits or
+ discards it. A single consumer reads the records in place and in order,
+ waiting only on the first record that is still busy.
+
+ @License
+ Copyright (C) 2016 LP Systems
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+
+ https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#include <string.h>
+#include "RingReserve.h"
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: File Scope or Global Data                                         */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+// The first header word holds the record span and the state flags, the
+// second one holds the user length. A zero first word means not yet written.
+#define RING_RESERVE_BUSY       0x80000000u
+#define RING_RESERVE_DISCARD    0x40000000u
+#define RING_RESERVE_SPAN_MASK  0x3FFFFFFFu
+
+#define RING_RESERVE_ALIGN(x)   (((x) + RING_RESERVE_HEADER_SIZE - 1) & ~(size_t) (RING_RESERVE_HEADER_SIZE - 1))
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Local Functions                                                   */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+static inline atomic_uint_least32_t * RING_ReserveHeader(uint8_t *record) {
+    return (atomic_uint_least32_t *) record;
+}
+
+static inline uint32_t * RING_ReserveLength(uint8_t *record) {
+    return (uint32_t *) (record + sizeof (atomic_uint_least32_t));
+}
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Interface Functions                                               */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+/*****************************************************************************
+ * Function:        RING_RESERVE * RING_InitReserve(const uint8_t *buf, size_t size)
+
+ * Description:     This function creates a RING_RESERVE object for variable-size records
+
+ * PreCondition:    None
+
+ * Input:           buf is the predefined ring buffer, NULL to require a dynamic allocation
+ size is the size of the pre-allocated memory or the required memory
+
+ * Return:          Pointer to a RING_RESERVE type allocated in the dynamic memory,
+ NULL if the buffer is not 8 bytes aligned or too small
+
+ * Side Effects:    RING_DeinitializeReserve() must be called to correctly release dynamic memory
+
+ * Overview:        None
+
+ * Note:            The size is always rounded down to the closest power of 2, at
+ most 1 GiB, and the buffer is cleared because a zero header marks a record
+ under construction
+ *****************************************************************************/
+RING_RESERVE * RING_InitReserve(const uint8_t *buf, size_t size) {
+
+    RING_RESERVE *ring;
+    size_t pow2;
+
+    if (size < 2 * RING_RESERVE_HEADER_SIZE)
+        return NULL;
+    if (((uintptr_t) buf & (RING_RESERVE_HEADER_SIZE - 1)) != 0)
+        return NULL;
+
+    if ((ring = malloc(sizeof (RING_RESERVE))) == NULL)
+        return NULL;
+
+    // A span or a pad must fit the header bits below the flags
+    size = min(size, (size_t) RING_RESERVE_SPAN_MASK + 1);
+    for (pow2 = 1; pow2 <= size / 2; pow2 <<= 1)
+        ;
+    ring->size = pow2;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+
+    if (buf == NULL) {
+        if ((ring->buf = calloc(ring->size, sizeof (uint8_t))) == NULL) {
+            free(ring);
+            return NULL;
+        }
+        ring->dymamic = true;
+    } else {
+        ring->buf = (uint8_t*) buf;
+        memset(ring->buf, 0, ring->size);
+        ring->dymamic = false;
+    }
+
+    return ring;
+}
+
+/*****************************************************************************
+ * Function:        RING_DeinitializeReserve(RING_RESERVE *ring)
+
+ * Description:     This function releases dynamically allocated memories
+
+ * PreCondition:    RING_InitReserve() must be successfully called
+
+ * Input:           ring the RING_RESERVE pre-allocated object
+
+ * Return:          None
+
+ * Side Effects:    Dynamic memory will be released
+
+ * Overview:        None
+
+ * Note:            None
+ *****************************************************************************/
+void RING_DeinitializeReserve(RING_RESERVE *ring) {
+    if (ring->dymamic)
+        free(ring->buf);
+    free(ring);
+}
+
+/*****************************************************************************
+ * Function:        RING_ReserveBytes(RING_RESERVE * const ring, size_t len)
+
+ * Description:     This function reserves a linear region of len bytes
+
+ * PreCondition:    RING_InitReserve() must be successfully called
+
+ * Input:           ring the RING_RESERVE pre-allocated object
+ len the number of bytes to reserve
+
+ * Return:          The pointer of the reserved region, NULL if there is no room
+
+ * Side Effects:    The record is busy, the consumer stops on it until
+ RING_CommitReserved() or RING_DiscardReserved() is called
+
+ * Overview:        A record that does not fit before the end of the buffer is
+ preceded by a discarded padding record, therefore, it is always linear
+
+ * Note:            Safe to be called concurrently by any number of producers
+ *****************************************************************************/
+uint8_t * RING_ReserveBytes(RING_RESERVE * const ring, size_t len) {
+    size_t head, pos, span, pad;
+    uint8_t *record;
+
+    if (len > RING_RESERVE_MAX_RECORD)
+        return NULL;
+    span = RING_RESERVE_ALIGN(len + RING_RESERVE_HEADER_SIZE);
+    if (span > ring->size)
+        return NULL;
+
+    head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    do {
+        pos = head & (ring->size - 1);
+        pad = (ring->size - pos < span) ? ring->size - pos : 0;
+        if (head + pad + span - atomic_load_explicit(&ring->tail, memory_order_acquire) > ring->size)
+            return NULL;
+    } while (!atomic_compare_exchange_weak_explicit(&ring->head, &head, head + pad + span,
+            memory_order_acq_rel, memory_order_relaxed));
+
+    if (pad > 0) {
+        record = &ring->buf[pos];
+        *RING_ReserveLength(record) = 0;
+        atomic_store_explicit(RING_ReserveHeader(record), (uint_least32_t) pad | RING_RESERVE_DISCARD, memory_order_release);
+    }
+
+    record = &ring->buf[(head + pad) & (ring->size - 1)];
+    *RING_ReserveLength(record) = (uint32_t) len;
+    atomic_store_explicit(RING_ReserveHeader(record), (uint_least32_t) span | RING_RESERVE_BUSY, memory_order_relaxed);
+
+    return record + RING_RESERVE_HEADER_SIZE;
+}
+
+/*****************************************************************************
+ * Function:        RING_CommitReserved(uint8_t *record)
+
+ * Description:     This function publishes a reserved record to the consumer
+
+ * PreCondition:    RING_ReserveBytes() must be successfully called
+
+ * Input:           record the pointer returned by RING_ReserveBytes()
+
+ * Return:          None
+
+ * Side Effects:    None
+
+ * Overview:        None
+
+ * Note:            The record must be completely written before the call
+ *****************************************************************************/
+void RING_CommitReserved(uint8_t *record) {
+    atomic_uint_least32_t *header;
+
+    header = RING_ReserveHeader(record - RING_RESERVE_HEADER_SIZE);
+    atomic_store_explicit(header, atomic_load_explicit(header, memory_order_relaxed) & ~RING_RESERVE_BUSY, memory_order_release);
+}
+
+/*****************************************************************************
+ * Function:        RING_DiscardReserved(uint8_t *record)
+
+ * Description:     This function abandons a reserved record
+
+ * PreCondition:    RING_ReserveBytes() must be successfully called
+
+ * Input:           record the pointer returned by RING_ReserveBytes()
+
+ * Return:          None
+
+ * Side Effects:    None
+
+ * Overview:        None
+
+ * Note:            The consumer silently skips discarded records
+ *****************************************************************************/
+void RING_DiscardReserved(uint8_t *record) {
+    atomic_uint_least32_t *header;
+    uint_least32_t span;
+
+    header = RING_ReserveHeader(record - RING_RESERVE_HEADER_SIZE);
+    span = atomic_load_explicit(header, memory_order_relaxed) & RING_RESERVE_SPAN_MASK;
+    atomic_store_explicit(header, span | RING_RESERVE_DISCARD, memory_order_release);
+}
+
+/*****************************************************************************
+ * Function:        RING_PeekReserved(RING_RESERVE * const ring, size_t *len)
+
+ * Description:     This function returns the oldest committed record without removing it
+
+ * PreCondition:    RING_InitReserve() must be successfully called
+
+ * Input:           ring the RING_RESERVE pre-allocated object
+ len the length of the returned record
+
+ * Return:          The pointer of the record, NULL if the oldest record is
+ still busy or the ring is empty
+
+ * Side Effects:    Discarded records met on the way are released
+
+ * Overview:        None
+
+ * Note:            Must be called by a single consumer thread
+ *****************************************************************************/
+uint8_t * RING_PeekReserved(RING_RESERVE * const ring, size_t *len) {
+    size_t tail;
+    uint_least32_t header;
+    uint8_t *record;
+
+    tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    while (tail != atomic_load_explicit(&ring->head, memory_order_acquire)) {
+        record = &ring->buf[tail & (ring->size - 1)];
+        header = atomic_load_explicit(RING_ReserveHeader(record), memory_order_acquire);
+        if (header == 0 || (header & RING_RESERVE_BUSY) != 0)
+            break;
+        if ((header & RING_RESERVE_DISCARD) == 0) {
+            *len = *RING_ReserveLength(record);
+            return record + RING_RESERVE_HEADER_SIZE;
+        }
+        RING_ReleaseReserved(ring);
+        tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    }
+
+    *len = 0;
+    return NULL;
+}
+
+/*****************************************************************************
+ * Function:        RING_ReleaseReserved(RING_RESERVE * const ring)
+
+ * Description:     This function removes the record returned by RING_PeekReserved()
+
+ * PreCondition:    RING_PeekReserved() must return a record
+
+ * Input:           ring the RING_RESERVE pre-allocated object
+
+ * Return:          None
+
+ * Side Effects:    The record space is cleared and given back to the producers
+
+ * Overview:        Clearing keeps the zero header invariant for the reservations
+ that will land on this space in the next lap
+
+ * Note:            Must be called by a single consumer thread
+ *****************************************************************************/
+void RING_ReleaseReserved(RING_RESERVE * const ring) {
+    size_t tail, span;
+    uint8_t *record;
+
+    tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    record = &ring->buf[tail & (ring->size - 1)];
+    span = atomic_load_explicit(RING_ReserveHeader(record), memory_order_relaxed) & RING_RESERVE_SPAN_MASK;
+    memset(record, 0, span);
+    atomic_store_explicit(&ring->tail, tail + span, memory_order_release);
+}
+
+
+/* *****************************************************************************
+ End of File
+ */
@@ -0,0 +1,108 @@
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+
+ @File Name
+ RingReserve.h
+
+ @Author
+ Luca Pascarella https://lucapascarella.com
+
+ @Summary
+ These functions implement a multi-producer ring of variable-size records.
+
+ @Description
+ This file implements a byte ring where multiple producers concurrently
+ reserve variable-length records. A reservation is a single atomic update
+ of the head, so producers never wait for each other. Each record starts
+ with a header that flags it as busy until the producer commits or
+ discards it. A single consumer reads the records in place and in order,
+ waiting only on the first record that is still busy.
+
+ @License
+ Copyright (C) 2016 LP Systems
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+
+ https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+#ifndef _RING_RESERVE_H    /* Guard against multiple inclusion */
+#define _RING_RESERVE_H
+
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#include <stdatomic.h>
+#include "RingBuffer.h"
+
+/* Provide C++ Compatibility */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+    /* ************************************************************************** */
+    /* ************************************************************************** */
+    /* Section: Constants                                                         */
+    /* ************************************************************************** */
+    /* ************************************************************************** */
+
+#define RING_RESERVE_HEADER_SIZE    8   // Record header, it also sets the record alignment
+#define RING_RESERVE_MAX_RECORD     0x0FFFFFFF
+
+    // *****************************************************************************
+    // *****************************************************************************
+    // Section: Data Types
+    // *****************************************************************************
+    // *****************************************************************************
+
+    typedef struct {
+        uint8_t * buf; // Buffer pointer, 8 bytes aligned
+        size_t size; // Buffer size, always a power of 2
+        atomic_size_t head; // Free running position of the next reservation
+        atomic_size_t tail; // Free running position of the first unread record
+        bool dymamic; // It is true when the user delegates the creation of buf
+    } RING_RESERVE;
+
+
+    // *****************************************************************************
+    // *****************************************************************************
+    // Section: Interface Functions
+    // *****************************************************************************
+    // *****************************************************************************
+
+    // Initialization functions
+    RING_RESERVE * RING_InitReserve(const uint8_t *buf, size_t size);
+    void RING_DeinitializeReserve(RING_RESERVE *ring);
+
+    // Producer functions
+    uint8_t * RING_ReserveBytes(RING_RESERVE * const ring, size_t len);
+    void RING_CommitReserved(uint8_t *record);
+    void RING_DiscardReserved(uint8_t *record);
+
+    // Consumer functions
+    uint8_t * RING_PeekReserved(RING_RESERVE * const ring, size_t *len);
+    void RING_ReleaseReserved(RING_RESERVE * const ring);
+
+
+    /* Provide C++ Compatibility */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RING_RESERVE_H */
+
+/* *****************************************************************************
+ End of File
+ */
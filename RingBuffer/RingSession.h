@@ -0,0 +1,265 @@
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+
+ @File Name
+ RingSession.h
+
+ @Author
+ Luca Pascarella https://lucapascarella.com
+
+ @Summary
+ These functions batch the index updates of byte oriented readers and writers.
+
+ @Description
+ This file implements reader and writer sessions. Opening a session reads
+ the available space once and caches the current linear segment locally,
+ then a byte access is a bounds check and a pointer increment. Closing the
+ session publishes the new tail or head once. All functions are static
+ inline, therefore, a byte oriented parser pays the RING_GetByte() costs
+ once per batch instead of once per byte.
+
+ @License
+ Copyright (C) 2016 LP Systems
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+
+ https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+#ifndef _RING_SESSION_H    /* Guard against multiple inclusion */
+#define _RING_SESSION_H
+
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#include "RingBuffer.h"
+
+/* Provide C++ Compatibility */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+    // *****************************************************************************
+    // *****************************************************************************
+    // Section: Data Types
+    // *****************************************************************************
+    // *****************************************************************************
+
+    typedef struct {
+        RING_DATA *ring; // The ring being accessed
+        size_t *publish; // Refers to the ring tail for readers, to the head for writers
+        uint8_t *ptr; // Next byte of the current segment
+        uint8_t *end; // End of the current segment
+        size_t second; // Length of the segment at the buffer begin, not yet entered
+    } RING_SESSION;
+
+
+    // *****************************************************************************
+    // *****************************************************************************
+    // Section: Local Functions
+    // *****************************************************************************
+    // *****************************************************************************
+
+    // Splits count bytes starting at index into the current and the second segment
+
+    static inline void RING_StartSession(RING_SESSION *session, RING_DATA * const ring, size_t *publish, size_t count) {
+        size_t first;
+
+        first = min(count, ring->size - *publish);
+        session->ring = ring;
+        session->publish = publish;
+        session->ptr = &ring->buf[*publish];
+        session->end = session->ptr + first;
+        session->second = count - first;
+    }
+
+    // Enters the second segment, false if the snapshot is exhausted
+
+    static inline bool RING_NextSessionSegment(RING_SESSION *session) {
+        if (session->second == 0)
+            return false;
+        session->ptr = session->ring->buf;
+        session->end = session->ptr + session->second;
+        session->second = 0;
+        return true;
+    }
+
+
+    // *****************************************************************************
+    // *****************************************************************************
+    // Section: Interface Functions
+    // *****************************************************************************
+    // *****************************************************************************
+
+    /*****************************************************************************
+     * Function:        RING_OpenReadSession(RING_SESSION *session, RING_DATA * const ring)
+
+     * Description:     This function starts a batch of byte reads
+
+     * PreCondition:    RING_InitBuffer() must be successfully called
+
+     * Input:           session the RING_SESSION to initialize, usually on the stack
+     ring the RING_DATA pre-allocated object
+
+     * Return:          The number of bytes readable in this session
+
+     * Side Effects:    None
+
+     * Overview:        The filled space is read once, bytes written by the producer
+     after this call are seen by the next session
+
+     * Note:            RING_CloseSession() must be called to consume the read bytes
+     *****************************************************************************/
+    static inline size_t RING_OpenReadSession(RING_SESSION *session, RING_DATA * const ring) {
+        size_t count;
+
+        count = RING_GetFullSpace(ring);
+        RING_StartSession(session, ring, &ring->tail, count);
+        return count;
+    }
+
+    /*****************************************************************************
+     * Function:        RING_OpenWriteSession(RING_SESSION *session, RING_DATA * const ring)
+
+     * Description:     This function starts a batch of byte writes
+
+     * PreCondition:    RING_InitBuffer() must be successfully called
+
+     * Input:           session the RING_SESSION to initialize, usually on the stack
+     ring the RING_DATA pre-allocated object
+
+     * Return:          The number of bytes writable in this session
+
+     * Side Effects:    None
+
+     * Overview:        The free space is read once
+
+     * Note:            RING_CloseSession() must be called to publish the written bytes
+     *****************************************************************************/
+    static inline size_t RING_OpenWriteSession(RING_SESSION *session, RING_DATA * const ring) {
+        size_t count;
+
+        count = RING_GetFreeSpace(ring);
+        RING_StartSession(session, ring, &ring->head, count);
+        return count;
+    }
+
+    /*****************************************************************************
+     * Function:        RING_SessionGetByte(RING_SESSION *session, uint8_t *byte)
+
+     * Description:     This function reads a byte of a read session
+
+     * PreCondition:    RING_OpenReadSession() must be successfully called
+
+     * Input:           session the RING_SESSION object
+     byte* read back byte
+
+     * Return:          true if the byte is read
+
+     * Side Effects:    None
+
+     * Overview:        None
+
+     * Note:            The ring tail is unchanged until RING_CloseSession()
+     *****************************************************************************/
+    static inline bool RING_SessionGetByte(RING_SESSION *session, uint8_t *byte) {
+        if (session->ptr == session->end && !RING_NextSessionSegment(session))
+            return false;
+        *byte = *session->ptr++;
+        return true;
+    }
+
+    /*****************************************************************************
+     * Function:        RING_SessionPutByte(RING_SESSION *session, uint8_t val)
+
+     * Description:     This function writes a byte of a write session
+
+     * PreCondition:    RING_OpenWriteSession() must be successfully called
+
+     * Input:           session the RING_SESSION object
+     val the byte to write
+
+     * Return:          true if the byte is written
+
+     * Side Effects:    None
+
+     * Overview:        None
+
+     * Note:            The ring head is unchanged until RING_CloseSession()
+     *****************************************************************************/
+    static inline bool RING_SessionPutByte(RING_SESSION *session, uint8_t val) {
+        if (session->ptr == session->end && !RING_NextSessionSegment(session))
+            return false;
+        *session->ptr++ = val;
+        return true;
+    }
+
+    /*****************************************************************************
+     * Function:        RING_GetSessionSpace(const RING_SESSION *session)
+
+     * Description:     This function returns the bytes left in the session
+
+     * PreCondition:    RING_OpenReadSession() or RING_OpenWriteSession() must be successfully called
+
+     * Input:           session the RING_SESSION object
+
+     * Return:          The number of bytes still readable or writable
+
+     * Side Effects:    None
+
+     * Overview:        None
+
+     * Note:            None
+     *****************************************************************************/
+    static inline size_t RING_GetSessionSpace(const RING_SESSION *session) {
+        return (size_t) (session->end - session->ptr) + session->second;
+    }
+
+    /*****************************************************************************
+     * Function:        RING_CloseSession(RING_SESSION *session)
+
+     * Description:     This function publishes the bytes read or written in the session
+
+     * PreCondition:    RING_OpenReadSession() or RING_OpenWriteSession() must be successfully called
+
+     * Input:           session the RING_SESSION object
+
+     * Return:          None
+
+     * Side Effects:    The ring tail or head moves once
+
+     * Overview:        None
+
+     * Note:            A session can be closed more than once, e.g. to publish
+     partial progress, and it can go on after each close
+     *****************************************************************************/
+    static inline void RING_CloseSession(RING_SESSION *session) {
+        size_t index;
+
+        index = (size_t) (session->ptr - session->ring->buf);
+        *session->publish = index == session->ring->size ? 0 : index;
+    }
+
+
+    /* Provide C++ Compatibility */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RING_SESSION_H */
+
+/* *****************************************************************************
+ End of File
+ */
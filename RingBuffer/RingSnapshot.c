@@ -0,0 +1,295 @@
+
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+
+ @File Name
+ RingSnapshot.c
+
+ @Author
+ Luca Pascarella https://lucapascarella.com
+
+ @Summary
+ These functions copy consistent snapshots of a live ring buffer.
+
+ @Description
+ This file implements a ring whose filled space, or its most recent bytes,
+ can be copied by a third thread while the producer and the consumer keep
+ running. The head and the tail are atomic and the producer stores the bytes
+ with relaxed atomics, so the reader may race with it without undefined
+ behaviour. Like a sequence lock, the tail is read before and after the copy
+ and the copy is repeated only when the consumer moved the tail into the
+ copied range, the only case in which the producer may have overwritten it.
+ @License
+ Copyright (C) 2016 LP Systems
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+
+ https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#include <stdatomic.h>
+#include <string.h>
+#include "RingSnapshot.h"
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Local Functions                                                   */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+// The producer stores may race with a snapshot, byte atomics keep both sides defined
+
+static void RING_SnapshotStore(uint8_t *dst, const uint8_t *src, size_t len) {
+    size_t i;
+
+    for (i = 0; i < len; i++)
+        __atomic_store_n(&dst[i], src[i], __ATOMIC_RELAXED);
+}
+
+static void RING_SnapshotLoad(uint8_t *dst, const uint8_t *src, size_t len) {
+    size_t i;
+
+    for (i = 0; i < len; i++)
+        dst[i] = __atomic_load_n(&src[i], __ATOMIC_RELAXED);
+}
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Interface Functions                                               */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+/*****************************************************************************
+ * Function:        RING_SNAPSHOT * RING_InitSnapshot(const uint8_t *buf, size_t size)
+
+ * Description:     This function creates a RING_SNAPSHOT object
+
+ * PreCondition:    None
+
+ * Input:           buf is the predefined ring buffer, NULL to require a dynamic allocation
+ size is the size of the pre-allocated memory or the required memory
+
+ * Return:          Pointer to a RING_SNAPSHOT type allocated in the dynamic memory
+
+ * Side Effects:    RING_DeinitializeSnapshot() must be called to correctly release dynamic memory
+
+ * Overview:        None
+
+ * Note:            The size follows the RING_InitBuffer() rounding
+ *****************************************************************************/
+RING_SNAPSHOT * RING_InitSnapshot(const uint8_t *buf, size_t size) {
+
+    RING_SNAPSHOT *snapshot;
+
+    if ((snapshot = malloc(sizeof (RING_SNAPSHOT))) == NULL)
+        return NULL;
+
+    if ((snapshot->ring = RING_InitBuffer(buf, size)) == NULL) {
+        free(snapshot);
+        return NULL;
+    }
+    atomic_init(&snapshot->head, 0);
+    atomic_init(&snapshot->tail, 0);
+
+    return snapshot;
+}
+
+/*****************************************************************************
+ * Function:        RING_DeinitializeSnapshot(RING_SNAPSHOT *snapshot)
+
+ * Description:     This function releases the ring and the snapshot object
+
+ * PreCondition:    RING_InitSnapshot() must be successfully called
+
+ * Input:           snapshot the RING_SNAPSHOT pre-allocated object
+
+ * Return:          None
+
+ * Side Effects:    Dynamic memory will be released
+
+ * Overview:        None
+
+ * Note:            None
+ *****************************************************************************/
+void RING_DeinitializeSnapshot(RING_SNAPSHOT *snapshot) {
+    RING_DeinitializeBuffer(snapshot->ring);
+    free(snapshot);
+}
+
+/*****************************************************************************
+ * Function:        RING_AddSnapshotBuffer(RING_SNAPSHOT *snapshot, const uint8_t *buf, size_t size)
+
+ * Description:     This function copies the given buffer into the ring
+
+ * PreCondition:    RING_InitSnapshot() must be successfully called
+
+ * Input:           snapshot the RING_SNAPSHOT pre-allocated object
+ buf pointer of the buffer to copy
+ size number of bytes to copy
+
+ * Return:          The number of actual bytes copied
+
+ * Side Effects:    None
+
+ * Overview:        None
+
+ * Note:            Must be called by a single producer thread
+ *****************************************************************************/
+size_t RING_AddSnapshotBuffer(RING_SNAPSHOT *snapshot, const uint8_t *buf, size_t size) {
+    RING_DATA *ring;
+    size_t head, tail, added, first;
+
+    ring = snapshot->ring;
+    head = atomic_load_explicit(&snapshot->head, memory_order_relaxed);
+    // The bytes are overwritten after the tail that freed them
+    tail = atomic_load_explicit(&snapshot->tail, memory_order_acquire);
+    // A snapshot that reads an overwritten byte then reads this tail or a later one
+    atomic_thread_fence(memory_order_release);
+
+    // One byte is always kept free as in RING_DATA
+    added = min(ring->size - 1 - RING_FastDistance(ring, tail, head), size);
+    first = min(added, ring->size - head);
+    RING_SnapshotStore(&ring->buf[head], buf, first);
+    RING_SnapshotStore(ring->buf, &buf[first], added - first);
+
+    // The bytes are visible before the head that covers them
+    atomic_store_explicit(&snapshot->head, RING_FastAdvance(ring, head, added), memory_order_release);
+    return added;
+}
+
+/*****************************************************************************
+ * Function:        RING_GetSnapshotBuffer(RING_SNAPSHOT *snapshot, uint8_t *ptr, size_t len)
+
+ * Description:     This function gets and consumes up to len bytes of the ring
+
+ * PreCondition:    RING_InitSnapshot() must be successfully called
+
+ * Input:           snapshot the RING_SNAPSHOT pre-allocated object
+ ptr user destination buffer
+ len user destination length
+
+ * Return:          The actual number of got bytes
+
+ * Side Effects:    None
+
+ * Overview:        The producer never writes the filled space, so a plain copy is enough
+
+ * Note:            Must be called by a single consumer thread
+ *****************************************************************************/
+size_t RING_GetSnapshotBuffer(RING_SNAPSHOT *snapshot, uint8_t *ptr, size_t len) {
+    RING_DATA *ring;
+    size_t head, tail, got, first;
+
+    ring = snapshot->ring;
+    tail = atomic_load_explicit(&snapshot->tail, memory_order_relaxed);
+    // The bytes are read after the head that covers them
+    head = atomic_load_explicit(&snapshot->head, memory_order_acquire);
+
+    got = min(RING_FastDistance(ring, tail, head), len);
+    first = min(got, ring->size - tail);
+    memcpy(ptr, &ring->buf[tail], first);
+    memcpy(&ptr[first], ring->buf, got - first);
+
+    // The bytes are read before the producer can reuse them
+    atomic_store_explicit(&snapshot->tail, RING_FastAdvance(ring, tail, got), memory_order_release);
+    return got;
+}
+
+/*****************************************************************************
+ * Function:        RING_GetSnapshotFullSpace(const RING_SNAPSHOT *snapshot)
+
+ * Description:     This function returns the filled space of the ring
+
+ * PreCondition:    RING_InitSnapshot() must be successfully called
+
+ * Input:           snapshot the RING_SNAPSHOT pre-allocated object
+
+ * Return:          The number of filled bytes
+
+ * Side Effects:    None
+
+ * Overview:        None
+
+ * Note:            The value is a snapshot when producer or consumer are running
+ *****************************************************************************/
+size_t RING_GetSnapshotFullSpace(const RING_SNAPSHOT *snapshot) {
+    size_t tail;
+
+    tail = atomic_load_explicit(&snapshot->tail, memory_order_acquire);
+    return RING_FastDistance(snapshot->ring, tail, atomic_load_explicit(&snapshot->head, memory_order_acquire));
+}
+
+/*****************************************************************************
+ * Function:        RING_GetSnapshot(const RING_SNAPSHOT *snapshot, uint8_t *ptr, size_t len, size_t *copied)
+
+ * Description:     This function copies the most recent len bytes of the filled
+ space without consuming them and without stopping producer and consumer
+
+ * PreCondition:    RING_InitSnapshot() must be successfully called
+
+ * Input:           snapshot the RING_SNAPSHOT pre-allocated object
+ ptr user destination buffer
+ len user destination length, the whole filled space is copied when it is larger
+ copied it receives the number of copied bytes
+
+ * Return:          true if the copy is consistent, false if the tail passed
+ into the copied range RING_SNAPSHOT_RETRIES times in a row
+
+ * Side Effects:    None
+
+ * Overview:        The tail is read before the head, so the filled space seen is
+ never negative. The producer only writes the free space, therefore, the copy
+ is torn only if the tail moved past its first byte in the meantime
+
+ * Note:            A consumer that consumes a whole ring size or more during a
+ single copy is not detected, the lap is hidden by the modular distance.
+ The copy is not retried when only the head moves, new bytes are simply
+ not part of the snapshot
+ *****************************************************************************/
+bool RING_GetSnapshot(const RING_SNAPSHOT *snapshot, uint8_t *ptr, size_t len, size_t *copied) {
+    const RING_DATA *ring;
+    size_t attempt, tail, head, full, count, start, first, now;
+
+    ring = snapshot->ring;
+    for (attempt = 0; attempt < RING_SNAPSHOT_RETRIES; attempt++) {
+        tail = atomic_load_explicit(&snapshot->tail, memory_order_acquire);
+        head = atomic_load_explicit(&snapshot->head, memory_order_acquire);
+        full = RING_FastDistance(ring, tail, head);
+        count = min(len, full);
+
+        start = head >= count ? head - count : head + ring->size - count;
+        first = min(count, ring->size - start);
+        RING_SnapshotLoad(ptr, &ring->buf[start], first);
+        RING_SnapshotLoad(&ptr[first], ring->buf, count - first);
+
+        // Pairs with the producer fence, a byte overwritten during the copy
+        // implies that the tail read below already passed it
+        atomic_thread_fence(memory_order_acquire);
+        now = atomic_load_explicit(&snapshot->tail, memory_order_relaxed);
+        if (RING_FastDistance(ring, tail, now) <= full - count) {
+            *copied = count;
+            return true;
+        }
+    }
+
+    *copied = 0;
+    return false;
+}
+
+/* *****************************************************************************
+ End of File
+ */
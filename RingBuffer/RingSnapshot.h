@@ -0,0 +1,105 @@
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+
+ @File Name
+ RingSnapshot.h
+
+ @Author
+ Luca Pascarella https://lucapascarella.com
+
+ @Summary
+ These functions copy consistent snapshots of a live ring buffer.
+
+ @Description
+ This file implements a ring whose filled space, or its most recent bytes,
+ can be copied by a third thread while the producer and the consumer keep
+ running. The head and the tail are atomic and the producer stores the bytes
+ with relaxed atomics, so the reader may race with it without undefined
+ behaviour. Like a sequence lock, the tail is read before and after the copy
+ and the copy is repeated only when the consumer moved the tail into the
+ copied range, the only case in which the producer may have overwritten it.
+ @License
+ Copyright (C) 2016 LP Systems
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+
+ https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+#ifndef _RING_SNAPSHOT_H    /* Guard against multiple inclusion */
+#define _RING_SNAPSHOT_H
+
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#include <stdatomic.h>
+#include "RingBuffer.h"
+
+/* Provide C++ Compatibility */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+    /* ************************************************************************** */
+    /* ************************************************************************** */
+    /* Section: Constants                                                         */
+    /* ************************************************************************** */
+    /* ************************************************************************** */
+
+#define RING_SNAPSHOT_RETRIES   8       // Copies attempted before giving up
+
+
+    // *****************************************************************************
+    // *****************************************************************************
+    // Section: Data Types
+    // *****************************************************************************
+    // *****************************************************************************
+
+    typedef struct {
+        RING_DATA *ring; // Memory and size of the ring, its head and tail are not used
+        atomic_size_t head; // Written by the producer only
+        atomic_size_t tail; // Written by the consumer only
+    } RING_SNAPSHOT;
+
+
+    // *****************************************************************************
+    // *****************************************************************************
+    // Section: Interface Functions
+    // *****************************************************************************
+    // *****************************************************************************
+
+    // Initialization functions
+    RING_SNAPSHOT * RING_InitSnapshot(const uint8_t *buf, size_t size);
+    void RING_DeinitializeSnapshot(RING_SNAPSHOT *snapshot);
+
+    // Producer and consumer functions
+    size_t RING_AddSnapshotBuffer(RING_SNAPSHOT *snapshot, const uint8_t *buf, size_t size);
+    size_t RING_GetSnapshotBuffer(RING_SNAPSHOT *snapshot, uint8_t *ptr, size_t len);
+    size_t RING_GetSnapshotFullSpace(const RING_SNAPSHOT *snapshot);
+
+    // Snapshot functions
+    bool RING_GetSnapshot(const RING_SNAPSHOT *snapshot, uint8_t *ptr, size_t len, size_t *copied);
+
+
+    /* Provide C++ Compatibility */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RING_SNAPSHOT_H */
+
+/* *****************************************************************************
+ End of File
+ */
@@ -0,0 +1,180 @@
+
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+
+ @File Name
+ RingTransfer.c
+
+ @Author
+ Luca Pascarella https://lucapascarella.com
+
+ @Summary
+ These functions move buffered data from a ring to another ring.
+
+ @Description
+ This file implements a ring to ring transfer that copies straight from
+ the filled segments of the source to the free segments of the destination,
+ without a temporary buffer. When both rings are mapped with
+ RING_InitMappedBuffer() and the data is page aligned alike, the whole pages
+ are moved with mremap() instead of being copied.
+
+ @License
+ Copyright (C) 2016 LP Systems
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+
+ https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE     // mremap()
+#endif
+
+#include <string.h>
+#include "RingTransfer.h"
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#if defined(MREMAP_FIXED)
+#define RING_TRANSFER_REMAP
+#endif
+#endif
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Local Functions                                                   */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+// Copies count bytes segment by segment, three memcpy() at most
+
+static void RING_TransferCopy(RING_DATA * const dst, RING_DATA * const src, size_t count) {
+    size_t n;
+
+    while (count > 0) {
+        n = min(count, min(src->size - src->tail, dst->size - dst->head));
+        memcpy(&dst->buf[dst->head], &src->buf[src->tail], n);
+        RING_IncreaseTail(src, n);
+        RING_IncreaseHead(dst, n);
+        count -= n;
+    }
+}
+
+#ifdef RING_TRANSFER_REMAP
+
+// Moves the whole pages of a linear run, it returns the number of bytes moved
+// and clears *intact when a failed move cannot be undone
+
+static size_t RING_TransferPages(RING_DATA * const dst, RING_DATA * const src, size_t count, bool *intact) {
+    size_t page, done, linear, pages;
+    void *spare;
+
+    page = (size_t) sysconf(_SC_PAGESIZE);
+    if ((src->tail & (page - 1)) != (dst->head & (page - 1)))
+        return 0;
+
+    // Head of the data up to the page boundary
+    done = min(count, (page - (src->tail & (page - 1))) & (page - 1));
+    RING_TransferCopy(dst, src, done);
+
+    linear = min(count - done, min(src->size - src->tail, dst->size - dst->head));
+    pages = linear & ~(page - 1);
+    if (pages == 0)
+        return done;
+
+    // The zero pages filling the source hole are reserved before touching the
+    // rings, without them the caller copies
+    spare = mmap(NULL, pages, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (spare == MAP_FAILED)
+        return done;
+
+    // The source pages move to the destination and the spare fills the hole
+    if (mremap(&src->buf[src->tail], pages, pages, MREMAP_MAYMOVE | MREMAP_FIXED, &dst->buf[dst->head]) == MAP_FAILED) {
+        munmap(spare, pages);
+        return done;
+    }
+    if (mremap(spare, pages, pages, MREMAP_MAYMOVE | MREMAP_FIXED, &src->buf[src->tail]) == MAP_FAILED) {
+        // The pages go back and the spare fills the destination instead
+        if (mremap(&dst->buf[dst->head], pages, pages, MREMAP_MAYMOVE | MREMAP_FIXED, &src->buf[src->tail]) == MAP_FAILED
+                || mremap(spare, pages, pages, MREMAP_MAYMOVE | MREMAP_FIXED, &dst->buf[dst->head]) == MAP_FAILED)
+            *intact = false;
+        return done;
+    }
+    RING_IncreaseTail(src, pages);
+    RING_IncreaseHead(dst, pages);
+    return done + pages;
+}
+#endif
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Interface Functions                                               */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+/*****************************************************************************
+ * Function:        RING_Transfer(RING_DATA * const dst, RING_DATA * const src, size_t len)
+
+ * Description:     This function moves up to len bytes from a ring to another ring
+
+ * PreCondition:    RING_InitBuffer() must be successfully called for both rings
+
+ * Input:           dst the RING_DATA receiving the bytes
+ src the RING_DATA providing the bytes
+ len the maximum number of bytes to move
+
+ * Return:          The number of bytes moved, it is short only when a failed page
+ move cannot be undone, errno then reports the mremap() error and the rings
+ must not be used anymore
+
+ * Side Effects:    The source tail and the destination head advance together
+
+ * Overview:        The bytes are copied from the source segments straight into
+ the destination segments. Mapped rings move whole pages with mremap() when
+ at least RING_TRANSFER_REMAP_MIN bytes are moved and the source tail and the
+ destination head have the same offset into a page.
+
+ * Note:            The moved source pages are replaced by zero pages, they are
+ committed again when the source head reaches them. The bytes are copied when
+ the pages cannot be moved
+ *****************************************************************************/
+size_t RING_Transfer(RING_DATA * const dst, RING_DATA * const src, size_t len) {
+    size_t count, done;
+#ifdef RING_TRANSFER_REMAP
+    bool intact;
+#endif
+
+    count = min(len, min(RING_GetFullSpace(src), RING_GetFreeSpace(dst)));
+    done = 0;
+
+#ifdef RING_TRANSFER_REMAP
+    intact = true;
+    if (src->mapped && dst->mapped && count >= RING_TRANSFER_REMAP_MIN)
+        done = RING_TransferPages(dst, src, count, &intact);
+    if (!intact)
+        return done;
+#endif
+
+    RING_TransferCopy(dst, src, count - done);
+    return count;
+}
+
+
+/* *****************************************************************************
+ End of File
+ */
@@ -0,0 +1,81 @@
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+
+ @File Name
+ RingTransfer.h
+
+ @Author
+ Luca Pascarella https://lucapascarella.com
+
+ @Summary
+ These functions move buffered data from a ring to another ring.
+
+ @Description
+ This file implements a ring to ring transfer that copies straight from
+ the filled segments of the source to the free segments of the destination,
+ without a temporary buffer. When both rings are mapped with
+ RING_InitMappedBuffer() and the data is page aligned alike, the whole pages
+ are moved with mremap() instead of being copied.
+
+ @License
+ Copyright (C) 2016 LP Systems
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+
+ https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+#ifndef _RING_TRANSFER_H    /* Guard against multiple inclusion */
+#define _RING_TRANSFER_H
+
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#include "RingBuffer.h"
+
+/* Provide C++ Compatibility */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+    /* ************************************************************************** */
+    /* ************************************************************************** */
+    /* Section: Constants                                                         */
+    /* ************************************************************************** */
+    /* ************************************************************************** */
+
+#define RING_TRANSFER_REMAP_MIN     0x00040000  // Shorter transfers are always copied
+
+
+    // *****************************************************************************
+    // *****************************************************************************
+    // Section: Interface Functions
+    // *****************************************************************************
+    // *****************************************************************************
+
+    // Transfer functions
+    size_t RING_Transfer(RING_DATA * const dst, RING_DATA * const src, size_t len);
+
+
+    /* Provide C++ Compatibility */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RING_TRANSFER_H */
+
+/* *****************************************************************************
+ End of File
+ */
@@ -0,0 +1,406 @@
+
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+
+ @File Name
+ RingTransform.c
+
+ @Author
+ Luca Pascarella https://lucapascarella.com
+
+ @Summary
+ These functions copy data in and out of a ring buffer while transforming it.
+
+ @Description
+ This file implements read and write variants of RING_GetBuffer() and
+ RING_AddBuffer() that apply a transform while copying across both ring
+ segments: byte swap of 16, 32 and 64 bits words, a repeating XOR key whose
+ phase continues across calls, and widening of 16 bits integers to 32 bits.
+ The data is walked once instead of copying and transforming it in place.
+
+ @License
+ Copyright (C) 2016 LP Systems
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+
+ https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#include <string.h>
+#include "RingTransform.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: File Scope or Global Data                                         */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#define RING_TRANSFORM_BLOCK    16
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Local Functions                                                   */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+// Returns the number of source bytes transformed as a unit
+
+static size_t RING_TransformUnit(const RING_TRANSFORM *transform) {
+    switch (transform->type) {
+        case RING_TRANSFORM_SWAP16:
+        case RING_TRANSFORM_WIDEN16:
+            return 2;
+        case RING_TRANSFORM_SWAP32:
+            return 4;
+        case RING_TRANSFORM_SWAP64:
+            return 8;
+        default:
+            return 1;
+    }
+}
+
+// Returns how many destination bytes each source byte produces
+
+static size_t RING_TransformRatio(const RING_TRANSFORM *transform) {
+    return transform->type == RING_TRANSFORM_WIDEN16 ? 2 : 1;
+}
+
+// Transforms n source bytes, n is a multiple of the unit
+
+static void RING_TransformKernel(RING_TRANSFORM *transform, uint8_t *dst, const uint8_t *src, size_t n) {
+    size_t i, k, phase;
+    uint16_t narrow;
+    uint32_t wide;
+#if defined(__SSE2__)
+    __m128i v, zero;
+#endif
+
+    i = 0;
+    switch (transform->type) {
+        case RING_TRANSFORM_SWAP16:
+#if defined(__SSE2__)
+            for (; i + RING_TRANSFORM_BLOCK <= n; i += RING_TRANSFORM_BLOCK) {
+                v = _mm_loadu_si128((const __m128i*) &src[i]);
+                v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+                _mm_storeu_si128((__m128i*) &dst[i], v);
+            }
+#endif
+            for (; i < n; i += 2) {
+                dst[i] = src[i + 1];
+                dst[i + 1] = src[i];
+            }
+            break;
+
+        case RING_TRANSFORM_SWAP32:
+#if defined(__SSE2__)
+            for (; i + RING_TRANSFORM_BLOCK <= n; i += RING_TRANSFORM_BLOCK) {
+                v = _mm_loadu_si128((const __m128i*) &src[i]);
+                v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+                v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+                v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+                _mm_storeu_si128((__m128i*) &dst[i], v);
+            }
+#endif
+            for (; i < n; i += 4)
+                for (k = 0; k < 4; k++)
+                    dst[i + k] = src[i + 3 - k];
+            break;
+
+        case RING_TRANSFORM_SWAP64:
+#if defined(__SSE2__)
+            for (; i + RING_TRANSFORM_BLOCK <= n; i += RING_TRANSFORM_BLOCK) {
+                v = _mm_loadu_si128((const __m128i*) &src[i]);
+                v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+                v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+                v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+                _mm_storeu_si128((__m128i*) &dst[i], v);
+            }
+#endif
+            for (; i < n; i += 8)
+                for (k = 0; k < 8; k++)
+                    dst[i + k] = src[i + 7 - k];
+            break;
+
+        case RING_TRANSFORM_XOR:
+            // After a block the key moves by 16 modulo its length
+            phase = transform->phase;
+            for (; i + RING_TRANSFORM_BLOCK <= n; i += RING_TRANSFORM_BLOCK) {
+#if defined(__SSE2__)
+                v = _mm_loadu_si128((const __m128i*) &src[i]);
+                v = _mm_xor_si128(v, _mm_loadu_si128((const __m128i*) transform->mask[phase]));
+                _mm_storeu_si128((__m128i*) &dst[i], v);
+#else
+                for (k = 0; k < RING_TRANSFORM_BLOCK; k++)
+                    dst[i + k] = src[i + k] ^ transform->mask[phase][k];
+#endif
+                phase = (phase + RING_TRANSFORM_BLOCK) % transform->keyLen;
+            }
+            for (; i < n; i++) {
+                dst[i] = src[i] ^ transform->mask[phase][0];
+                if (++phase == transform->keyLen)
+                    phase = 0;
+            }
+            transform->phase = phase;
+            break;
+
+        case RING_TRANSFORM_WIDEN16:
+#if defined(__SSE2__)
+            zero = _mm_setzero_si128();
+            for (; i + RING_TRANSFORM_BLOCK <= n; i += RING_TRANSFORM_BLOCK) {
+                v = _mm_loadu_si128((const __m128i*) &src[i]);
+                _mm_storeu_si128((__m128i*) &dst[2 * i], _mm_unpacklo_epi16(v, zero));
+                _mm_storeu_si128((__m128i*) &dst[2 * i + RING_TRANSFORM_BLOCK], _mm_unpackhi_epi16(v, zero));
+            }
+#endif
+            for (; i < n; i += 2) {
+                memcpy(&narrow, &src[i], sizeof (narrow));
+                wide = narrow;
+                memcpy(&dst[2 * i], &wide, sizeof (wide));
+            }
+            break;
+
+        default:
+            memcpy(dst, src, n);
+            break;
+    }
+}
+
+// Transforms count bytes of the ring starting at index into a linear buffer
+
+static void RING_TransformOut(RING_TRANSFORM *transform, const RING_DATA * const ring, size_t index, size_t count, uint8_t *dst) {
+    uint8_t unit[8];
+    size_t size, first, whole, ratio;
+
+    size = RING_TransformUnit(transform);
+    ratio = RING_TransformRatio(transform);
+    while (count > 0) {
+        first = min(count, ring->size - index);
+        whole = first - first % size;
+        if (whole > 0) {
+            RING_TransformKernel(transform, dst, &ring->buf[index], whole);
+            index += whole;
+            if (index == ring->size)
+                index = 0;
+        } else {
+            // The unit straddles the wrap
+            memcpy(unit, &ring->buf[index], first);
+            memcpy(&unit[first], ring->buf, size - first);
+            RING_TransformKernel(transform, dst, unit, size);
+            index = size - first;
+            whole = size;
+        }
+        dst += whole * ratio;
+        count -= whole;
+    }
+}
+
+// Transforms count bytes of a linear buffer into the ring starting at index
+
+static void RING_TransformIn(RING_TRANSFORM *transform, RING_DATA * const ring, size_t index, const uint8_t *src, size_t count) {
+    uint8_t unit[8];
+    size_t size, room, whole, ratio;
+
+    size = RING_TransformUnit(transform);
+    ratio = RING_TransformRatio(transform);
+    while (count > 0) {
+        room = ring->size - index;
+        whole = min(count, room / (size * ratio) * size);
+        if (whole > 0) {
+            RING_TransformKernel(transform, &ring->buf[index], src, whole);
+            index += whole * ratio;
+            if (index == ring->size)
+                index = 0;
+        } else {
+            // The transformed unit straddles the wrap
+            RING_TransformKernel(transform, unit, src, size);
+            memcpy(&ring->buf[index], unit, room);
+            memcpy(ring->buf, &unit[room], size * ratio - room);
+            index = size * ratio - room;
+            whole = size;
+        }
+        src += whole;
+        count -= whole;
+    }
+}
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Interface Functions                                               */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+/*****************************************************************************
+ * Function:        RING_TRANSFORM * RING_InitTransform(RING_TRANSFORM_TYPE type)
+
+ * Description:     This function creates a transform for the copy functions
+
+ * PreCondition:    None
+
+ * Input:           type the transform to apply
+
+ * Return:          Pointer to a RING_TRANSFORM type allocated in the dynamic memory
+
+ * Side Effects:    RING_DeinitializeTransform() must be called to correctly release dynamic memory
+
+ * Overview:        None
+
+ * Note:            RING_TRANSFORM_XOR requires RING_SetTransformKey() before use
+ *****************************************************************************/
+RING_TRANSFORM * RING_InitTransform(RING_TRANSFORM_TYPE type) {
+
+    RING_TRANSFORM *transform;
+
+    if (type > RING_TRANSFORM_WIDEN16)
+        return NULL;
+
+    if ((transform = malloc(sizeof (RING_TRANSFORM))) == NULL)
+        return NULL;
+
+    transform->type = type;
+    transform->keyLen = 1;
+    transform->phase = 0;
+    memset(transform->mask, 0, sizeof (transform->mask));
+
+    return transform;
+}
+
+/*****************************************************************************
+ * Function:        RING_DeinitializeTransform(RING_TRANSFORM *transform)
+
+ * Description:     This function releases a transform
+
+ * PreCondition:    RING_InitTransform() must be successfully called
+
+ * Input:           transform the RING_TRANSFORM pre-allocated object
+
+ * Return:          None
+
+ * Side Effects:    Dynamic memory will be released
+
+ * Overview:        None
+
+ * Note:            None
+ *****************************************************************************/
+void RING_DeinitializeTransform(RING_TRANSFORM *transform) {
+    free(transform);
+}
+
+/*****************************************************************************
+ * Function:        RING_SetTransformKey(RING_TRANSFORM *transform, const uint8_t *key, size_t keyLen)
+
+ * Description:     This function sets the XOR key and restarts its phase
+
+ * PreCondition:    RING_InitTransform() must be successfully called
+
+ * Input:           transform the RING_TRANSFORM pre-allocated object
+ key the repeating key
+ keyLen the key length, from 1 to RING_TRANSFORM_MAX_KEY
+
+ * Return:          true if the key is accepted
+
+ * Side Effects:    None
+
+ * Overview:        The key is expanded into 16 bytes blocks, one for each
+ phase, so that a block is masked with a single XOR
+
+ * Note:            Called at the start of every WebSocket frame with its masking key
+ *****************************************************************************/
+bool RING_SetTransformKey(RING_TRANSFORM *transform, const uint8_t *key, size_t keyLen) {
+    size_t phase, k;
+
+    if (keyLen == 0 || keyLen > RING_TRANSFORM_MAX_KEY)
+        return false;
+
+    for (phase = 0; phase < keyLen; phase++)
+        for (k = 0; k < RING_TRANSFORM_BLOCK; k++)
+            transform->mask[phase][k] = key[(phase + k) % keyLen];
+    transform->keyLen = keyLen;
+    transform->phase = 0;
+    return true;
+}
+
+/*****************************************************************************
+ * Function:        RING_AddBufferTransformed(RING_TRANSFORM *transform, RING_DATA * const ring, const uint8_t *buf, size_t size)
+
+ * Description:     This function transforms the given buffer into the ring
+
+ * PreCondition:    RING_InitTransform() must be successfully called
+
+ * Input:           transform the RING_TRANSFORM pre-allocated object
+ ring the RING_DATA pre-allocated object
+ buf pointer of the buffer to copy
+ size number of bytes to copy
+
+ * Return:          The number of bytes of buf consumed
+
+ * Side Effects:    None
+
+ * Overview:        Only whole words are consumed. RING_TRANSFORM_WIDEN16
+ writes twice the consumed bytes into the ring.
+
+ * Note:            A word may straddle the wrap
+ *****************************************************************************/
+size_t RING_AddBufferTransformed(RING_TRANSFORM *transform, RING_DATA * const ring, const uint8_t *buf, size_t size) {
+    size_t count;
+
+    count = min(RING_GetFreeSpace(ring) / RING_TransformRatio(transform), size);
+    count -= count % RING_TransformUnit(transform);
+    RING_TransformIn(transform, ring, ring->head, buf, count);
+    RING_IncreaseHead(ring, count * RING_TransformRatio(transform));
+    return count;
+}
+
+/*****************************************************************************
+ * Function:        RING_GetBufferTransformed(RING_TRANSFORM *transform, RING_DATA * const ring, uint8_t *ptr, size_t len)
+
+ * Description:     This function transforms up to len bytes of the ring into user buffer
+
+ * PreCondition:    RING_InitTransform() must be successfully called
+
+ * Input:           transform the RING_TRANSFORM pre-allocated object
+ ring the RING_DATA pre-allocated object
+ ptr user destination buffer
+ len maximum number of ring bytes to consume
+
+ * Return:          The number of ring bytes consumed
+
+ * Side Effects:    None
+
+ * Overview:        Only whole words are consumed. RING_TRANSFORM_WIDEN16
+ writes twice the consumed bytes into ptr, therefore, ptr must hold 2 * len
+ bytes.
+
+ * Note:            A word may straddle the wrap
+ *****************************************************************************/
+size_t RING_GetBufferTransformed(RING_TRANSFORM *transform, RING_DATA * const ring, uint8_t *ptr, size_t len) {
+    size_t count;
+
+    count = min(RING_GetFullSpace(ring), len);
+    count -= count % RING_TransformUnit(transform);
+    RING_TransformOut(transform, ring, ring->tail, count, ptr);
+    RING_IncreaseTail(ring, count);
+    return count;
+}
+
+
+/* *****************************************************************************
+ End of File
+ */
@@ -0,0 +1,109 @@
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+
+ @File Name
+ RingTransform.h
+
+ @Author
+ Luca Pascarella https://lucapascarella.com
+
+ @Summary
+ These functions copy data in and out of a ring buffer while transforming it.
+
+ @Description
+ This file implements read and write variants of RING_GetBuffer() and
+ RING_AddBuffer() that apply a transform while copying across both ring
+ segments: byte swap of 16, 32 and 64 bits words, a repeating XOR key whose
+ phase continues across calls, and widening of 16 bits integers to 32 bits.
+ The data is walked once instead of copying and transforming it in place.
+
+ @License
+ Copyright (C) 2016 LP Systems
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+
+ https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+#ifndef _RING_TRANSFORM_H    /* Guard against multiple inclusion */
+#define _RING_TRANSFORM_H
+
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#include "RingBuffer.h"
+
+/* Provide C++ Compatibility */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+    /* ************************************************************************** */
+    /* ************************************************************************** */
+    /* Section: Constants                                                         */
+    /* ************************************************************************** */
+    /* ************************************************************************** */
+
+#define RING_TRANSFORM_MAX_KEY      16
+
+    // *****************************************************************************
+    // *****************************************************************************
+    // Section: Data Types
+    // *****************************************************************************
+    // *****************************************************************************
+
+    typedef enum {
+        RING_TRANSFORM_COPY, // Plain copy
+        RING_TRANSFORM_SWAP16, // Reverses the bytes of each 16 bits word
+        RING_TRANSFORM_SWAP32, // Reverses the bytes of each 32 bits word
+        RING_TRANSFORM_SWAP64, // Reverses the bytes of each 64 bits word
+        RING_TRANSFORM_XOR, // XOR with a repeating key, e.g. WebSocket unmasking
+        RING_TRANSFORM_WIDEN16, // Zero extends each native 16 bits word to 32 bits
+    } RING_TRANSFORM_TYPE;
+
+    typedef struct {
+        RING_TRANSFORM_TYPE type; // Applied transform
+        size_t keyLen; // Length of the XOR key
+        size_t phase; // Key index of the next byte
+        uint8_t mask[RING_TRANSFORM_MAX_KEY][16]; // 16 bytes of key starting at each phase
+    } RING_TRANSFORM;
+
+
+    // *****************************************************************************
+    // *****************************************************************************
+    // Section: Interface Functions
+    // *****************************************************************************
+    // *****************************************************************************
+
+    // Initialization functions
+    RING_TRANSFORM * RING_InitTransform(RING_TRANSFORM_TYPE type);
+    void RING_DeinitializeTransform(RING_TRANSFORM *transform);
+    bool RING_SetTransformKey(RING_TRANSFORM *transform, const uint8_t *key, size_t keyLen);
+
+    // Copy functions
+    size_t RING_AddBufferTransformed(RING_TRANSFORM *transform, RING_DATA * const ring, const uint8_t *buf, size_t size);
+    size_t RING_GetBufferTransformed(RING_TRANSFORM *transform, RING_DATA * const ring, uint8_t *ptr, size_t len);
+
+
+    /* Provide C++ Compatibility */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RING_TRANSFORM_H */
+
+/* *****************************************************************************
+ End of File
+ */
@@ -0,0 +1,569 @@
+
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+
+ @File Name
+ RingUring.c
+
+ @Author
+ Luca Pascarella https://lucapascarella.com
+
+ @Summary
+ These functions move data between file descriptors and a ring buffer with io_uring.
+
+ @Description
+ This file implements an asynchronous I/O engine for a RING_DATA object on
+ Linux. The ring memory is registered as a fixed io_uring buffer. Reads are
+ submitted straight into the free segments and writes straight from the
+ filled segments, so several transfers are in flight without a thread per
+ file descriptor. The head and the tail are advanced only when the
+ completions are reaped, in submission order, therefore, a region that is
+ still in flight is never exposed to the ring user.
+
+ @License
+ Copyright (C) 2016 LP Systems
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+
+ https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+#ifdef __linux__
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE     // MAP_POPULATE, syscall()
+#endif
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include "RingUring.h"
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: File Scope or Global Data                                         */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+// The user data of a request is its queue slot, this bit marks the writes
+#define RING_URING_WRITE_FLAG   ((uint64_t) 1 << 32)
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Local Functions                                                   */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+static inline size_t RING_UringAdvance(const RING_DATA * const ring, size_t index, size_t count) {
+    return RING_FastAdvance(ring, index, count);
+}
+
+// Same as RING_GetFreeLinearSpace() but starting from a reservation cursor
+
+static size_t RING_UringFreeLinear(const RING_DATA * const ring, size_t from) {
+    if (from >= ring->tail) {
+        if (ring->tail == 0)
+            return ring->size - from - 1;
+        else
+            return ring->size - from;
+    } else {
+        return ring->tail - from - 1;
+    }
+}
+
+// Same as RING_GetFullLinearSpace() but starting from a release cursor
+
+static size_t RING_UringFullLinear(const RING_DATA * const ring, size_t from) {
+    if (ring->head >= from)
+        return ring->head - from;
+    else
+        return ring->size - from;
+}
+
+static RING_URING_OP * RING_UringPush(RING_URING *uring, RING_URING_QUEUE *queue, unsigned *slot) {
+    *slot = (queue->first + queue->count) % uring->depth;
+    queue->count++;
+    return &queue->ops[*slot];
+}
+
+static void RING_UringPrepare(RING_URING *uring, struct io_uring_sqe *sqe, bool write,
+        int fd, const RING_URING_OP *op, unsigned slot) {
+    memset(sqe, 0, sizeof (*sqe));
+    if (write)
+        sqe->opcode = uring->fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+    else
+        sqe->opcode = uring->fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+    sqe->fd = fd;
+    sqe->off = (uint64_t) op->offset;
+    sqe->addr = (uint64_t) (uintptr_t) &uring->ring->buf[op->start];
+    sqe->len = (uint32_t) op->len;
+    sqe->buf_index = 0;
+    sqe->user_data = slot | (write ? RING_URING_WRITE_FLAG : 0);
+}
+
+// Hands the queued entries to the kernel, optionally waiting for a completion.
+// Entries not consumed because of EAGAIN, EBUSY or EINTR stay queued for the next call
+
+static void RING_UringEnter(RING_URING *uring, unsigned complete) {
+    unsigned queued;
+
+    queued = *uring->sqTail - __atomic_load_n(uring->sqHead, __ATOMIC_ACQUIRE);
+    if (queued == 0 && complete == 0)
+        return;
+    if (syscall(__NR_io_uring_enter, uring->fd, queued, complete, complete > 0 ? IORING_ENTER_GETEVENTS : 0, NULL, 0) < 0
+            && errno != EAGAIN && errno != EBUSY && errno != EINTR)
+        uring->error = -errno;
+}
+
+static struct io_uring_sqe * RING_UringGetSqe(RING_URING *uring, unsigned *tail) {
+    unsigned index;
+
+    index = *tail & *uring->sqMask;
+    uring->sqArray[index] = index;
+    (*tail)++;
+    return &uring->sqes[index];
+}
+
+// Publishes completed reads, in order, moving the head
+
+static void RING_UringCommitReads(RING_URING *uring) {
+    RING_DATA *ring;
+    RING_URING_OP *op;
+    size_t i, src;
+    int32_t res;
+
+    ring = uring->ring;
+    while (uring->reads.count > 0 && uring->reads.ops[uring->reads.first].done) {
+        op = &uring->reads.ops[uring->reads.first];
+
+        // Positioned reads after a short one are discarded and read again
+        if (op->offset < 0 || !uring->reread) {
+            res = op->res;
+            if (res == -ECANCELED) {
+                res = 0;
+            } else if (res < 0) {
+                uring->error = res;
+                res = 0;
+            } else if (res == 0) {
+                uring->eof = true;
+            }
+
+            if (op->offset >= 0) {
+                if ((size_t) res < op->len) {
+                    uring->reread = true;
+                    uring->rereadOffset = op->offset + res;
+                }
+            } else if (res > 0 && op->start != ring->head) {
+                // An earlier short read of the stream left a hole, close it before publishing
+                for (i = 0, src = op->start; i < (size_t) res; i++, src++)
+                    ring->buf[RING_UringAdvance(ring, ring->head, i)] = ring->buf[src];
+            }
+            RING_IncreaseHead(ring, (size_t) res);
+        }
+
+        uring->reads.first = (uring->reads.first + 1) % uring->depth;
+        uring->reads.count--;
+    }
+
+    if (uring->reads.count == 0) {
+        uring->reserved = ring->head;
+        if (uring->reread) {
+            uring->readOffset = uring->rereadOffset;
+            uring->reread = false;
+        }
+    }
+}
+
+// Releases completed writes, in order, moving the tail
+
+static void RING_UringCommitWrites(RING_URING *uring) {
+    RING_URING_OP *op;
+    int32_t res;
+
+    while (uring->writes.count > 0 && uring->writes.ops[uring->writes.first].done) {
+        op = &uring->writes.ops[uring->writes.first];
+        res = op->res;
+        if (res == -ECANCELED) {
+            res = 0;
+        } else if (res < 0) {
+            uring->error = res;
+            res = 0;
+        }
+
+        // Nothing after a short write can be released
+        if (!uring->rewind) {
+            RING_IncreaseTail(uring->ring, (size_t) res);
+            if ((size_t) res < op->len) {
+                uring->rewind = true;
+                uring->rewindOffset = op->offset >= 0 ? op->offset + res : -1;
+            }
+        }
+
+        uring->writes.first = (uring->writes.first + 1) % uring->depth;
+        uring->writes.count--;
+    }
+
+    if (uring->writes.count == 0 && uring->rewind) {
+        uring->released = uring->ring->tail;
+        uring->writeOffset = uring->rewindOffset;
+        uring->rewind = false;
+    }
+}
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Interface Functions                                               */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+/*****************************************************************************
+ * Function:        RING_URING * RING_InitUring(RING_DATA *ring, unsigned depth)
+
+ * Description:     This function creates an io_uring instance bound to the given ring
+ and registers the ring memory as a fixed buffer
+
+ * PreCondition:    RING_InitBuffer() must be successfully called
+
+ * Input:           ring the RING_DATA pre-allocated object
+ depth the maximum number of transfers in flight
+
+ * Return:          Pointer to a RING_URING type allocated in the dynamic memory,
+ NULL if io_uring is not available
+
+ * Side Effects:    RING_DeinitializeUring() must be called to correctly release the kernel resources
+
+ * Overview:        When the memory cannot be registered, e.g. because of RLIMIT_MEMLOCK,
+ the plain read and write opcodes are used instead of the fixed ones
+
+ * Note:            Both source and sink are disabled until they are set
+ *****************************************************************************/
+RING_URING * RING_InitUring(RING_DATA *ring, unsigned depth) {
+
+    RING_URING *uring;
+    struct io_uring_params params;
+    struct iovec iov;
+    uint8_t *sq, *cq;
+
+    if (ring == NULL || depth == 0)
+        return NULL;
+
+    if ((uring = calloc(1, sizeof (RING_URING))) == NULL)
+        return NULL;
+
+    memset(&params, 0, sizeof (params));
+    if ((uring->fd = (int) syscall(__NR_io_uring_setup, depth, &params)) < 0) {
+        free(uring);
+        return NULL;
+    }
+
+    uring->ring = ring;
+    uring->depth = depth;
+    uring->sqEntries = params.sq_entries;
+    uring->sqPtr = uring->cqPtr = MAP_FAILED;
+    uring->sqes = MAP_FAILED;
+
+    uring->sqLen = params.sq_off.array + params.sq_entries * sizeof (unsigned);
+    uring->cqLen = params.cq_off.cqes + params.cq_entries * sizeof (struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+        uring->sqLen = uring->cqLen = (uring->sqLen > uring->cqLen) ? uring->sqLen : uring->cqLen;
+    uring->sqesLen = params.sq_entries * sizeof (struct io_uring_sqe);
+
+    uring->sqPtr = mmap(NULL, uring->sqLen, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, uring->fd, IORING_OFF_SQ_RING);
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+        uring->cqPtr = uring->sqPtr;
+    else
+        uring->cqPtr = mmap(NULL, uring->cqLen, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, uring->fd, IORING_OFF_CQ_RING);
+    uring->sqes = mmap(NULL, uring->sqesLen, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, uring->fd, IORING_OFF_SQES);
+    uring->reads.ops = calloc(depth, sizeof (RING_URING_OP));
+    uring->writes.ops = calloc(depth, sizeof (RING_URING_OP));
+    if (uring->sqPtr == MAP_FAILED || uring->cqPtr == MAP_FAILED || uring->sqes == MAP_FAILED
+            || uring->reads.ops == NULL || uring->writes.ops == NULL) {
+        RING_DeinitializeUring(uring);
+        return NULL;
+    }
+
+    sq = uring->sqPtr;
+    uring->sqHead = (unsigned *) (sq + params.sq_off.head);
+    uring->sqTail = (unsigned *) (sq + params.sq_off.tail);
+    uring->sqMask = (unsigned *) (sq + params.sq_off.ring_mask);
+    uring->sqArray = (unsigned *) (sq + params.sq_off.array);
+    cq = uring->cqPtr;
+    uring->cqHead = (unsigned *) (cq + params.cq_off.head);
+    uring->cqTail = (unsigned *) (cq + params.cq_off.tail);
+    uring->cqMask = (unsigned *) (cq + params.cq_off.ring_mask);
+    uring->cqes = (struct io_uring_cqe *) (cq + params.cq_off.cqes);
+
+    iov.iov_base = ring->buf;
+    iov.iov_len = ring->size;
+    uring->fixed = syscall(__NR_io_uring_register, uring->fd, IORING_REGISTER_BUFFERS, &iov, 1) == 0;
+
+    uring->readFd = uring->writeFd = -1;
+    uring->readOffset = uring->writeOffset = -1;
+    uring->reserved = ring->head;
+    uring->released = ring->tail;
+
+    return uring;
+}
+
+/*****************************************************************************
+ * Function:        RING_DeinitializeUring(RING_URING *uring)
+
+ * Description:     This function releases the io_uring instance
+
+ * PreCondition:    RING_InitUring() must be successfully called
+
+ * Input:           uring the RING_URING pre-allocated object
+
+ * Return:          None
+
+ * Side Effects:    Dynamic memory and kernel resources will be released
+
+ * Overview:        None
+
+ * Note:            Wait for RING_IsUringIdle() before releasing, otherwise the
+ kernel may still be writing into the ring
+ *****************************************************************************/
+void RING_DeinitializeUring(RING_URING *uring) {
+    if (uring->sqes != MAP_FAILED)
+        munmap(uring->sqes, uring->sqesLen);
+    if (uring->cqPtr != MAP_FAILED && uring->cqPtr != uring->sqPtr)
+        munmap(uring->cqPtr, uring->cqLen);
+    if (uring->sqPtr != MAP_FAILED)
+        munmap(uring->sqPtr, uring->sqLen);
+    close(uring->fd);
+    free(uring->reads.ops);
+    free(uring->writes.ops);
+    free(uring);
+}
+
+/*****************************************************************************
+ * Function:        RING_SetUringSource(RING_URING *uring, int fd, int64_t offset)
+
+ * Description:     This function selects the descriptor read into the free space
+
+ * PreCondition:    RING_InitUring() must be successfully called
+
+ * Input:           uring the RING_URING pre-allocated object
+ fd the source descriptor, -1 to stop reading
+ offset the file offset of the first read, -1 for pipes and sockets
+
+ * Return:          None
+
+ * Side Effects:    The end of file flag is cleared
+
+ * Overview:        None
+
+ * Note:            Reads of a stream are linked, therefore, they complete in order
+ *****************************************************************************/
+void RING_SetUringSource(RING_URING *uring, int fd, int64_t offset) {
+    uring->readFd = fd;
+    uring->readOffset = offset;
+    uring->eof = false;
+}
+
+/*****************************************************************************
+ * Function:        RING_SetUringSink(RING_URING *uring, int fd, int64_t offset)
+
+ * Description:     This function selects the descriptor written from the filled space
+
+ * PreCondition:    RING_InitUring() must be successfully called
+
+ * Input:           uring the RING_URING pre-allocated object
+ fd the sink descriptor, -1 to stop writing
+ offset the file offset of the first write, -1 for pipes and sockets
+
+ * Return:          None
+
+ * Side Effects:    None
+
+ * Overview:        None
+
+ * Note:            Writes of a stream are linked, therefore, they complete in order
+ *****************************************************************************/
+void RING_SetUringSink(RING_URING *uring, int fd, int64_t offset) {
+    uring->writeFd = fd;
+    uring->writeOffset = offset;
+}
+
+/*****************************************************************************
+ * Function:        RING_SubmitUring(RING_URING *uring, size_t chunk)
+
+ * Description:     This function submits reads into the free segments and writes
+ from the filled segments up to the queue depth
+
+ * PreCondition:    RING_InitUring() must be successfully called
+
+ * Input:           uring the RING_URING pre-allocated object
+ chunk the maximum length of a single transfer
+
+ * Return:          The number of transfers queued by this call
+
+ * Side Effects:    The reserved regions are hidden from the ring user until completion
+
+ * Overview:        A stream gets a new linked batch only when its previous batch is
+ over, because unlinked requests on the same stream may complete out of order
+
+ * Note:            Submission errors are reported through the error field. The
+ entries the kernel did not take, e.g. on EAGAIN, stay queued and are handed
+ again by the next RING_SubmitUring() or RING_CompleteUring()
+ *****************************************************************************/
+size_t RING_SubmitUring(RING_URING *uring, size_t chunk) {
+    struct io_uring_sqe *sqe, *last;
+    RING_URING_OP *op;
+    unsigned tail, slot, room;
+    size_t submitted, len;
+
+    // Entries still queued from a previous call are not overwritten
+    tail = *uring->sqTail;
+    room = uring->sqEntries - (tail - __atomic_load_n(uring->sqHead, __ATOMIC_ACQUIRE));
+    submitted = 0;
+
+    last = NULL;
+    if (uring->readFd >= 0 && !uring->eof && !uring->reread && (uring->readOffset >= 0 || uring->reads.count == 0)) {
+        while (uring->reads.count + uring->writes.count < uring->depth && submitted < room) {
+            len = min(RING_UringFreeLinear(uring->ring, uring->reserved), chunk);
+            if (len == 0)
+                break;
+            op = RING_UringPush(uring, &uring->reads, &slot);
+            op->start = uring->reserved;
+            op->len = len;
+            op->offset = uring->readOffset;
+            op->done = false;
+            sqe = RING_UringGetSqe(uring, &tail);
+            RING_UringPrepare(uring, sqe, false, uring->readFd, op, slot);
+            if (uring->readOffset >= 0) {
+                uring->readOffset += len;
+            } else {
+                if (last != NULL)
+                    last->flags |= IOSQE_IO_LINK;
+                last = sqe;
+            }
+            uring->reserved = RING_UringAdvance(uring->ring, uring->reserved, len);
+            submitted++;
+        }
+    }
+
+    last = NULL;
+    if (uring->writeFd >= 0 && !uring->rewind && (uring->writeOffset >= 0 || uring->writes.count == 0)) {
+        while (uring->reads.count + uring->writes.count < uring->depth && submitted < room) {
+            len = min(RING_UringFullLinear(uring->ring, uring->released), chunk);
+            if (len == 0)
+                break;
+            op = RING_UringPush(uring, &uring->writes, &slot);
+            op->start = uring->released;
+            op->len = len;
+            op->offset = uring->writeOffset;
+            op->done = false;
+            sqe = RING_UringGetSqe(uring, &tail);
+            RING_UringPrepare(uring, sqe, true, uring->writeFd, op, slot);
+            if (uring->writeOffset >= 0) {
+                uring->writeOffset += len;
+            } else {
+                if (last != NULL)
+                    last->flags |= IOSQE_IO_LINK;
+                last = sqe;
+            }
+            uring->released = RING_UringAdvance(uring->ring, uring->released, len);
+            submitted++;
+        }
+    }
+
+    if (submitted > 0)
+        __atomic_store_n(uring->sqTail, tail, __ATOMIC_RELEASE);
+    RING_UringEnter(uring, 0);
+
+    return submitted;
+}
+
+/*****************************************************************************
+ * Function:        RING_CompleteUring(RING_URING *uring, bool wait)
+
+ * Description:     This function reaps the completion queue and moves the head and
+ the tail over the transfers completed in submission order
+
+ * PreCondition:    RING_InitUring() must be successfully called
+
+ * Input:           uring the RING_URING pre-allocated object
+ wait true to block until at least one completion is available
+
+ * Return:          The number of reaped completions
+
+ * Side Effects:    The head and the tail of the ring are moved
+
+ * Overview:        A short read of a stream is compacted against the following
+ reads. A short positioned read discards the following reads and, as a short
+ write, makes the missing bytes to be submitted again from its offset
+
+ * Note:            The end of file and the errors are reported through the eof and error fields
+ *****************************************************************************/
+size_t RING_CompleteUring(RING_URING *uring, bool wait) {
+    struct io_uring_cqe *cqe;
+    RING_URING_QUEUE *queue;
+    unsigned head, tail;
+    size_t reaped;
+
+    head = *uring->cqHead;
+    tail = __atomic_load_n(uring->cqTail, __ATOMIC_ACQUIRE);
+    if (wait && head == tail && !RING_IsUringIdle(uring)) {
+        RING_UringEnter(uring, 1);
+        tail = __atomic_load_n(uring->cqTail, __ATOMIC_ACQUIRE);
+    } else {
+        RING_UringEnter(uring, 0);
+    }
+
+    for (reaped = 0; head != tail; head++, reaped++) {
+        cqe = &uring->cqes[head & *uring->cqMask];
+        queue = (cqe->user_data & RING_URING_WRITE_FLAG) ? &uring->writes : &uring->reads;
+        queue->ops[(unsigned) cqe->user_data].res = cqe->res;
+        queue->ops[(unsigned) cqe->user_data].done = true;
+    }
+    __atomic_store_n(uring->cqHead, head, __ATOMIC_RELEASE);
+
+    RING_UringCommitReads(uring);
+    RING_UringCommitWrites(uring);
+
+    return reaped;
+}
+
+/*****************************************************************************
+ * Function:        RING_IsUringIdle(const RING_URING *uring)
+
+ * Description:     This function checks whether any transfer is in flight
+
+ * PreCondition:    RING_InitUring() must be successfully called
+
+ * Input:           uring the RING_URING pre-allocated object
+
+ * Return:          true if no transfer is in flight
+
+ * Side Effects:    None
+
+ * Overview:        None
+
+ * Note:            None
+ *****************************************************************************/
+bool RING_IsUringIdle(const RING_URING *uring) {
+    return uring->reads.count + uring->writes.count == 0;
+}
+
+#endif /* __linux__ */
+
+/* *****************************************************************************
+ End of File
+ */
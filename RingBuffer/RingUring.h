@@ -0,0 +1,142 @@
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+
+ @File Name
+ RingUring.h
+
+ @Author
+ Luca Pascarella https://lucapascarella.com
+
+ @Summary
+ These functions move data between file descriptors and a ring buffer with io_uring.
+
+ @Description
+ This file implements an asynchronous I/O engine for a RING_DATA object on
+ Linux. The ring memory is registered as a fixed io_uring buffer. Reads are
+ submitted straight into the free segments and writes straight from the
+ filled segments, so several transfers are in flight without a thread per
+ file descriptor. The head and the tail are advanced only when the
+ completions are reaped, in submission order, therefore, a region that is
+ still in flight is never exposed to the ring user.
+
+ @License
+ Copyright (C) 2016 LP Systems
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+
+ https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+#ifndef _RING_URING_H    /* Guard against multiple inclusion */
+#define _RING_URING_H
+
+#ifdef __linux__
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#include <linux/io_uring.h>
+#include "RingBuffer.h"
+
+/* Provide C++ Compatibility */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+    // *****************************************************************************
+    // *****************************************************************************
+    // Section: Data Types
+    // *****************************************************************************
+    // *****************************************************************************
+
+    typedef struct {
+        size_t start; // Ring index of the first byte of the transfer
+        size_t len; // Requested length
+        int64_t offset; // File offset, -1 for streams
+        int32_t res; // Completion result
+        bool done; // It is true when the completion has been reaped
+    } RING_URING_OP;
+
+    typedef struct {
+        RING_URING_OP *ops; // Circular queue of transfers in submission order
+        unsigned first; // Oldest transfer
+        unsigned count; // Number of transfers in flight
+    } RING_URING_QUEUE;
+
+    typedef struct {
+        RING_DATA *ring; // The ring used as source and destination
+        int fd; // io_uring file descriptor
+        unsigned depth; // Maximum number of transfers in flight
+        unsigned sqEntries; // Size of the submission queue
+        bool fixed; // It is true when the ring memory is registered
+
+        // Kernel shared submission and completion queues
+        unsigned *sqHead, *sqTail, *sqMask, *sqArray;
+        unsigned *cqHead, *cqTail, *cqMask;
+        struct io_uring_sqe *sqes;
+        struct io_uring_cqe *cqes;
+        void *sqPtr, *cqPtr;
+        size_t sqLen, cqLen, sqesLen;
+
+        // Read side, it fills the free space ahead of the head
+        RING_URING_QUEUE reads;
+        int readFd; // Source descriptor, -1 when disabled
+        int64_t readOffset; // Next source offset, -1 for streams
+        size_t reserved; // Refers to the first byte not yet reserved by a read
+        bool eof; // It is true when the source returned the end of file
+        bool reread; // It is true when a short positioned read must be resubmitted
+        int64_t rereadOffset; // Source offset of the first byte to resubmit
+
+        // Write side, it drains the filled space ahead of the tail
+        RING_URING_QUEUE writes;
+        int writeFd; // Sink descriptor, -1 when disabled
+        int64_t writeOffset; // Next sink offset, -1 for streams
+        size_t released; // Refers to the first byte not yet handed to a write
+        bool rewind; // It is true when a short write must be resubmitted
+        int64_t rewindOffset; // Sink offset of the first byte to resubmit
+
+        int error; // Last negative errno returned by a transfer, 0 if none
+    } RING_URING;
+
+
+    // *****************************************************************************
+    // *****************************************************************************
+    // Section: Interface Functions
+    // *****************************************************************************
+    // *****************************************************************************
+
+    // Initialization functions
+    RING_URING * RING_InitUring(RING_DATA *ring, unsigned depth);
+    void RING_DeinitializeUring(RING_URING *uring);
+    void RING_SetUringSource(RING_URING *uring, int fd, int64_t offset);
+    void RING_SetUringSink(RING_URING *uring, int fd, int64_t offset);
+
+    // Transfer functions
+    size_t RING_SubmitUring(RING_URING *uring, size_t chunk);
+    size_t RING_CompleteUring(RING_URING *uring, bool wait);
+    bool RING_IsUringIdle(const RING_URING *uring);
+
+
+    /* Provide C++ Compatibility */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __linux__ */
+
+#endif /* _RING_URING_H */
+
+/* *****************************************************************************
+ End of File
+ */
@@ -0,0 +1,291 @@
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+
+ @File Name
+ RingView.hpp
+
+ @Author
+ Luca Pascarella https://lucapascarella.com
+
+ @Summary
+ These classes implement a C++ owner and an iterator view of a ring buffer.
+
+ @Description
+ This file provides a move-only owner of a RING_DATA object that releases
+ it automatically, and a random-access range over the filled region that
+ hides the wrap. Standard algorithms and ranges pipelines run directly
+ over the ring memory. The two linear segments are also exposed, so
+ algorithms that benefit from contiguous memory can run per segment.
+
+ @License
+ Copyright (C) 2016 LP Systems
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+
+ https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+#ifndef _RING_VIEW_HPP    /* Guard against multiple inclusion */
+#define _RING_VIEW_HPP
+
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#include <array>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <new>
+#include <ranges>
+#include <span>
+#include <utility>
+
+// The min() macro of RingBuffer.h must not reach the standard headers included later
+#pragma push_macro("min")
+#include "RingBuffer.h"
+#pragma pop_macro("min")
+
+namespace ring {
+
+    // *****************************************************************************
+    // *****************************************************************************
+    // Section: Iterator
+    // *****************************************************************************
+    // *****************************************************************************
+
+    // Random-access iterator over the filled region, positions are relative to the tail
+
+    class Iterator {
+    public:
+        using iterator_concept = std::random_access_iterator_tag;
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::uint8_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::uint8_t *;
+        using reference = std::uint8_t &;
+
+        Iterator() noexcept = default;
+
+        Iterator(std::uint8_t *buf, std::size_t size, std::size_t tail, std::size_t pos) noexcept
+        : buf_(buf), size_(size), tail_(tail), pos_(pos) { }
+
+        reference operator*() const noexcept {
+            std::size_t index = tail_ + pos_;
+            if (index >= size_)
+                index -= size_;
+            return buf_[index];
+        }
+
+        reference operator[](difference_type n) const noexcept {
+            return *(*this + n);
+        }
+
+        Iterator & operator++() noexcept {
+            ++pos_;
+            return *this;
+        }
+
+        Iterator operator++(int) noexcept {
+            Iterator it = *this;
+            ++pos_;
+            return it;
+        }
+
+        Iterator & operator--() noexcept {
+            --pos_;
+            return *this;
+        }
+
+        Iterator operator--(int) noexcept {
+            Iterator it = *this;
+            --pos_;
+            return it;
+        }
+
+        Iterator & operator+=(difference_type n) noexcept {
+            pos_ += n;
+            return *this;
+        }
+
+        Iterator & operator-=(difference_type n) noexcept {
+            pos_ -= n;
+            return *this;
+        }
+
+        friend Iterator operator+(Iterator it, difference_type n) noexcept {
+            return it += n;
+        }
+
+        friend Iterator operator+(difference_type n, Iterator it) noexcept {
+            return it += n;
+        }
+
+        friend Iterator operator-(Iterator it, difference_type n) noexcept {
+            return it -= n;
+        }
+
+        friend difference_type operator-(const Iterator &a, const Iterator &b) noexcept {
+            return static_cast<difference_type> (a.pos_) - static_cast<difference_type> (b.pos_);
+        }
+
+        friend bool operator==(const Iterator &a, const Iterator &b) noexcept {
+            return a.pos_ == b.pos_;
+        }
+
+        friend std::strong_ordering operator<=>(const Iterator &a, const Iterator &b) noexcept {
+            return a.pos_ <=> b.pos_;
+        }
+
+        // Distance from the tail, it is the argument of RING_IncreaseTail() to consume up to here
+        std::size_t position() const noexcept {
+            return pos_;
+        }
+
+    private:
+        std::uint8_t *buf_ = nullptr;
+        std::size_t size_ = 0;
+        std::size_t tail_ = 0;
+        std::size_t pos_ = 0;
+    };
+
+    // *****************************************************************************
+    // *****************************************************************************
+    // Section: View
+    // *****************************************************************************
+    // *****************************************************************************
+
+    // Snapshot of the filled region, it is invalidated by any read of the ring
+
+    class View : public std::ranges::view_interface<View> {
+    public:
+        View() noexcept = default;
+
+        // The bytes are writable through the view, the ring must not be const
+        explicit View(RING_DATA *ring) noexcept
+        : buf_(ring->buf), size_(ring->size), tail_(ring->tail), count_(RING_GetFullSpace(ring)) { }
+
+        Iterator begin() const noexcept {
+            return Iterator(buf_, size_, tail_, 0);
+        }
+
+        Iterator end() const noexcept {
+            return Iterator(buf_, size_, tail_, count_);
+        }
+
+        std::size_t size() const noexcept {
+            return count_;
+        }
+
+        // The filled region as at most two contiguous spans, the second one may be empty
+        std::array<std::span<std::uint8_t>, 2> segments() const noexcept {
+            std::size_t first = (tail_ + count_ <= size_) ? count_ : size_ - tail_;
+            return {std::span<std::uint8_t>(buf_ + tail_, first), std::span<std::uint8_t>(buf_, count_ - first)};
+        }
+
+        // Segmented fast path, f is called once per contiguous span
+        template <typename F>
+        void forEachSegment(F &&f) const {
+            for (std::span<std::uint8_t> segment : segments())
+                if (!segment.empty())
+                    f(segment);
+        }
+
+    private:
+        std::uint8_t *buf_ = nullptr;
+        std::size_t size_ = 0;
+        std::size_t tail_ = 0;
+        std::size_t count_ = 0;
+    };
+
+    // *****************************************************************************
+    // *****************************************************************************
+    // Section: Owner
+    // *****************************************************************************
+    // *****************************************************************************
+
+    // Move-only owner, RING_DeinitializeBuffer() is called by the destructor
+
+    class Buffer {
+    public:
+
+        explicit Buffer(std::size_t size) : Buffer(nullptr, size) { }
+
+        Buffer(std::uint8_t *buf, std::size_t size) : ring_(RING_InitBuffer(buf, size)) {
+            if (ring_ == nullptr)
+                throw std::bad_alloc();
+        }
+
+        // Adopts a ring created through the C interface
+        explicit Buffer(RING_DATA *ring) noexcept : ring_(ring) { }
+
+        Buffer(const Buffer &) = delete;
+        Buffer & operator=(const Buffer &) = delete;
+
+        Buffer(Buffer &&other) noexcept : ring_(std::exchange(other.ring_, nullptr)) { }
+
+        Buffer & operator=(Buffer &&other) noexcept {
+            if (this != &other) {
+                reset();
+                ring_ = std::exchange(other.ring_, nullptr);
+            }
+            return *this;
+        }
+
+        ~Buffer() {
+            reset();
+        }
+
+        void reset() noexcept {
+            if (ring_ != nullptr)
+                RING_DeinitializeBuffer(ring_);
+            ring_ = nullptr;
+        }
+
+        // Gives the ownership back to the caller
+        RING_DATA * release() noexcept {
+            return std::exchange(ring_, nullptr);
+        }
+
+        RING_DATA * get() const noexcept {
+            return ring_;
+        }
+
+        RING_DATA * operator->() const noexcept {
+            return ring_;
+        }
+
+        View view() const noexcept {
+            return View(ring_);
+        }
+
+        // Consumes the bytes before it, it must come from a view of this ring
+        void consume(const Iterator &it) noexcept {
+            RING_IncreaseTail(ring_, it.position());
+        }
+
+    private:
+        RING_DATA *ring_;
+    };
+
+}
+
+template <>
+inline constexpr bool std::ranges::enable_borrowed_range<ring::View> = true;
+
+#endif /* _RING_VIEW_HPP */
+
+/* *****************************************************************************
+ End of File
+ */
@@ -0,0 +1,236 @@
+
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+
+ @File Name
+ RingWatermark.c
+
+ @Author
+ Luca Pascarella https://lucapascarella.com
+
+ @Summary
+ These functions signal the crossings of fill level watermarks of a ring.
+
+ @Description
+ This file implements a pair of watermarks over the filled space of a
+ RING_DATA object. The state turns high when the filled space reaches the
+ high mark and turns low again only when it falls to the low mark, so a
+ producer can pause its source at the high mark and resume it at the low
+ mark without oscillating around a single threshold. Each crossing fires
+ the optional callback once, the state is also readable as a flag by an
+ event loop.
+ @License
+ Copyright (C) 2016 LP Systems
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+
+ https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#include "RingWatermark.h"
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Interface Functions                                               */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+/*****************************************************************************
+ * Function:        RING_WATERMARK * RING_InitWatermark(RING_DATA *ring, size_t low, size_t high, RING_WATERMARK_CALLBACK callback, void *ctx)
+
+ * Description:     This function creates a pair of watermarks over a ring
+
+ * PreCondition:    RING_InitBuffer() must be successfully called
+
+ * Input:           ring the RING_DATA pre-allocated object
+ low the filled space at which the state turns low
+ high the filled space at which the state turns high
+ callback the function called at each crossing, NULL to poll the state only
+ ctx the user context passed to the callback
+
+ * Return:          Pointer to a RING_WATERMARK type allocated in the dynamic memory
+
+ * Side Effects:    RING_DeinitializeWatermark() must be called to correctly release dynamic memory
+
+ * Overview:        The initial state follows the current filled space, no
+ callback is fired
+
+ * Note:            low must be lower than high and high must not exceed the ring capacity
+ *****************************************************************************/
+RING_WATERMARK * RING_InitWatermark(RING_DATA *ring, size_t low, size_t high, RING_WATERMARK_CALLBACK callback, void *ctx) {
+
+    RING_WATERMARK *watermark;
+
+    if (low >= high || high > RING_GetBufferSize(ring) - 1)
+        return NULL;
+
+    if ((watermark = malloc(sizeof (RING_WATERMARK))) == NULL)
+        return NULL;
+
+    watermark->ring = ring;
+    watermark->low = low;
+    watermark->high = high;
+    watermark->callback = callback;
+    watermark->ctx = ctx;
+    atomic_init(&watermark->state, RING_GetFullSpace(ring) >= high);
+
+    return watermark;
+}
+
+/*****************************************************************************
+ * Function:        RING_DeinitializeWatermark(RING_WATERMARK *watermark)
+
+ * Description:     This function releases the watermarks, the ring is kept
+
+ * PreCondition:    RING_InitWatermark() must be successfully called
+
+ * Input:           watermark the RING_WATERMARK pre-allocated object
+
+ * Return:          None
+
+ * Side Effects:    Dynamic memory will be released
+
+ * Overview:        None
+
+ * Note:            None
+ *****************************************************************************/
+void RING_DeinitializeWatermark(RING_WATERMARK *watermark) {
+    free(watermark);
+}
+
+/*****************************************************************************
+ * Function:        RING_UpdateWatermark(RING_WATERMARK *watermark)
+
+ * Description:     This function compares the filled space with the watermarks
+ and fires the callback on a crossing
+
+ * PreCondition:    RING_InitWatermark() must be successfully called
+
+ * Input:           watermark the RING_WATERMARK pre-allocated object
+
+ * Return:          The state after the update, true if high
+
+ * Side Effects:    The callback may be called
+
+ * Overview:        Filled spaces between the marks keep the previous state.
+ The state changes with a compare and swap, so a crossing seen by both the
+ producer and the consumer fires once
+
+ * Note:            It must be called after moving the head or the tail through
+ any function other than RING_AddWatermarkBuffer() and RING_GetWatermarkBuffer().
+ When producer and consumer run on different threads two opposite callbacks
+ may overlap, the callback should act on RING_IsWatermarkHigh()
+ *****************************************************************************/
+bool RING_UpdateWatermark(RING_WATERMARK *watermark) {
+    size_t full;
+    bool state;
+
+    full = RING_GetFullSpace(watermark->ring);
+    state = atomic_load_explicit(&watermark->state, memory_order_relaxed);
+
+    if (!state && full >= watermark->high) {
+        if (atomic_compare_exchange_strong(&watermark->state, &state, true) && watermark->callback != NULL)
+            watermark->callback(watermark->ctx, true);
+    } else if (state && full <= watermark->low) {
+        if (atomic_compare_exchange_strong(&watermark->state, &state, false) && watermark->callback != NULL)
+            watermark->callback(watermark->ctx, false);
+    }
+
+    return atomic_load_explicit(&watermark->state, memory_order_relaxed);
+}
+
+/*****************************************************************************
+ * Function:        RING_IsWatermarkHigh(const RING_WATERMARK *watermark)
+
+ * Description:     This function returns the last computed state
+
+ * PreCondition:    RING_InitWatermark() must be successfully called
+
+ * Input:           watermark the RING_WATERMARK pre-allocated object
+
+ * Return:          true between a high and a low crossing
+
+ * Side Effects:    None
+
+ * Overview:        The ring is not read, an event loop can poll it cheaply
+
+ * Note:            None
+ *****************************************************************************/
+bool RING_IsWatermarkHigh(const RING_WATERMARK *watermark) {
+    return atomic_load_explicit(&watermark->state, memory_order_relaxed);
+}
+
+/*****************************************************************************
+ * Function:        RING_AddWatermarkBuffer(RING_WATERMARK *watermark, uint8_t *buf, size_t size)
+
+ * Description:     This function copies the given buffer into the ring and
+ checks the high mark
+
+ * PreCondition:    RING_InitWatermark() must be successfully called
+
+ * Input:           watermark the RING_WATERMARK pre-allocated object
+ buf pointer of the buffer to copy
+ size number of bytes to copy
+
+ * Return:          The number of actual bytes copied
+
+ * Side Effects:    The callback may be called
+
+ * Overview:        See RING_AddBuffer()
+
+ * Note:            None
+ *****************************************************************************/
+size_t RING_AddWatermarkBuffer(RING_WATERMARK *watermark, uint8_t *buf, size_t size) {
+    size_t added;
+
+    added = RING_AddBuffer(watermark->ring, buf, size);
+    RING_UpdateWatermark(watermark);
+    return added;
+}
+
+/*****************************************************************************
+ * Function:        RING_GetWatermarkBuffer(RING_WATERMARK *watermark, uint8_t *ptr, size_t len)
+
+ * Description:     This function gets up to len bytes from the ring and checks
+ the low mark
+
+ * PreCondition:    RING_InitWatermark() must be successfully called
+
+ * Input:           watermark the RING_WATERMARK pre-allocated object
+ ptr user destination buffer
+ len user destination length
+
+ * Return:          the actual number of got bytes
+
+ * Side Effects:    The callback may be called
+
+ * Overview:        See RING_GetBuffer()
+
+ * Note:            None
+ *****************************************************************************/
+size_t RING_GetWatermarkBuffer(RING_WATERMARK *watermark, uint8_t *ptr, size_t len) {
+    size_t got;
+
+    got = RING_GetBuffer(watermark->ring, ptr, len);
+    RING_UpdateWatermark(watermark);
+    return got;
+}
+
+
+/* *****************************************************************************
+ End of File
+ */
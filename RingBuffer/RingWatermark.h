@@ -0,0 +1,102 @@
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+
+ @File Name
+ RingWatermark.h
+
+ @Author
+ Luca Pascarella https://lucapascarella.com
+
+ @Summary
+ These functions signal the crossings of fill level watermarks of a ring.
+
+ @Description
+ This file implements a pair of watermarks over the filled space of a
+ RING_DATA object. The state turns high when the filled space reaches the
+ high mark and turns low again only when it falls to the low mark, so a
+ producer can pause its source at the high mark and resume it at the low
+ mark without oscillating around a single threshold. Each crossing fires
+ the optional callback once, the state is also readable as a flag by an
+ event loop.
+ @License
+ Copyright (C) 2016 LP Systems
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+
+ https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+#ifndef _RING_WATERMARK_H    /* Guard against multiple inclusion */
+#define _RING_WATERMARK_H
+
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#include <stdatomic.h>
+#include "RingBuffer.h"
+
+/* Provide C++ Compatibility */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+    // *****************************************************************************
+    // *****************************************************************************
+    // Section: Data Types
+    // *****************************************************************************
+    // *****************************************************************************
+
+    // Called once for each crossing with the new state
+    typedef void (*RING_WATERMARK_CALLBACK)(void *ctx, bool high);
+
+    typedef struct {
+        RING_DATA *ring; // The watched ring
+        size_t low; // The state turns low at or below this filled space
+        size_t high; // The state turns high at or above this filled space
+        RING_WATERMARK_CALLBACK callback; // Optional crossing callback
+        void *ctx; // User context passed to the callback
+        atomic_bool state; // It is true between a high and a low crossing
+    } RING_WATERMARK;
+
+
+    // *****************************************************************************
+    // *****************************************************************************
+    // Section: Interface Functions
+    // *****************************************************************************
+    // *****************************************************************************
+
+    // Initialization functions
+    RING_WATERMARK * RING_InitWatermark(RING_DATA *ring, size_t low, size_t high, RING_WATERMARK_CALLBACK callback, void *ctx);
+    void RING_DeinitializeWatermark(RING_WATERMARK *watermark);
+
+    // State functions
+    bool RING_UpdateWatermark(RING_WATERMARK *watermark);
+    bool RING_IsWatermarkHigh(const RING_WATERMARK *watermark);
+
+    // Write and read functions
+    size_t RING_AddWatermarkBuffer(RING_WATERMARK *watermark, uint8_t *buf, size_t size);
+    size_t RING_GetWatermarkBuffer(RING_WATERMARK *watermark, uint8_t *ptr, size_t len);
+
+
+    /* Provide C++ Compatibility */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RING_WATERMARK_H */
+
+/* *****************************************************************************
+ End of File
+ */
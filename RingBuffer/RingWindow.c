@@ -0,0 +1,267 @@
+
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+
+ @File Name
+ RingWindow.c
+
+ @Author
+ Luca Pascarella https://lucapascarella.com
+
+ @Summary
+ These functions implement a sliding window for retransmission over a ring buffer.
+
+ @Description
+ This file adds a third cursor to a RING_DATA object. Sending advances the
+ sent cursor between the tail and the head, while the space is given back
+ to the producer only when the acknowledged bytes move the tail. A
+ retransmission rewinds the sent cursor towards the tail. All operations
+ return pointers into the ring memory, therefore, the in-flight bytes are
+ never copied.
+
+ @License
+ Copyright (C) 2016 LP Systems
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+
+ https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#include "RingWindow.h"
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Local Functions                                                   */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+// Returns the number of bytes going from the from index to the to index
+
+static inline size_t RING_WindowDistance(const RING_DATA * const ring, size_t from, size_t to) {
+    return RING_FastDistance(ring, from, to);
+}
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+// Section: Interface Functions                                               */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+/*****************************************************************************
+ * Function:        RING_WINDOW * RING_InitWindow(RING_DATA *ring)
+
+ * Description:     This function creates a RING_WINDOW object over an existing ring.
+ The sent cursor starts at the ring tail.
+
+ * PreCondition:    RING_InitBuffer() must be successfully called
+
+ * Input:           ring the RING_DATA pre-allocated object
+
+ * Return:          Pointer to a RING_WINDOW type allocated in the dynamic memory
+
+ * Side Effects:    RING_DeinitializeWindow() must be called to correctly release dynamic memory
+
+ * Overview:        None
+
+ * Note:            While the window is in use, the ring tail must be moved only by
+ RING_AcknowledgeWindow()
+ *****************************************************************************/
+RING_WINDOW * RING_InitWindow(RING_DATA *ring) {
+
+    RING_WINDOW *window;
+
+    if (ring == NULL)
+        return NULL;
+
+    if ((window = malloc(sizeof (RING_WINDOW))) == NULL)
+        return NULL;
+
+    window->ring = ring;
+    window->sent = ring->tail;
+
+    return window;
+}
+
+/*****************************************************************************
+ * Function:        RING_DeinitializeWindow(RING_WINDOW *window)
+
+ * Description:     This function releases the window object
+
+ * PreCondition:    RING_InitWindow() must be successfully called
+
+ * Input:           window the RING_WINDOW pre-allocated object
+
+ * Return:          None
+
+ * Side Effects:    Dynamic memory will be released
+
+ * Overview:        None
+
+ * Note:            The underlying ring is not released
+ *****************************************************************************/
+void RING_DeinitializeWindow(RING_WINDOW *window) {
+    free(window);
+}
+
+/*****************************************************************************
+ * Function:        RING_GetWindowUnsentSpace(const RING_WINDOW * const window)
+
+ * Description:     This function returns the number of bytes not yet sent
+
+ * PreCondition:    RING_InitWindow() must be successfully called
+
+ * Input:           window the RING_WINDOW pre-allocated object
+
+ * Return:          The number of bytes between the sent cursor and the head
+
+ * Side Effects:    None
+
+ * Overview:        None
+
+ * Note:            The unsent space may not be linear
+ *****************************************************************************/
+size_t RING_GetWindowUnsentSpace(const RING_WINDOW * const window) {
+    return RING_WindowDistance(window->ring, window->sent, window->ring->head);
+}
+
+/*****************************************************************************
+ * Function:        RING_GetWindowUnsentLinearSpace(const RING_WINDOW * const window)
+
+ * Description:     This function returns the number of linear bytes not yet sent
+
+ * PreCondition:    RING_InitWindow() must be successfully called
+
+ * Input:           window the RING_WINDOW pre-allocated object
+
+ * Return:          The number of linear bytes starting at the sent cursor
+
+ * Side Effects:    None
+
+ * Overview:        None
+
+ * Note:            The linear unsent space may be less than RING_GetWindowUnsentSpace()
+ *****************************************************************************/
+size_t RING_GetWindowUnsentLinearSpace(const RING_WINDOW * const window) {
+    if (window->ring->head >= window->sent)
+        return window->ring->head - window->sent;
+    else
+        return window->ring->size - window->sent;
+}
+
+/*****************************************************************************
+ * Function:        RING_GetWindowInFlightSpace(const RING_WINDOW * const window)
+
+ * Description:     This function returns the number of bytes sent but not yet acknowledged
+
+ * PreCondition:    RING_InitWindow() must be successfully called
+
+ * Input:           window the RING_WINDOW pre-allocated object
+
+ * Return:          The number of bytes between the tail and the sent cursor
+
+ * Side Effects:    None
+
+ * Overview:        None
+
+ * Note:            None
+ *****************************************************************************/
+size_t RING_GetWindowInFlightSpace(const RING_WINDOW * const window) {
+    return RING_WindowDistance(window->ring, window->ring->tail, window->sent);
+}
+
+/*****************************************************************************
+ * Function:        RING_SendWindowDirectly(RING_WINDOW * const window, size_t *toSend, size_t size)
+
+ * Description:     This function returns a pointer of a linear unsent space and
+ moves the sent cursor after it
+
+ * PreCondition:    RING_InitWindow() must be successfully called
+
+ * Input:           window the RING_WINDOW pre-allocated object
+ toSend number of bytes that can be sent from the returned pointer
+ size number of required bytes
+
+ * Return:          The pointer of the first unsent byte
+
+ * Side Effects:    The bytes stay in the ring until they are acknowledged
+
+ * Overview:        None
+
+ * Note:            Call it twice to send across the end of the buffer
+ *****************************************************************************/
+uint8_t * RING_SendWindowDirectly(RING_WINDOW * const window, size_t *toSend, size_t size) {
+    uint8_t *ptr;
+
+    *toSend = min(RING_GetWindowUnsentLinearSpace(window), size);
+    ptr = &window->ring->buf[window->sent];
+    window->sent = RING_FastAdvance(window->ring, window->sent, *toSend);
+
+    return ptr;
+}
+
+/*****************************************************************************
+ * Function:        RING_AcknowledgeWindow(RING_WINDOW * const window, size_t count)
+
+ * Description:     This function releases acknowledged bytes moving the ring tail
+
+ * PreCondition:    RING_InitWindow() must be successfully called
+
+ * Input:           window the RING_WINDOW pre-allocated object
+ count the number of bytes acknowledged by the peer
+
+ * Return:          The number of bytes actually released
+
+ * Side Effects:    The released space becomes free space of the ring
+
+ * Overview:        None
+
+ * Note:            Only sent bytes can be acknowledged, count is clamped to the in-flight space
+ *****************************************************************************/
+size_t RING_AcknowledgeWindow(RING_WINDOW * const window, size_t count) {
+    count = min(RING_GetWindowInFlightSpace(window), count);
+    RING_IncreaseTail(window->ring, count);
+    return count;
+}
+
+/*****************************************************************************
+ * Function:        RING_RewindWindow(RING_WINDOW * const window, size_t count)
+
+ * Description:     This function moves the sent cursor back to retransmit in-flight bytes
+
+ * PreCondition:    RING_InitWindow() must be successfully called
+
+ * Input:           window the RING_WINDOW pre-allocated object
+ count the number of bytes to send again
+
+ * Return:          The number of bytes actually rewound
+
+ * Side Effects:    None
+
+ * Overview:        None
+
+ * Note:            count is clamped to the in-flight space, use SIZE_MAX to go back to the tail
+ *****************************************************************************/
+size_t RING_RewindWindow(RING_WINDOW * const window, size_t count) {
+    count = min(RING_GetWindowInFlightSpace(window), count);
+    window->sent = RING_FastAdvance(window->ring, window->sent, window->ring->size - count);
+    return count;
+}
+
+
+/* *****************************************************************************
+ End of File
+ */
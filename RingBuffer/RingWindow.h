@@ -0,0 +1,96 @@
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+
+ @File Name
+ RingWindow.h
+
+ @Author
+ Luca Pascarella https://lucapascarella.com
+
+ @Summary
+ These functions implement a sliding window for retransmission over a ring buffer.
+
+ @Description
+ This file adds a third cursor to a RING_DATA object. Sending advances the
+ sent cursor between the tail and the head, while the space is given back
+ to the producer only when the acknowledged bytes move the tail. A
+ retransmission rewinds the sent cursor towards the tail. All operations
+ return pointers into the ring memory, therefore, the in-flight bytes are
+ never copied.
+
+ @License
+ Copyright (C) 2016 LP Systems
+
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+
+ https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+#ifndef _RING_WINDOW_H    /* Guard against multiple inclusion */
+#define _RING_WINDOW_H
+
+
+/* ************************************************************************** */
+/* ************************************************************************** */
+/* Section: Included Files                                                    */
+/* ************************************************************************** */
+/* ************************************************************************** */
+
+#include "RingBuffer.h"
+
+/* Provide C++ Compatibility */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+    // *****************************************************************************
+    // *****************************************************************************
+    // Section: Data Types
+    // *****************************************************************************
+    // *****************************************************************************
+
+    typedef struct {
+        RING_DATA *ring; // The ring holding the data, its tail is the release cursor
+        size_t sent; // Refers to the first byte not yet sent into the ring buf
+    } RING_WINDOW;
+
+
+    // *****************************************************************************
+    // *****************************************************************************
+    // Section: Interface Functions
+    // *****************************************************************************
+    // *****************************************************************************
+
+    // Initialization functions
+    RING_WINDOW * RING_InitWindow(RING_DATA *ring);
+    void RING_DeinitializeWindow(RING_WINDOW *window);
+
+    // Space functions
+    size_t RING_GetWindowUnsentSpace(const RING_WINDOW * const window);
+    size_t RING_GetWindowUnsentLinearSpace(const RING_WINDOW * const window);
+    size_t RING_GetWindowInFlightSpace(const RING_WINDOW * const window);
+
+    // Cursor functions
+    uint8_t * RING_SendWindowDirectly(RING_WINDOW * const window, size_t *toSend, size_t size);
+    size_t RING_AcknowledgeWindow(RING_WINDOW * const window, size_t count);
+    size_t RING_RewindWindow(RING_WINDOW * const window, size_t count);
+
+
+    /* Provide C++ Compatibility */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RING_WINDOW_H */
+
+/* *****************************************************************************
+ End of File
+ */
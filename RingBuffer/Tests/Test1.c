@@ -420,3 +420,176 @@ bool Test_LinearGet(void) {
     
     return rtn;
 }
+
+bool Test_StreamingCopy(void) {
+    
+    RING_DATA *ring;
+    uint8_t *src, *dst;
+    size_t i, testSize;
+    bool rtn = true;
+    
+    testSize = 4096;
+    src = malloc(sizeof (char) * testSize);
+    dst = malloc(sizeof (char) * testSize);
+    for (i = 0; i < testSize; i++)
+        src[i] = (uint8_t) rand();
+    
+    ring = RING_InitBuffer(NULL, 8192);
+    rtn &= (ring != NULL);
+    RING_SetCopyPolicy(ring, 256);
+    
+    // Misaligned heads, copies split across the wrap, short copies under the threshold
+    for (i = 0; i < 64; i++) {
+        RING_IncreaseHead(ring, 4093);
+        RING_IncreaseTail(ring, 4093);
+        rtn &= (RING_AddBuffer(ring, &src[i], testSize - 2 * i) == testSize - 2 * i);
+        rtn &= (RING_AddBuffer(ring, src, i) == i);
+        rtn &= (RING_GetBuffer(ring, dst, testSize) == testSize - i);
+        rtn &= (memcmp(dst, &src[i], testSize - 2 * i) == 0);
+        rtn &= (memcmp(&dst[testSize - 2 * i], src, i) == 0);
+    }
+    rtn &= (RING_GetFullSpace(ring) == 0);
+    
+    RING_DeinitializeBuffer(ring);
+    
+    free(src);
+    free(dst);
+    
+    return rtn;
+}
+
+bool Test_FastPath(void) {
+    
+    RING_DATA *ring;
+    uint8_t byte;
+    size_t i;
+    bool rtn = true;
+    
+    ring = RING_InitBuffer(NULL, TEST_1_RING_BUFFER_SPACE);
+    rtn &= (ring != NULL);
+    
+    // Inline accessors and exported symbols must agree at every position
+    for (i = 0; i < 3 * TEST_1_RING_BUFFER_SPACE; i++) {
+        rtn &= (RING_GetFreeSpace(ring) == (RING_GetFreeSpace)(ring));
+        rtn &= (RING_GetFreeLinearSpace(ring) == (RING_GetFreeLinearSpace)(ring));
+        rtn &= (RING_GetFullSpace(ring) == (RING_GetFullSpace)(ring));
+        rtn &= (RING_GetFullLinearSpace(ring) == (RING_GetFullLinearSpace)(ring));
+        rtn &= (RING_GetHeadPointer(ring) == (RING_GetHeadPointer)(ring));
+        rtn &= (RING_GetTailPointer(ring) == (RING_GetTailPointer)(ring));
+        if (i % 3 == 0) {
+            rtn &= RING_AddByte(ring, (uint8_t) i);
+            rtn &= (RING_AddByte)(ring, (uint8_t) (i + 1));
+        } else if (i % 3 == 1) {
+            rtn &= RING_GetByte(ring, &byte);
+            rtn &= (byte == (uint8_t) (i - 1));
+        } else {
+            rtn &= ((RING_GetByteSimple)(ring) == (uint8_t) (i - 1));
+        }
+    }
+    rtn &= (RING_GetFullSpace(ring) == 0);
+    rtn &= !RING_GetByte(ring, &byte);
+    rtn &= !(RING_GetByte)(ring, &byte);
+    
+    RING_DeinitializeBuffer(ring);
+    
+    return rtn;
+}
+
+bool Test_MappedBuffer(void) {
+    
+    RING_DATA *ring;
+    uint8_t src[4096], dst[4096];
+    size_t i, size;
+    bool rtn = true;
+    
+    // Sizes above 4 GiB keep all their bits on 64 bits hosts
+    size = (SIZE_MAX > 0xFFFFFFFFu) ? (size_t) 0x140000000ull : 0x14000000u;
+    ring = RING_InitMappedBuffer(size);
+    if (ring == NULL)
+        return true; // No anonymous mappings on this platform
+    // Not a power of 2, the unreached pages cost nothing so it is never rounded down
+#ifdef POWER_2_OPTIMIZATION
+    rtn &= (RING_GetBufferSize(ring) == size / 5 * 8);
+#else
+    rtn &= (RING_GetBufferSize(ring) == size);
+#endif
+    
+    for (i = 0; i < sizeof (src); i++)
+        src[i] = (uint8_t) (i * 7);
+    for (i = 0; i < 1024; i++) {
+        rtn &= (RING_AddBuffer(ring, src, sizeof (src)) == sizeof (src));
+        rtn &= (RING_GetBuffer(ring, dst, sizeof (dst)) == sizeof (dst));
+    }
+    rtn &= (memcmp(src, dst, sizeof (src)) == 0);
+    
+    // The touched pages are free again, those holding data are kept
+    rtn &= (RING_AddBuffer(ring, src, 100) == 100);
+    rtn &= (RING_ReleaseFreePages(ring) > 0);
+    rtn &= (RING_GetBuffer(ring, dst, sizeof (dst)) == 100);
+    rtn &= (memcmp(src, dst, 100) == 0);
+    
+    RING_DeinitializeBuffer(ring);
+    
+    // Heap rings are never released
+    ring = RING_InitBuffer(NULL, 64);
+    rtn &= (RING_ReleaseFreePages(ring) == 0);
+    RING_DeinitializeBuffer(ring);
+    
+    // An explicit policy is kept, the exact ring wraps at its odd size
+    ring = RING_InitMappedBufferWithPolicy(size, RING_SIZE_EXACT);
+    rtn &= (ring != NULL && RING_GetBufferSize(ring) == size);
+    RING_DeinitializeBuffer(ring);
+    ring = RING_InitMappedBufferWithPolicy(3 * 4096 + 100, RING_SIZE_EXACT);
+    rtn &= (ring != NULL && RING_GetBufferSize(ring) == 3 * 4096 + 100);
+    for (i = 0; i < 10; i++) {
+        rtn &= (RING_AddBuffer(ring, src, 3000) == 3000);
+        rtn &= (RING_GetBuffer(ring, dst, sizeof (dst)) == 3000);
+        rtn &= (memcmp(src, dst, 3000) == 0);
+    }
+    RING_DeinitializeBuffer(ring);
+    
+    return rtn;
+}
+
+bool Test_SizePolicy(void) {
+    
+    RING_DATA *rings[3];
+    RING_SIZE_POLICY policies[3] = {RING_SIZE_EXACT, RING_SIZE_ROUND_UP, RING_SIZE_ROUND_DOWN};
+    size_t sizes[3] = {TEST_1_RING_BUFFER_SPACE, 32, 16};
+    uint8_t buffer[TEST_1_RING_BUFFER_SPACE], byte;
+    size_t i, k, n;
+    bool rtn = true;
+    
+    // Exact and power of 2 rings live side by side
+    for (k = 0; k < 3; k++) {
+        rings[k] = RING_InitBufferWithPolicy(NULL, TEST_1_RING_BUFFER_SPACE, policies[k]);
+        rtn &= (rings[k] != NULL);
+        rtn &= (RING_GetBufferSize(rings[k]) == sizes[k]);
+        rtn &= (RING_GetFreeSpace(rings[k]) == sizes[k] - 1);
+    }
+    
+    for (i = 0; i < 5 * TEST_1_RING_BUFFER_SPACE; i++) {
+        for (k = 0; k < 3; k++) {
+            n = i % sizes[k];
+            rtn &= (RING_AddBuffer(rings[k], buffer, n) == n);
+            rtn &= (RING_GetFullSpace(rings[k]) == n);
+            rtn &= (RING_GetFreeSpace(rings[k]) == sizes[k] - 1 - n);
+            rtn &= RING_AddByte(rings[k], (uint8_t) i) == (n < sizes[k] - 1);
+            RING_IncreaseTail(rings[k], n);
+            if (n < sizes[k] - 1)
+                rtn &= (RING_GetByte(rings[k], &byte) && byte == (uint8_t) i);
+            rtn &= (RING_GetFullSpace(rings[k]) == 0);
+        }
+    }
+    
+    for (k = 0; k < 3; k++)
+        RING_DeinitializeBuffer(rings[k]);
+    
+    // A pre-allocated buffer cannot grow
+    rtn &= (RING_InitBufferWithPolicy(buffer, sizeof (buffer), RING_SIZE_ROUND_UP) == NULL);
+    rings[0] = RING_InitBufferWithPolicy(buffer, 16, RING_SIZE_ROUND_UP);
+    rtn &= (rings[0] != NULL && RING_GetBufferSize(rings[0]) == 16);
+    RING_DeinitializeBuffer(rings[0]);
+    
+    return rtn;
+}
@@ -58,6 +58,10 @@ extern "C" {
     bool Test_MultipleFillLong(void);
     bool Test_LinearAdd(void);
     bool Test_LinearGet(void);
+    bool Test_StreamingCopy(void);
+    bool Test_FastPath(void);
+    bool Test_MappedBuffer(void);
+    bool Test_SizePolicy(void);
     
     
     /* Provide C++ Compatibility */
@@ -0,0 +1,92 @@
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+ 
+ @File Name
+ TestCompact.c
+ 
+ @Author
+ Luca Pascarella https://lucapascarella.com
+ 
+ @Summary
+ This file tests the RingCompact library
+ 
+ @Description
+ This file collects the tests of the compact rings.
+ 
+ @License
+ Copyright (C) 2016 LP Systems
+ 
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+ 
+ https://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+#include "TestCompact.h"
+
+#define TEST_COMPACT_RINGS      100000
+
+bool Test_CompactLazyStorage(void) {
+    RING_POOL *pool;
+    RING_HANDLE *handles, reused;
+    uint8_t src[5000], dst[5000];
+    size_t i, k;
+    bool rtn = true;
+    
+    for (i = 0; i < sizeof (src); i++)
+        src[i] = (uint8_t) (i * 11);
+    pool = RING_InitPool();
+    handles = malloc(TEST_COMPACT_RINGS * sizeof (RING_HANDLE));
+    rtn &= (pool != NULL && handles != NULL);
+    
+    // Idle rings cost no storage
+    for (i = 0; i < TEST_COMPACT_RINGS; i++) {
+        handles[i] = RING_CreateCompact(pool, 4096);
+        rtn &= (handles[i] != RING_COMPACT_INVALID);
+    }
+    rtn &= (RING_GetPoolUsage(pool) == 0);
+    
+    // The block follows the bytes in flight, across the wrap and while growing
+    for (k = 0; k < 50; k++) {
+        rtn &= (RING_AddCompactBuffer(pool, handles[k], src, 40) == 40);
+        rtn &= (RING_GetPoolUsage(pool) == (k + 1) * RING_COMPACT_MIN_BLOCK);
+    }
+    rtn &= (RING_GetCompactBuffer(pool, handles[7], dst, 30) == 30);
+    rtn &= (RING_AddCompactBuffer(pool, handles[7], &src[40], 50) == 50);
+    rtn &= (RING_GetPoolUsage(pool) == 50 * RING_COMPACT_MIN_BLOCK);
+    rtn &= (RING_AddCompactBuffer(pool, handles[7], &src[90], 4100) == 4096 - 60);
+    rtn &= (RING_GetCompactFreeSpace(pool, handles[7]) == 0);
+    rtn &= (RING_GetCompactBuffer(pool, handles[7], &dst[30], sizeof (dst)) == 4096);
+    rtn &= (memcmp(dst, src, 4126) == 0);
+    rtn &= (RING_GetCompactFullSpace(pool, handles[7]) == 0);
+    rtn &= (RING_GetPoolUsage(pool) == 49 * RING_COMPACT_MIN_BLOCK);
+    
+    // Drained and destroyed rings give everything back
+    for (k = 0; k < 50; k++)
+        RING_GetCompactBuffer(pool, handles[k], dst, sizeof (dst));
+    rtn &= (RING_GetPoolUsage(pool) == 0);
+    RING_AddCompactBuffer(pool, handles[3], src, 100);
+    rtn &= RING_DestroyCompact(pool, handles[3]);
+    rtn &= (RING_GetPoolUsage(pool) == 0);
+    
+    // Destroyed and never created handles are rejected
+    rtn &= !RING_DestroyCompact(pool, handles[3]);
+    rtn &= !RING_DestroyCompact(pool, RING_COMPACT_INVALID);
+    rtn &= !RING_DestroyCompact(pool, TEST_COMPACT_RINGS + 1);
+    rtn &= (RING_AddCompactBuffer(pool, handles[3], src, 10) == 0);
+    rtn &= (RING_GetCompactFreeSpace(pool, handles[3]) == 0);
+    rtn &= (RING_GetPoolUsage(pool) == 0);
+    reused = RING_CreateCompact(pool, 16);
+    rtn &= (reused == handles[3] && RING_GetCompactFreeSpace(pool, reused) == 16);
+    
+    free(handles);
+    RING_DeinitializePool(pool);
+    
+    return rtn;
+}
@@ -0,0 +1,53 @@
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+ 
+ @File Name
+ TestCompact.h
+ 
+ @Author
+ Luca Pascarella https://lucapascarella.com
+ 
+ @Summary
+ This file tests the RingCompact library
+ 
+ @Description
+ This file collects the tests of the compact rings.
+ 
+ @License
+ Copyright (C) 2016 LP Systems
+ 
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+ 
+ https://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+#ifndef TestCompact_h
+#define TestCompact_h
+
+
+/* Provide C++ Compatibility */
+#ifdef __cplusplus
+extern "C" {
+#endif
+    
+#include <stdbool.h>
+#include <stdint.h>
+#include "RingCompact.h"
+#include "string.h"
+    
+    
+    bool Test_CompactLazyStorage(void);
+    
+    
+    /* Provide C++ Compatibility */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TestCompact_h */
@@ -0,0 +1,111 @@
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+ 
+ @File Name
+ TestCoro.cpp
+ 
+ @Author
+ Luca Pascarella https://lucapascarella.com
+ 
+ @Summary
+ This file tests the RingCoro library
+ 
+ @Description
+ This file collects the tests of the coroutine awaitables.
+ 
+ @License
+ Copyright (C) 2016 LP Systems
+ 
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+ 
+ https://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+// The standard headers come last, RingCoro.hpp must not leak the min() macro
+#include "RingCoro.hpp"
+#include "TestCoro.h"
+#include <algorithm>
+
+namespace {
+
+    // Reads the whole stream in chunks of 10 bytes
+
+    ring::Task consumer(ring::AsyncRing &async, std::uint8_t *dst, std::size_t size, bool &done) {
+        std::size_t i, n;
+
+        for (i = 0; i < size; i += n) {
+            n = std::min<std::size_t>(10, size - i);
+            if (co_await async.read(std::span<std::uint8_t>(dst + i, n)) != n)
+                co_return;
+        }
+        done = true;
+    }
+
+    // Writes the whole stream in chunks of 8 bytes
+
+    ring::Task producer(ring::AsyncRing &async, const std::uint8_t *src, std::size_t size, bool &done) {
+        std::size_t i, n;
+
+        for (i = 0; i < size; i += n) {
+            n = std::min<std::size_t>(8, size - i);
+            if (co_await async.write(std::span<const std::uint8_t>(src + i, n)) != n)
+                co_return;
+        }
+        done = true;
+    }
+}
+
+bool Test_CoroSuspendResume(void) {
+    RING_DATA *ring;
+    ring::Executor executor;
+    std::uint8_t src[100], dst[100];
+    std::size_t i, resumed;
+    bool consumed, produced, rtn = true;
+
+    for (i = 0; i < sizeof (src); i++)
+        src[i] = (std::uint8_t) (i * 7 + 1);
+    memset(dst, 0, sizeof (dst));
+    consumed = produced = false;
+
+    // 15 bytes of room, both sides must suspend several times
+    ring = RING_InitBuffer(NULL, 16);
+    {
+        ring::AsyncRing async(ring, executor);
+
+        // The consumer finds the ring empty and suspends
+        consumer(async, dst, sizeof (dst), consumed);
+        rtn &= (!consumed && RING_GetFullSpace(ring) == 0);
+
+        // The producer fills the ring and suspends as well
+        producer(async, src, sizeof (src), produced);
+        rtn &= (!consumed && !produced);
+
+        // Each resumption lets the peer move more bytes
+        resumed = 0;
+        while (executor.runOne())
+            resumed++;
+        rtn &= (consumed && produced && resumed >= 2);
+        rtn &= (memcmp(src, dst, sizeof (src)) == 0);
+        rtn &= (RING_GetFullSpace(ring) == 0);
+
+        // A read waiting on the C interface is woken by notify()
+        consumed = false;
+        consumer(async, dst, 10, consumed);
+        rtn &= (!consumed);
+        RING_AddBuffer(ring, src, 10);
+        async.notify();
+        rtn &= (!consumed);
+        executor.run();
+        rtn &= (consumed && memcmp(src, dst, 10) == 0);
+    }
+    RING_DeinitializeBuffer(ring);
+
+    return rtn;
+}
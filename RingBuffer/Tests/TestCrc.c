@@ -0,0 +1,92 @@
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+ 
+ @File Name
+ TestCrc.c
+ 
+ @Author
+ Luca Pascarella https://lucapascarella.com
+ 
+ @Summary
+ This file tests the RingCrc library
+ 
+ @Description
+ This file collects the tests of the CRC32C checksums.
+ 
+ @License
+ Copyright (C) 2016 LP Systems
+ 
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+ 
+ https://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+#include "TestCrc.h"
+
+bool Test_Crc32c(void) {
+    RING_DATA *ring;
+    RING_CRC *running;
+    uint8_t check[] = "123456789";
+    uint32_t crc;
+    bool rtn = true;
+    
+    rtn &= (RING_Crc32c(0, check, 9) == 0xE3069283);
+    rtn &= (RING_Crc32c(RING_Crc32c(0, check, 4), &check[4], 5) == 0xE3069283);
+    
+    // Range across the wrap
+    ring = RING_InitBuffer(NULL, 16);
+    rtn &= (ring != NULL);
+    RING_IncreaseHead(ring, 11);
+    RING_IncreaseTail(ring, 11);
+    running = RING_InitCrc(ring);
+    rtn &= (running != NULL);
+    
+    rtn &= (RING_AddBuffer(ring, (uint8_t*) "xx", 2) == 2);
+    rtn &= (RING_AddBuffer(ring, check, 9) == 9);
+    crc = 0;
+    rtn &= RING_GetCrc32c(ring, 2, 9, &crc);
+    rtn &= (crc == 0xE3069283);
+    crc = 0;
+    rtn &= !RING_GetCrc32c(ring, 3, 9, &crc);
+    
+    // Running checksum follows the head
+    rtn &= (RING_GetRunningCrc(running) == RING_Crc32c(RING_Crc32c(0, (uint8_t*) "xx", 2), check, 9));
+    RING_ResetRunningCrc(running);
+    rtn &= (RING_AddBuffer(ring, check, 4) == 4);
+    rtn &= (RING_GetRunningCrc(running) == RING_Crc32c(0, check, 4));
+    
+    RING_DeinitializeCrc(running);
+    RING_DeinitializeBuffer(ring);
+    
+    return rtn;
+}
+
+bool Test_Crc32cSoftware(void) {
+    uint8_t check[] = "123456789", buf[300];
+    size_t i, k, offset, len;
+    uint32_t crc;
+    bool rtn = true;
+
+    rtn &= (RING_Crc32cSoftware(0, check, 9) == 0xE3069283);
+    rtn &= (RING_Crc32cSoftware(RING_Crc32cSoftware(0, check, 4), &check[4], 5) == 0xE3069283);
+
+    // Both implementations agree on any length and alignment, chained or not
+    for (i = 0; i < sizeof (buf); i++)
+        buf[i] = (uint8_t) rand();
+    for (k = 0; k < 1000; k++) {
+        offset = (size_t) rand() % 8;
+        len = (size_t) rand() % (sizeof (buf) - offset);
+        crc = (uint32_t) rand();
+        rtn &= (RING_Crc32cSoftware(crc, &buf[offset], len) == RING_Crc32c(crc, &buf[offset], len));
+    }
+    rtn &= (RING_Crc32cSoftware(0, buf, 0) == 0);
+
+    return rtn;
+}
@@ -0,0 +1,106 @@
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+ 
+ @File Name
+ TestCursor.c
+ 
+ @Author
+ Luca Pascarella https://lucapascarella.com
+ 
+ @Summary
+ This file tests the RingCursor library
+ 
+ @Description
+ This file collects the tests of the binary decode cursor.
+ 
+ @License
+ Copyright (C) 2016 LP Systems
+ 
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+ 
+ https://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+#include "TestCursor.h"
+
+bool Test_CursorDecodeCommit(void) {
+    RING_DATA *ring;
+    RING_CURSOR cursor;
+    uint8_t frame[] = {
+        0x7E, 0x34, 0x12, 0x12, 0x34, 0x78, 0x56, 0x34, 0x12, 0x12, 0x34, 0x56, 0x78,
+        0x08, 0x07, 0x06, 0x05, 0x04, 0x03, 0x02, 0x01, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08,
+        0xE5, 0x8E, 0x26, 0x7F, 'a', 'b', 'c'
+    };
+    uint8_t bytes[3];
+    size_t start;
+    bool rtn = true;
+    
+    ring = RING_InitBuffer(NULL, 64);
+    rtn &= (ring != NULL);
+    
+    // Every start position, so that each field straddles the wrap once
+    for (start = 0; start < 64; start++) {
+        ring->head = ring->tail = start;
+        rtn &= (RING_AddBuffer(ring, frame, 20) == 20);
+        
+        // Truncated frame, nothing is consumed
+        rtn &= !RING_OpenCursor(&cursor, ring, sizeof (frame));
+        rtn &= RING_OpenCursor(&cursor, ring, 0);
+        rtn &= (RING_CursorU8(&cursor) == 0x7E);
+        RING_CursorU16LE(&cursor);
+        RING_CursorU16BE(&cursor);
+        RING_CursorU32LE(&cursor);
+        RING_CursorU32BE(&cursor);
+        rtn &= (RING_CursorU64LE(&cursor) == 0);
+        rtn &= !RING_IsCursorValid(&cursor);
+        rtn &= !RING_CommitCursor(&cursor);
+        rtn &= (RING_GetFullSpace(ring) == 20);
+        RING_AbandonCursor(&cursor);
+        
+        // Whole frame
+        rtn &= (RING_AddBuffer(ring, &frame[20], sizeof (frame) - 20) == sizeof (frame) - 20);
+        rtn &= (RING_AddBuffer(ring, (uint8_t*) "next", 4) == 4);
+        rtn &= RING_OpenCursor(&cursor, ring, sizeof (frame));
+        rtn &= (RING_CursorU8(&cursor) == 0x7E);
+        rtn &= (RING_CursorU16LE(&cursor) == 0x1234);
+        rtn &= (RING_CursorU16BE(&cursor) == 0x1234);
+        rtn &= (RING_CursorU32LE(&cursor) == 0x12345678);
+        rtn &= (RING_CursorU32BE(&cursor) == 0x12345678);
+        rtn &= (RING_CursorU64LE(&cursor) == 0x0102030405060708ull);
+        rtn &= (RING_CursorU64BE(&cursor) == 0x0102030405060708ull);
+        rtn &= (RING_CursorVarint(&cursor) == 624485);
+        rtn &= (RING_CursorVarint(&cursor) == 127);
+        rtn &= (RING_GetCursorRemaining(&cursor) == 3);
+        rtn &= RING_CursorBytes(&cursor, bytes, 3);
+        rtn &= (memcmp(bytes, "abc", 3) == 0);
+        rtn &= !RING_CursorBytes(&cursor, NULL, 1);
+        rtn &= !RING_CommitCursor(&cursor);
+        
+        RING_AbandonCursor(&cursor);
+        rtn &= RING_CursorBytes(&cursor, NULL, sizeof (frame) - 3);
+        rtn &= RING_CursorBytes(&cursor, bytes, 3);
+        rtn &= (RING_IsCursorValid(&cursor) && RING_CommitCursor(&cursor));
+        rtn &= (RING_GetFullSpace(ring) == 4);
+        rtn &= (RING_GetBuffer(ring, bytes, 3) == 3 && memcmp(bytes, "nex", 3) == 0);
+        
+        // Unterminated varint
+        rtn &= RING_OpenCursor(&cursor, ring, 0);
+        rtn &= (RING_CursorVarint(&cursor) == 't');
+        rtn &= RING_CommitCursor(&cursor);
+        RING_AddBuffer(ring, (uint8_t*) "\xFF\xFF", 2);
+        rtn &= RING_OpenCursor(&cursor, ring, 0);
+        RING_CursorVarint(&cursor);
+        rtn &= !RING_IsCursorValid(&cursor);
+    }
+    
+    RING_DeinitializeBuffer(ring);
+    
+    return rtn;
+}
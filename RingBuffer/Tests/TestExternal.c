@@ -0,0 +1,126 @@
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+ 
+ @File Name
+ TestExternal.c
+ 
+ @Author
+ Luca Pascarella https://lucapascarella.com
+ 
+ @Summary
+ This file tests the RingExternal library
+ 
+ @Description
+ This file collects the tests of the externally filled rings.
+ 
+ @License
+ Copyright (C) 2016 LP Systems
+ 
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+ 
+ https://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+#include "TestExternal.h"
+
+typedef struct {
+    uint8_t mem[128]; // Memory shared with the consumer
+    uint32_t counter32; // Free running counters
+    uint64_t counter64;
+    uint32_t index; // Cycling DMA write index
+} TEST_EXTERNAL_PRODUCER;
+
+// Writes len bytes of the sequence, lapping the consumer if needed
+
+static void Test_ExternalProduce(TEST_EXTERNAL_PRODUCER *producer, size_t len) {
+    while (len--) {
+        producer->mem[producer->index] = (uint8_t) producer->counter64;
+        producer->index = (producer->index + 1) % sizeof (producer->mem);
+        producer->counter32++;
+        producer->counter64++;
+    }
+}
+
+// Consumes the filled space in place, checking the sequence
+
+static bool Test_ExternalConsume(RING_EXTERNAL *external, uint8_t *next, size_t *count) {
+    RING_DATA *ring = external->ring;
+    size_t i, chunk;
+    bool rtn = true;
+
+    *count = 0;
+    while ((chunk = RING_GetFullLinearSpace(ring)) > 0) {
+        for (i = 0; i < chunk; i++)
+            rtn &= (RING_GetTailPointer(ring)[i] == (*next)++);
+        RING_IncreaseTail(ring, chunk);
+        *count += chunk;
+    }
+    return rtn;
+}
+
+bool Test_ExternalCounterOverrun(void) {
+    TEST_EXTERNAL_PRODUCER producer;
+    RING_EXTERNAL *e32, *e64, *eindex;
+    uint8_t next32, next64, nextindex;
+    size_t count;
+    bool rtn = true;
+
+    // Every position refers to offset 64, the 32 bits counter wraps during the test
+    producer.counter32 = 0xFFFFFFC0u;
+    producer.counter64 = 64;
+    producer.index = 64;
+    Test_ExternalProduce(&producer, 30);
+
+    rtn &= (RING_InitExternal(producer.mem, 100, &producer.counter32, RING_EXTERNAL_COUNTER32) == NULL);
+
+    e32 = RING_InitExternal(producer.mem, sizeof (producer.mem), &producer.counter32, RING_EXTERNAL_COUNTER32);
+    e64 = RING_InitExternal(producer.mem, sizeof (producer.mem), &producer.counter64, RING_EXTERNAL_COUNTER64);
+    eindex = RING_InitExternal(producer.mem, sizeof (producer.mem), &producer.index, RING_EXTERNAL_INDEX32);
+
+    // A 64 bits counter is rejected where it cannot be read in one access
+    if (sizeof (void*) < sizeof (uint64_t)) {
+        rtn &= (e64 == NULL);
+        RING_DeinitializeExternal(eindex);
+        RING_DeinitializeExternal(e32);
+        return rtn;
+    }
+    rtn &= (e32 != NULL && e64 != NULL && eindex != NULL);
+    rtn &= (RING_GetFullSpace(e32->ring) == 0 && RING_GetFullSpace(eindex->ring) == 0);
+    next32 = next64 = nextindex = 94;
+
+    // In step, every mode reads in place across the end of the memory
+    Test_ExternalProduce(&producer, 90);
+    rtn &= (RING_SyncExternal(e32) == 0 && RING_SyncExternal(e64) == 0 && RING_SyncExternal(eindex) == 0);
+    rtn &= (Test_ExternalConsume(e32, &next32, &count) && count == 90);
+    rtn &= (Test_ExternalConsume(e64, &next64, &count) && count == 90);
+    rtn &= (Test_ExternalConsume(eindex, &nextindex, &count) && count == 90);
+
+    // The producer laps the consumer, the counters report the loss
+    Test_ExternalProduce(&producer, 250);
+    rtn &= (RING_SyncExternal(e32) == 123 && RING_SyncExternal(e64) == 123);
+    rtn &= (RING_GetExternalLost(e32) == 123 && RING_GetExternalLost(e64) == 123);
+    next32 = next64 = (uint8_t) (next32 + 123);
+    rtn &= RING_IsExternalIntact(e64);
+    rtn &= (Test_ExternalConsume(e32, &next32, &count) && count == 127);
+    rtn &= (Test_ExternalConsume(e64, &next64, &count) && count == 127);
+
+    // Overwritten while being read
+    Test_ExternalProduce(&producer, 20);
+    rtn &= (RING_SyncExternal(e64) == 0 && RING_IsExternalIntact(e64));
+    Test_ExternalProduce(&producer, 109);
+    rtn &= !RING_IsExternalIntact(e64);
+    rtn &= (RING_SyncExternal(e64) == 2 && RING_GetExternalLost(e64) == 125);
+
+    RING_DeinitializeExternal(eindex);
+    RING_DeinitializeExternal(e64);
+    RING_DeinitializeExternal(e32);
+
+    return rtn;
+}
@@ -0,0 +1,169 @@
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+ 
+ @File Name
+ TestFanIn.c
+ 
+ @Author
+ Luca Pascarella https://lucapascarella.com
+ 
+ @Summary
+ This file tests the RingFanIn library
+ 
+ @Description
+ This file collects the tests of the multi-producer fan-in.
+ 
+ @License
+ Copyright (C) 2016 LP Systems
+ 
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+ 
+ https://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+#include "TestFanIn.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <pthread.h>
+#include <sched.h>
+#define TEST_FANIN_THREADS
+#endif
+
+typedef struct {
+    uint8_t buf[32];
+    size_t len;
+} TEST_FANIN_SINK;
+
+static void Test_FanInSink(void *ctx, size_t producer, const uint8_t *buf, size_t len) {
+    TEST_FANIN_SINK *sink = ctx;
+    
+    (void) producer;
+    memcpy(&sink->buf[sink->len], buf, len);
+    sink->len += len;
+}
+
+bool Test_FanInRoundRobin(void) {
+    RING_FANIN *fanin;
+    TEST_FANIN_SINK sink;
+    bool rtn = true;
+    
+    fanin = RING_InitFanIn(70, 16, 2);
+    rtn &= (fanin != NULL);
+    rtn &= !RING_IsFanInPending(fanin);
+    
+    rtn &= (RING_AddFanInBuffer(fanin, 1, (uint8_t*) "aaaa", 4) == 4);
+    rtn &= (RING_AddFanInBuffer(fanin, 5, (uint8_t*) "bb", 2) == 2);
+    rtn &= (RING_AddFanInBuffer(fanin, 66, (uint8_t*) "ccc", 3) == 3);
+    rtn &= RING_IsFanInPending(fanin);
+    
+    // Each pass serves two bytes of every pending ring
+    sink.len = 0;
+    rtn &= (RING_DrainFanIn(fanin, Test_FanInSink, &sink) == 6);
+    rtn &= (sink.len == 6 && memcmp(sink.buf, "aabbcc", 6) == 0);
+    rtn &= RING_IsFanInPending(fanin);
+    
+    sink.len = 0;
+    rtn &= (RING_DrainFanIn(fanin, Test_FanInSink, &sink) == 3);
+    rtn &= (sink.len == 3 && memcmp(sink.buf, "aac", 3) == 0);
+    rtn &= !RING_IsFanInPending(fanin);
+    
+    RING_DeinitializeFanIn(fanin);
+    
+    return rtn;
+}
+
+#ifdef TEST_FANIN_THREADS
+
+#define TEST_FANIN_PRODUCERS    4
+#define TEST_FANIN_BYTES        20000
+
+typedef struct {
+    RING_FANIN *fanin;
+    size_t producer; // Producer index used by the thread
+} TEST_FANIN_PRODUCER;
+
+typedef struct {
+    size_t bytes[TEST_FANIN_PRODUCERS]; // Bytes received from each producer
+    uint8_t next[TEST_FANIN_PRODUCERS]; // Expected value of the next byte of each producer
+    bool order; // It is false if a byte is out of order
+} TEST_FANIN_STREAMS;
+
+static void Test_FanInStreamSink(void *ctx, size_t producer, const uint8_t *buf, size_t len) {
+    TEST_FANIN_STREAMS *streams = ctx;
+    size_t i;
+
+    for (i = 0; i < len; i++)
+        streams->order &= (buf[i] == streams->next[producer]++);
+    streams->bytes[producer] += len;
+}
+
+// Writes an increasing byte sequence, retrying what does not fit
+
+static void * Test_FanInProducer(void *arg) {
+    TEST_FANIN_PRODUCER *producer = arg;
+    uint8_t chunk[23];
+    uint8_t val = 0;
+    size_t i, sent, added;
+
+    for (sent = 0; sent < TEST_FANIN_BYTES; sent += added) {
+        for (i = 0; i < sizeof (chunk); i++)
+            chunk[i] = (uint8_t) (val + i);
+        added = RING_AddFanInBuffer(producer->fanin, producer->producer, chunk, min(sizeof (chunk), TEST_FANIN_BYTES - sent));
+        val = (uint8_t) (val + added);
+        if (added == 0)
+            sched_yield();
+    }
+    return NULL;
+}
+
+bool Test_FanInThreadedProducers(void) {
+    TEST_FANIN_STREAMS streams = {{0}, {0}, true};
+    TEST_FANIN_PRODUCER producers[TEST_FANIN_PRODUCERS];
+    pthread_t threads[TEST_FANIN_PRODUCERS];
+    RING_FANIN *fanin;
+    size_t i, total;
+    bool rtn = true;
+
+    if ((fanin = RING_InitFanIn(TEST_FANIN_PRODUCERS, 256, 32)) == NULL)
+        return false;
+
+    // One thread for each producer, the calling thread is the consumer
+    for (i = 0; i < TEST_FANIN_PRODUCERS; i++) {
+        producers[i].fanin = fanin;
+        producers[i].producer = i;
+        pthread_create(&threads[i], NULL, Test_FanInProducer, &producers[i]);
+    }
+    total = 0;
+    while (total < TEST_FANIN_PRODUCERS * TEST_FANIN_BYTES) {
+        if (RING_IsFanInPending(fanin))
+            total += RING_DrainFanIn(fanin, Test_FanInStreamSink, &streams);
+        else
+            sched_yield();
+    }
+    for (i = 0; i < TEST_FANIN_PRODUCERS; i++)
+        pthread_join(threads[i], NULL);
+
+    for (i = 0; i < TEST_FANIN_PRODUCERS; i++)
+        rtn &= (streams.bytes[i] == TEST_FANIN_BYTES);
+    rtn &= streams.order;
+    rtn &= !RING_IsFanInPending(fanin);
+
+    RING_DeinitializeFanIn(fanin);
+
+    return rtn;
+}
+
+#else
+
+bool Test_FanInThreadedProducers(void) {
+    return true;
+}
+
+#endif
@@ -0,0 +1,115 @@
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+ 
+ @File Name
+ TestFraming.c
+ 
+ @Author
+ Luca Pascarella https://lucapascarella.com
+ 
+ @Summary
+ This file tests the RingFraming library
+ 
+ @Description
+ This file collects the tests of the SLIP and COBS framing.
+ 
+ @License
+ Copyright (C) 2016 LP Systems
+ 
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+ 
+ https://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+#include "TestFraming.h"
+
+static bool Test_FramingRoundTrip(RING_FRAMING_TYPE type) {
+    RING_FRAMING *framing;
+    RING_DATA *link, *msg;
+    uint8_t frame[600], out[600];
+    size_t i, n, len, sent, received;
+    bool rtn = true;
+    
+    framing = RING_InitFraming(type, sizeof (frame));
+    link = RING_InitBuffer(NULL, 2048);
+    msg = RING_InitBuffer(NULL, 2048);
+    rtn &= (framing != NULL && link != NULL && msg != NULL);
+    
+    // Frames full of delimiters and escapes, long zero free runs, across the wrap
+    sent = received = 0;
+    for (n = 0; n < 40; n++) {
+        len = 1 + (n * 37) % (sizeof (frame) - 1);
+        for (i = 0; i < len; i++)
+            frame[i] = (n & 1) ? (uint8_t) (i * 7 + n) : (uint8_t) (0xC0 + i % 3 * 0x1B) | (uint8_t) (i % 300 == 0 ? 0 : 1);
+        rtn &= RING_EncodeFrame(framing, link, frame, len);
+        sent++;
+        received += RING_DecodeFrames(framing, msg, link);
+        rtn &= RING_GetFrame(msg, out, sizeof (out), &i);
+        rtn &= (i == len && memcmp(out, frame, len) == 0);
+    }
+    rtn &= (received == sent);
+    rtn &= (RING_GetFullSpace(link) == 0 && RING_GetFullSpace(msg) == 0);
+    rtn &= (framing->errors == 0);
+    
+    RING_DeinitializeBuffer(msg);
+    RING_DeinitializeBuffer(link);
+    RING_DeinitializeFraming(framing);
+    
+    return rtn;
+}
+
+bool Test_FramingSlipCobs(void) {
+    RING_FRAMING *framing;
+    RING_DATA *link, *msg;
+    uint8_t out[16];
+    size_t len;
+    bool rtn = true;
+    
+    rtn &= Test_FramingRoundTrip(RING_FRAMING_SLIP);
+    rtn &= Test_FramingRoundTrip(RING_FRAMING_COBS);
+    
+    // Known encodings
+    framing = RING_InitFraming(RING_FRAMING_COBS, 8);
+    link = RING_InitBuffer(NULL, 64);
+    msg = RING_InitBuffer(NULL, 64);
+    rtn &= RING_EncodeFrame(framing, link, (uint8_t*) "\x11\x00\x00\x22", 4);
+    rtn &= (RING_PickBytes(link, out, 16) == 6 && memcmp(out, "\x02\x11\x01\x02\x22\x00", 6) == 0);
+    rtn &= (RING_DecodeFrames(framing, msg, link) == 1);
+    rtn &= RING_GetFrame(msg, out, sizeof (out), &len);
+    rtn &= (len == 4 && memcmp(out, "\x11\x00\x00\x22", 4) == 0);
+    
+    // Truncated block and oversized frame are dropped, the next frame survives
+    RING_AddBuffer(link, (uint8_t*) "\x05\x11\x00", 3);
+    RING_AddBuffer(link, (uint8_t*) "\x0A\x01\x02\x03\x04\x05\x06\x07\x08\x09\x00", 11);
+    RING_AddBuffer(link, (uint8_t*) "\x02\x33", 2);
+    rtn &= (RING_DecodeFrames(framing, msg, link) == 0);
+    RING_AddBuffer(link, (uint8_t*) "\x00", 1);
+    rtn &= (RING_DecodeFrames(framing, msg, link) == 1);
+    rtn &= (framing->errors == 2);
+    rtn &= RING_GetFrame(msg, out, sizeof (out), &len);
+    rtn &= (len == 1 && out[0] == 0x33);
+    rtn &= !RING_GetFrame(msg, out, sizeof (out), &len);
+    RING_DeinitializeFraming(framing);
+    
+    framing = RING_InitFraming(RING_FRAMING_SLIP, 8);
+    rtn &= RING_EncodeFrame(framing, link, (uint8_t*) "\xC0\x01\xDB", 3);
+    rtn &= (RING_PickBytes(link, out, 16) == 6 && memcmp(out, "\xDB\xDC\x01\xDB\xDD\xC0", 6) == 0);
+    RING_AddBuffer(link, (uint8_t*) "\xDB\x01\xC0", 3);
+    rtn &= (RING_DecodeFrames(framing, msg, link) == 1);
+    rtn &= (framing->errors == 1);
+    rtn &= RING_GetFrame(msg, out, sizeof (out), &len);
+    rtn &= (len == 3 && memcmp(out, "\xC0\x01\xDB", 3) == 0);
+    
+    RING_DeinitializeFraming(framing);
+    RING_DeinitializeBuffer(msg);
+    RING_DeinitializeBuffer(link);
+    
+    return rtn;
+}
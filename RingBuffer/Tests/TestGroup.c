@@ -0,0 +1,183 @@
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+ 
+ @File Name
+ TestGroup.c
+ 
+ @Author
+ Luca Pascarella https://lucapascarella.com
+ 
+ @Summary
+ This file tests the RingGroup library
+ 
+ @Description
+ This file collects the tests of the sharded ring group.
+ 
+ @License
+ Copyright (C) 2016 LP Systems
+ 
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+ 
+ https://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+#include "TestGroup.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#define TEST_GROUP_THREADS
+#endif
+
+bool Test_GroupLocalAndSteal(void) {
+    RING_GROUP *group;
+    char buf[] = "0123456789";
+    uint8_t dst[16];
+    size_t got;
+    bool rtn = true;
+    
+    group = RING_InitGroup(4, 32, 4);
+    rtn &= (group != NULL);
+    rtn &= RING_IsGroupEmpty(group);
+    
+    // Producer on shard 2
+    rtn &= (RING_AddGroupBuffer(group, 2, (uint8_t*) buf, 10) == 10);
+    rtn &= (RING_GetGroupFullSpace(group) == 10);
+    rtn &= !RING_IsGroupEmpty(group);
+    
+    // Consumer on shard 0 steals a single batch
+    got = RING_GetGroupBuffer(group, 0, dst, sizeof (dst));
+    rtn &= (got == 4);
+    rtn &= (memcmp(dst, "0123", 4) == 0);
+    
+    // Consumer on shard 2 drains its local shard
+    got = RING_GetGroupBuffer(group, 2, dst, sizeof (dst));
+    rtn &= (got == 6);
+    rtn &= (memcmp(dst, "456789", 6) == 0);
+    rtn &= RING_IsGroupEmpty(group);
+    rtn &= (RING_GetGroupBuffer(group, 1, dst, sizeof (dst)) == 0);
+    
+    RING_DeinitializeGroup(group);
+    
+    return rtn;
+}
+
+#ifdef TEST_GROUP_THREADS
+
+#define TEST_GROUP_SHARDS       4
+#define TEST_GROUP_PRODUCERS    2
+#define TEST_GROUP_BYTES        20000
+
+typedef struct {
+    RING_GROUP *group;
+    pthread_mutex_t locks[TEST_GROUP_SHARDS]; // One lock for each shard
+    atomic_size_t consumed; // Bytes got by all the consumers
+    atomic_size_t sums[TEST_GROUP_PRODUCERS]; // Sum of the bytes got from each producer
+} TEST_GROUP_SHARED;
+
+typedef struct {
+    TEST_GROUP_SHARED *shared;
+    size_t shard;
+} TEST_GROUP_WORKER;
+
+static void Test_GroupLock(void *ctx, size_t shard) {
+    pthread_mutex_lock(&((TEST_GROUP_SHARED*) ctx)->locks[shard]);
+}
+
+static void Test_GroupUnlock(void *ctx, size_t shard) {
+    pthread_mutex_unlock(&((TEST_GROUP_SHARED*) ctx)->locks[shard]);
+}
+
+// The lowest bit of each byte tells the producer, the local shard index
+
+static void * Test_GroupProducer(void *arg) {
+    TEST_GROUP_WORKER *worker = arg;
+    uint8_t buf[7];
+    size_t i, sent, added;
+
+    for (sent = 0; sent < TEST_GROUP_BYTES; sent += added) {
+        for (i = 0; i < sizeof (buf); i++)
+            buf[i] = (uint8_t) (((sent + i) << 1) | worker->shard);
+        added = RING_AddGroupBuffer(worker->shared->group, worker->shard, buf, min(sizeof (buf), TEST_GROUP_BYTES - sent));
+        if (added == 0)
+            sched_yield();
+    }
+    return NULL;
+}
+
+// The local shard of a consumer stays empty, every byte is stolen
+
+static void * Test_GroupConsumer(void *arg) {
+    TEST_GROUP_WORKER *worker = arg;
+    TEST_GROUP_SHARED *shared = worker->shared;
+    uint8_t buf[16];
+    size_t i, got;
+
+    while (atomic_load(&shared->consumed) < TEST_GROUP_PRODUCERS * TEST_GROUP_BYTES) {
+        got = RING_GetGroupBuffer(shared->group, worker->shard, buf, sizeof (buf));
+        for (i = 0; i < got; i++)
+            atomic_fetch_add(&shared->sums[buf[i] & 1], buf[i]);
+        atomic_fetch_add(&shared->consumed, got);
+        if (got == 0)
+            sched_yield();
+    }
+    return NULL;
+}
+
+bool Test_GroupThreadedSteal(void) {
+    TEST_GROUP_SHARED shared;
+    TEST_GROUP_WORKER workers[TEST_GROUP_SHARDS];
+    pthread_t threads[TEST_GROUP_SHARDS];
+    size_t i, p, sums[TEST_GROUP_PRODUCERS];
+    bool rtn = true;
+
+    if ((shared.group = RING_InitGroup(TEST_GROUP_SHARDS, 64, 8)) == NULL)
+        return false;
+    for (i = 0; i < TEST_GROUP_SHARDS; i++)
+        pthread_mutex_init(&shared.locks[i], NULL);
+    RING_SetGroupLock(shared.group, Test_GroupLock, Test_GroupUnlock, &shared);
+    atomic_init(&shared.consumed, 0);
+    for (p = 0; p < TEST_GROUP_PRODUCERS; p++) {
+        atomic_init(&shared.sums[p], 0);
+        sums[p] = 0;
+        for (i = 0; i < TEST_GROUP_BYTES; i++)
+            sums[p] += (uint8_t) ((i << 1) | p);
+    }
+
+    // Shards 0 and 1 are written, shards 2 and 3 steal from them
+    for (i = 0; i < TEST_GROUP_SHARDS; i++) {
+        workers[i].shared = &shared;
+        workers[i].shard = i;
+        pthread_create(&threads[i], NULL, (i < TEST_GROUP_PRODUCERS) ? Test_GroupProducer : Test_GroupConsumer, &workers[i]);
+    }
+    for (i = 0; i < TEST_GROUP_SHARDS; i++)
+        pthread_join(threads[i], NULL);
+
+    rtn &= (atomic_load(&shared.consumed) == TEST_GROUP_PRODUCERS * TEST_GROUP_BYTES);
+    for (p = 0; p < TEST_GROUP_PRODUCERS; p++)
+        rtn &= (atomic_load(&shared.sums[p]) == sums[p]);
+    rtn &= RING_IsGroupEmpty(shared.group);
+    rtn &= (RING_GetGroupFullSpace(shared.group) == 0);
+
+    RING_DeinitializeGroup(shared.group);
+    for (i = 0; i < TEST_GROUP_SHARDS; i++)
+        pthread_mutex_destroy(&shared.locks[i]);
+
+    return rtn;
+}
+
+#else
+
+bool Test_GroupThreadedSteal(void) {
+    return true;
+}
+
+#endif
@@ -0,0 +1,186 @@
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+ 
+ @File Name
+ TestLanes.c
+ 
+ @Author
+ Luca Pascarella https://lucapascarella.com
+ 
+ @Summary
+ This file tests the RingLanes library
+ 
+ @Description
+ This file collects the tests of the prioritized lanes.
+ 
+ @License
+ Copyright (C) 2016 LP Systems
+ 
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+ 
+ https://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+#include "TestLanes.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <pthread.h>
+#include <sched.h>
+#define TEST_LANES_THREADS
+#endif
+
+typedef struct {
+    size_t bytes[3]; // Bytes received from each lane
+    uint8_t next[3]; // Expected value of the next byte of each lane
+    bool order; // It is false if a lane byte is out of order
+} TEST_LANES_SINK;
+
+static void Test_LanesSink(void *ctx, size_t lane, const uint8_t *buf, size_t len) {
+    TEST_LANES_SINK *sink = ctx;
+    size_t i;
+
+    for (i = 0; i < len; i++)
+        sink->order &= (buf[i] == sink->next[lane]++);
+    sink->bytes[lane] += len;
+}
+
+static void Test_LanesFill(RING_LANES *lanes, size_t lane, size_t len, uint8_t *val) {
+    uint8_t chunk[256];
+    size_t i;
+
+    for (i = 0; i < len; i++)
+        chunk[i] = (*val)++;
+    RING_AddLaneBuffer(lanes, lane, chunk, len);
+}
+
+bool Test_LanesPriorityWeight(void) {
+    RING_LANE_CONFIG config[3] = {
+        {4096, 0, 300}, // Bulk
+        {4096, 0, 100}, // Bulk with a third of the share
+        {256, 1, 1}, // Control
+    };
+    TEST_LANES_SINK sink = {{0}, {0}, true};
+    RING_LANES *lanes;
+    uint8_t val[3] = {0};
+    size_t i;
+    bool rtn = true;
+
+    lanes = RING_InitLanes(config, 3);
+    rtn &= (lanes != NULL);
+    rtn &= !RING_IsLanesPending(lanes);
+
+    for (i = 0; i < 12; i++) {
+        Test_LanesFill(lanes, 0, 250, &val[0]);
+        Test_LanesFill(lanes, 1, 250, &val[1]);
+    }
+    Test_LanesFill(lanes, 2, 10, &val[2]);
+    rtn &= RING_IsLanesPending(lanes);
+
+    // Control bypasses the bulk backlog
+    rtn &= (RING_DrainLanes(lanes, 10, Test_LanesSink, &sink) == 10);
+    rtn &= (sink.bytes[2] == 10 && sink.bytes[0] == 0 && sink.bytes[1] == 0);
+
+    // Bulk lanes share by weight
+    rtn &= (RING_DrainLanes(lanes, 800, Test_LanesSink, &sink) == 800);
+    rtn &= (sink.bytes[0] == 600 && sink.bytes[1] == 200);
+
+    // New control data preempts at the next lane turn
+    Test_LanesFill(lanes, 2, 5, &val[2]);
+    rtn &= (RING_DrainLanes(lanes, 5, Test_LanesSink, &sink) == 5);
+    rtn &= (sink.bytes[2] == 15);
+
+    // Once lane 0 is empty lane 1 takes all the budget
+    while (RING_DrainLanes(lanes, 123, Test_LanesSink, &sink) > 0)
+        ;
+    rtn &= (sink.bytes[0] == 3000 && sink.bytes[1] == 3000 && sink.order);
+    rtn &= !RING_IsLanesPending(lanes);
+
+    RING_DeinitializeLanes(lanes);
+
+    return rtn;
+}
+
+#ifdef TEST_LANES_THREADS
+
+#define TEST_LANES_BYTES    30000
+
+typedef struct {
+    RING_LANES *lanes;
+    size_t lane; // Lane written by the thread
+} TEST_LANES_PRODUCER;
+
+// Writes an increasing byte sequence, retrying what does not fit
+
+static void * Test_LanesProducer(void *arg) {
+    TEST_LANES_PRODUCER *producer = arg;
+    uint8_t chunk[41];
+    uint8_t val = 0;
+    size_t i, sent, added;
+
+    for (sent = 0; sent < TEST_LANES_BYTES; sent += added) {
+        for (i = 0; i < sizeof (chunk); i++)
+            chunk[i] = (uint8_t) (val + i);
+        added = RING_AddLaneBuffer(producer->lanes, producer->lane, chunk, min(sizeof (chunk), TEST_LANES_BYTES - sent));
+        val = (uint8_t) (val + added);
+        if (added == 0)
+            sched_yield();
+    }
+    return NULL;
+}
+
+bool Test_LanesThreadedProducers(void) {
+    RING_LANE_CONFIG config[3] = {
+        {512, 0, 64},
+        {512, 0, 32},
+        {128, 1, 16},
+    };
+    TEST_LANES_SINK sink = {{0}, {0}, true};
+    TEST_LANES_PRODUCER producers[3];
+    pthread_t threads[3];
+    RING_LANES *lanes;
+    size_t i, total;
+    bool rtn = true;
+
+    if ((lanes = RING_InitLanes(config, 3)) == NULL)
+        return false;
+
+    // One producer thread for each lane, the calling thread drains them all
+    for (i = 0; i < 3; i++) {
+        producers[i].lanes = lanes;
+        producers[i].lane = i;
+        pthread_create(&threads[i], NULL, Test_LanesProducer, &producers[i]);
+    }
+    total = 0;
+    while (total < 3 * TEST_LANES_BYTES) {
+        if (RING_IsLanesPending(lanes))
+            total += RING_DrainLanes(lanes, 100, Test_LanesSink, &sink);
+        else
+            sched_yield();
+    }
+    for (i = 0; i < 3; i++)
+        pthread_join(threads[i], NULL);
+
+    for (i = 0; i < 3; i++)
+        rtn &= (sink.bytes[i] == TEST_LANES_BYTES);
+    rtn &= sink.order;
+    rtn &= !RING_IsLanesPending(lanes);
+
+    RING_DeinitializeLanes(lanes);
+
+    return rtn;
+}
+
+#else
+
+bool Test_LanesThreadedProducers(void) {
+    return true;
+}
+
+#endif
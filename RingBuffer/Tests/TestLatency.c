@@ -0,0 +1,88 @@
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+ 
+ @File Name
+ TestLatency.c
+ 
+ @Author
+ Luca Pascarella https://lucapascarella.com
+ 
+ @Summary
+ This file tests the RingLatency library
+ 
+ @Description
+ This file collects the tests of the latency probe.
+ 
+ @License
+ Copyright (C) 2016 LP Systems
+ 
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+ 
+ https://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+#include "TestLatency.h"
+
+static uint64_t Test_LatencyClock(void *ctx) {
+    return *(uint64_t*) ctx;
+}
+
+bool Test_LatencyPercentiles(void) {
+    RING_DATA *ring;
+    RING_LATENCY *latency;
+    uint8_t buf[16];
+    uint64_t now, p50, p99;
+    size_t i;
+    bool rtn = true;
+
+    ring = RING_InitBuffer(NULL, 64);
+    now = 0;
+    latency = RING_InitLatency(ring, 1, Test_LatencyClock, &now);
+    rtn &= (latency != NULL && RING_GetLatencyPercentile(latency, 50.0) == 0);
+
+    // A sample completes when the last byte of its write is read
+    RING_AddLatencyBuffer(latency, buf, 16);
+    now = 7;
+    rtn &= (RING_GetLatencyBuffer(latency, buf, 15) == 15 && RING_GetLatencyCount(latency) == 0);
+    rtn &= (RING_GetLatencyBuffer(latency, buf, 15) == 1 && RING_GetLatencyCount(latency) == 1);
+    rtn &= (RING_GetLatencyMax(latency) == 7 && RING_GetLatencyPercentile(latency, 50.0) == 7);
+    RING_DeinitializeLatency(latency);
+
+    // Sojourn times of 10, 20, ... 1000
+    latency = RING_InitLatency(ring, 1, Test_LatencyClock, &now);
+    for (i = 1; i <= 100; i++) {
+        now = i * 2000;
+        RING_AddLatencyBuffer(latency, buf, 8);
+        now += i * 10;
+        RING_GetLatencyBuffer(latency, buf, 8);
+    }
+    p50 = RING_GetLatencyPercentile(latency, 50.0);
+    p99 = RING_GetLatencyPercentile(latency, 99.0);
+    rtn &= (RING_GetLatencyCount(latency) == 100 && RING_GetLatencyMax(latency) == 1000);
+    rtn &= (p50 >= 500 && p50 <= 535 && p99 >= 990 && p99 <= 1000);
+    rtn &= (RING_GetLatencyPercentile(latency, 100.0) == 1000);
+    RING_DeinitializeLatency(latency);
+
+    // One write out of 4, samples queue up while the consumer lags
+    latency = RING_InitLatency(ring, 4, Test_LatencyClock, &now);
+    for (i = 0; i < 24; i++) {
+        now = i;
+        RING_AddLatencyBuffer(latency, buf, 2);
+    }
+    now = 100;
+    while (RING_GetLatencyBuffer(latency, buf, 5) > 0)
+        ;
+    rtn &= (RING_GetLatencyCount(latency) == 6 && RING_GetLatencyMax(latency) == 97);
+    RING_DeinitializeLatency(latency);
+
+    RING_DeinitializeBuffer(ring);
+
+    return rtn;
+}
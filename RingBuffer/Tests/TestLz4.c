@@ -0,0 +1,81 @@
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+ 
+ @File Name
+ TestLz4.c
+ 
+ @Author
+ Luca Pascarella https://lucapascarella.com
+ 
+ @Summary
+ This file tests the RingLz4 library
+ 
+ @Description
+ This file collects the tests of the LZ4 compression stage.
+ 
+ @License
+ Copyright (C) 2016 LP Systems
+ 
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+ 
+ https://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+#include "TestLz4.h"
+
+bool Test_Lz4RoundTrip(void) {
+    RING_DATA *raw, *packed, *out;
+    RING_LZ4 *compressor, *decompressor;
+    char line[] = "2016-01-01 INFO request served in 12 ms\n";
+    uint8_t *src, *dst;
+    size_t testSize, i, ia, ig, before, packedSize;
+    bool rtn = true;
+    
+    testSize = 4000;
+    src = malloc(testSize);
+    dst = malloc(testSize);
+    for (i = 0; i < testSize; i++)
+        src[i] = (i % 97 == 0) ? (uint8_t) rand() : (uint8_t) line[i % (sizeof (line) - 1)];
+    
+    // Odd exact sizes force blocks and records across the ends of the buffers
+    raw = RING_InitBufferWithPolicy(NULL, 301, RING_SIZE_EXACT);
+    packed = RING_InitBufferWithPolicy(NULL, 517, RING_SIZE_EXACT);
+    out = RING_InitBufferWithPolicy(NULL, 129, RING_SIZE_EXACT);
+    compressor = RING_InitLz4(100, 1024);
+    decompressor = RING_InitLz4(100, 1024);
+    rtn &= (raw != NULL && packed != NULL && out != NULL);
+    rtn &= (compressor != NULL && decompressor != NULL);
+    
+    ia = ig = packedSize = 0;
+    do {
+        if (ia < testSize)
+            ia += RING_AddBuffer(raw, &src[ia], min(testSize - ia, 61));
+        before = RING_GetFullSpace(packed);
+        RING_CompressLz4(compressor, packed, raw, ia == testSize);
+        packedSize += RING_GetFullSpace(packed) - before;
+        RING_DecompressLz4(decompressor, out, packed);
+        ig += RING_GetBuffer(out, &dst[ig], testSize - ig);
+    } while (ig < testSize && !decompressor->corrupted);
+    
+    rtn &= !decompressor->corrupted;
+    rtn &= (memcmp(src, dst, testSize) == 0);
+    // The repeated log line must shrink, a stored copy would not
+    rtn &= (packedSize < testSize / 3);
+    
+    RING_DeinitializeLz4(compressor);
+    RING_DeinitializeLz4(decompressor);
+    RING_DeinitializeBuffer(raw);
+    RING_DeinitializeBuffer(packed);
+    RING_DeinitializeBuffer(out);
+    free(src);
+    free(dst);
+    
+    return rtn;
+}
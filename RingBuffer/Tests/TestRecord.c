@@ -0,0 +1,105 @@
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+ 
+ @File Name
+ TestRecord.c
+ 
+ @Author
+ Luca Pascarella https://lucapascarella.com
+ 
+ @Summary
+ This file tests the RingRecord library
+ 
+ @Description
+ This file collects the tests of the timestamped records.
+ 
+ @License
+ Copyright (C) 2016 LP Systems
+ 
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+ 
+ https://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+#include "TestRecord.h"
+
+static uint64_t Test_RecordClock(void *ctx) {
+    return *(uint64_t*) ctx;
+}
+
+static bool Test_RecordSpan(const RING_RECORD_SPAN *span, uint8_t val, size_t len) {
+    size_t i, k;
+    bool rtn = true;
+    
+    rtn &= (span->len[0] + span->len[1] == len);
+    for (k = 0; k < 2; k++)
+        for (i = 0; i < span->len[k]; i++)
+            rtn &= (span->data[k][i] == val);
+    return rtn;
+}
+
+bool Test_RecordWindow(void) {
+    RING_DATA *ring;
+    RING_RECORD *record;
+    RING_RECORD_SPAN span;
+    uint8_t payload[64];
+    uint64_t now, position;
+    size_t i, n;
+    bool rtn = true;
+    
+    ring = RING_InitBuffer(NULL, 1024);
+    now = 0;
+    record = RING_InitRecord(ring, 4, Test_RecordClock, &now);
+    rtn &= (record != NULL);
+    
+    // Record i lasts 10 + i % 7 bytes and is stamped at i * 10
+    for (i = 0; i < 40; i++) {
+        memset(payload, (uint8_t) i, sizeof (payload));
+        now = i * 10;
+        rtn &= RING_AddRecord(record, payload, 10 + i % 7);
+    }
+    
+    // A range query walks the records in place
+    position = RING_SeekRecord(record, 105);
+    for (n = 0; RING_GetRecordSpan(record, &position, 200, &span); n++) {
+        rtn &= (span.time == (n + 11) * 10);
+        rtn &= Test_RecordSpan(&span, (uint8_t) (n + 11), 10 + (n + 11) % 7);
+    }
+    rtn &= (n == 9);
+    
+    // Dropping the records before 150 keeps 15 to 39
+    rtn &= (RING_EvictRecords(record, 150) > 0);
+    position = RING_SeekRecord(record, 0);
+    rtn &= (RING_GetRecordSpan(record, &position, ~0ull, &span) && span.time == 150);
+    rtn &= (RING_EvictRecords(record, 150) == 0);
+    
+    // Filling the ring drops the oldest records, the clock going back is ignored
+    for (i = 40; i < 200; i++) {
+        memset(payload, (uint8_t) i, sizeof (payload));
+        now = i == 190 ? 0 : i * 10;
+        rtn &= RING_AddRecord(record, payload, 10 + i % 7);
+    }
+    position = RING_SeekRecord(record, 0);
+    rtn &= RING_GetRecordSpan(record, &position, ~0ull, &span);
+    n = span.time / 10;
+    rtn &= (n > 150 && Test_RecordSpan(&span, (uint8_t) n, 10 + n % 7));
+    for (i = n + 1; RING_GetRecordSpan(record, &position, ~0ull, &span); i++) {
+        rtn &= (span.time == (i == 190 ? 1890 : i * 10));
+        rtn &= Test_RecordSpan(&span, (uint8_t) i, 10 + i % 7);
+    }
+    rtn &= (i == 200);
+    rtn &= (RING_SeekRecord(record, 1995) == position);
+    rtn &= !RING_AddRecord(record, payload, 1024);
+    
+    RING_DeinitializeRecord(record);
+    RING_DeinitializeBuffer(ring);
+    
+    return rtn;
+}
@@ -0,0 +1,84 @@
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+ 
+ @File Name
+ TestReserve.c
+ 
+ @Author
+ Luca Pascarella https://lucapascarella.com
+ 
+ @Summary
+ This file tests the RingReserve library
+ 
+ @Description
+ This file collects the tests of the variable-size record reservations.
+ 
+ @License
+ Copyright (C) 2016 LP Systems
+ 
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+ 
+ https://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+#include "TestReserve.h"
+
+bool Test_ReserveInOrder(void) {
+    RING_RESERVE *ring;
+    uint8_t *a, *b, *c, *rec;
+    size_t len, i;
+    bool rtn = true;
+    
+    ring = RING_InitReserve(NULL, 100);
+    rtn &= (ring != NULL);
+    rtn &= (ring->size == 64);
+    rtn &= (RING_PeekReserved(ring, &len) == NULL);
+    
+    // Out of order commits are read back in reservation order
+    a = RING_ReserveBytes(ring, 5);
+    b = RING_ReserveBytes(ring, 12);
+    c = RING_ReserveBytes(ring, 3);
+    rtn &= (a != NULL && b != NULL && c != NULL);
+    memcpy(a, "first", 5);
+    memcpy(c, "3rd", 3);
+    RING_CommitReserved(c);
+    RING_DiscardReserved(b);
+    rtn &= (RING_PeekReserved(ring, &len) == NULL);
+    RING_CommitReserved(a);
+    
+    rec = RING_PeekReserved(ring, &len);
+    rtn &= (rec == a && len == 5 && memcmp(rec, "first", 5) == 0);
+    RING_ReleaseReserved(ring);
+    rec = RING_PeekReserved(ring, &len);
+    rtn &= (rec == c && len == 3 && memcmp(rec, "3rd", 3) == 0);
+    RING_ReleaseReserved(ring);
+    rtn &= (RING_PeekReserved(ring, &len) == NULL);
+    
+    // Records never straddle the end of the buffer
+    for (i = 0; i < 8; i++) {
+        a = RING_ReserveBytes(ring, 20);
+        rtn &= (a != NULL);
+        if (a == NULL)
+            break;
+        rtn &= (a + 20 <= ring->buf + ring->size);
+        memset(a, (int) i, 20);
+        RING_CommitReserved(a);
+        rec = RING_PeekReserved(ring, &len);
+        rtn &= (rec == a && len == 20 && rec[19] == i);
+        RING_ReleaseReserved(ring);
+    }
+    
+    // Full ring
+    rtn &= (RING_ReserveBytes(ring, 64) == NULL);
+    
+    RING_DeinitializeReserve(ring);
+    
+    return rtn;
+}
@@ -0,0 +1,82 @@
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+ 
+ @File Name
+ TestSession.c
+ 
+ @Author
+ Luca Pascarella https://lucapascarella.com
+ 
+ @Summary
+ This file tests the RingSession library
+ 
+ @Description
+ This file collects the tests of the reader and writer sessions.
+ 
+ @License
+ Copyright (C) 2016 LP Systems
+ 
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+ 
+ https://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+#include "TestSession.h"
+
+bool Test_SessionBatchPublish(void) {
+    RING_DATA *ring;
+    RING_SESSION writer, reader;
+    uint8_t byte;
+    size_t i, start;
+    bool rtn = true;
+    
+    ring = RING_InitBuffer(NULL, 32);
+    rtn &= (ring != NULL);
+    
+    for (start = 0; start < 32; start++) {
+        ring->head = ring->tail = start;
+        
+        // Nothing is published before the close
+        rtn &= (RING_OpenWriteSession(&writer, ring) == 31);
+        for (i = 0; i < 20; i++)
+            rtn &= RING_SessionPutByte(&writer, (uint8_t) i);
+        rtn &= (RING_GetFullSpace(ring) == 0);
+        rtn &= (RING_OpenReadSession(&reader, ring) == 0);
+        rtn &= !RING_SessionGetByte(&reader, &byte);
+        RING_CloseSession(&writer);
+        rtn &= (RING_GetFullSpace(ring) == 20);
+        
+        // Both sides go on after a close, each one within its snapshot
+        rtn &= (RING_OpenReadSession(&reader, ring) == 20);
+        for (i = 0; i < 11; i++)
+            rtn &= (RING_SessionGetByte(&reader, &byte) && byte == i);
+        RING_CloseSession(&reader);
+        rtn &= (RING_GetFullSpace(ring) == 9);
+        for (i = 20; RING_SessionPutByte(&writer, (uint8_t) i); i++)
+            ;
+        rtn &= (i == 31 && RING_GetSessionSpace(&writer) == 0);
+        RING_CloseSession(&writer);
+        rtn &= (RING_GetFullSpace(ring) == 20);
+        while (RING_SessionGetByte(&reader, &byte))
+            ;
+        RING_CloseSession(&reader);
+        rtn &= (RING_GetFullSpace(ring) == 11);
+        
+        rtn &= (RING_OpenReadSession(&reader, ring) == 11);
+        for (i = 20; i < 31; i++)
+            rtn &= (RING_SessionGetByte(&reader, &byte) && byte == i);
+        RING_CloseSession(&reader);
+        rtn &= (RING_GetFullSpace(ring) == 0);
+    }
+    
+    RING_DeinitializeBuffer(ring);
+    
+    return rtn;
+}
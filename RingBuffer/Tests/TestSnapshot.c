@@ -0,0 +1,153 @@
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+ 
+ @File Name
+ TestSnapshot.c
+ 
+ @Author
+ Luca Pascarella https://lucapascarella.com
+ 
+ @Summary
+ This file tests the RingSnapshot library
+ 
+ @Description
+ This file collects the tests of the ring snapshots.
+ 
+ @License
+ Copyright (C) 2016 LP Systems
+ 
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+ 
+ https://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+#include "TestSnapshot.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <pthread.h>
+#include <stdatomic.h>
+#define TEST_SNAPSHOT_THREADS
+#endif
+
+bool Test_SnapshotRecent(void) {
+    RING_SNAPSHOT *snapshot;
+    uint8_t buf[64], copy[64];
+    size_t i, k, copied;
+    bool rtn = true;
+
+    snapshot = RING_InitSnapshot(NULL, 64);
+    for (i = 0; i < sizeof (buf); i++)
+        buf[i] = (uint8_t) i;
+
+    rtn &= (RING_GetSnapshot(snapshot, copy, sizeof (copy), &copied) && copied == 0);
+
+    // Every start index, the copy may wrap
+    for (k = 0; k < 64; k++) {
+        RING_AddSnapshotBuffer(snapshot, buf, 50);
+
+        // The most recent bytes
+        rtn &= (RING_GetSnapshot(snapshot, copy, 20, &copied) && copied == 20);
+        rtn &= (memcmp(copy, &buf[30], 20) == 0);
+
+        // The whole filled space, nothing is consumed
+        rtn &= (RING_GetSnapshot(snapshot, copy, sizeof (copy), &copied) && copied == 50);
+        rtn &= (memcmp(copy, buf, 50) == 0);
+        rtn &= (RING_GetSnapshotFullSpace(snapshot) == 50);
+
+        // The next pass starts one byte later
+        rtn &= (RING_GetSnapshotBuffer(snapshot, copy, 49) == 49);
+        rtn &= (RING_GetSnapshotBuffer(snapshot, copy, sizeof (copy)) == 1 && copy[0] == 49);
+        RING_AddSnapshotBuffer(snapshot, buf, 1);
+        RING_GetSnapshotBuffer(snapshot, copy, 1);
+    }
+
+    RING_DeinitializeSnapshot(snapshot);
+
+    return rtn;
+}
+
+#ifdef TEST_SNAPSHOT_THREADS
+
+typedef struct {
+    RING_SNAPSHOT *snapshot; // Ring shared by the three threads
+    atomic_bool stop; // It is true when the threads must return
+} TEST_SNAPSHOT_SHARED;
+
+// Writes an increasing byte sequence in chunks of odd lengths
+
+static void * Test_SnapshotProducer(void *arg) {
+    TEST_SNAPSHOT_SHARED *shared = arg;
+    uint8_t val = 0, chunk[37];
+    size_t i, n;
+
+    while (!atomic_load_explicit(&shared->stop, memory_order_relaxed)) {
+        for (i = 0; i < sizeof (chunk); i++)
+            chunk[i] = (uint8_t) (val + i);
+        n = RING_AddSnapshotBuffer(shared->snapshot, chunk, sizeof (chunk));
+        val = (uint8_t) (val + n);
+    }
+    return NULL;
+}
+
+// Consumes the oldest bytes as fast as possible, so the snapshots race with the tail
+
+static void * Test_SnapshotConsumer(void *arg) {
+    TEST_SNAPSHOT_SHARED *shared = arg;
+    uint8_t chunk[29];
+
+    while (!atomic_load_explicit(&shared->stop, memory_order_relaxed))
+        RING_GetSnapshotBuffer(shared->snapshot, chunk, sizeof (chunk));
+    return NULL;
+}
+
+bool Test_SnapshotConcurrent(void) {
+    TEST_SNAPSHOT_SHARED shared;
+    pthread_t producer, consumer;
+    uint8_t copy[256];
+    size_t i, k, copied, consistent;
+    bool rtn = true;
+
+    if ((shared.snapshot = RING_InitSnapshot(NULL, 256)) == NULL)
+        return false;
+    atomic_init(&shared.stop, false);
+    if (pthread_create(&producer, NULL, Test_SnapshotProducer, &shared) != 0)
+        return false;
+    if (pthread_create(&consumer, NULL, Test_SnapshotConsumer, &shared) != 0) {
+        atomic_store(&shared.stop, true);
+        pthread_join(producer, NULL);
+        return false;
+    }
+
+    // Every consistent snapshot is a window of the stream
+    consistent = 0;
+    for (k = 0; k < 200000; k++) {
+        if (!RING_GetSnapshot(shared.snapshot, copy, (k & 1) ? 100 : sizeof (copy), &copied))
+            continue;
+        consistent++;
+        for (i = 1; i < copied; i++)
+            rtn &= (copy[i] == (uint8_t) (copy[0] + i));
+    }
+    rtn &= (consistent > 0);
+
+    atomic_store(&shared.stop, true);
+    pthread_join(consumer, NULL);
+    pthread_join(producer, NULL);
+    RING_DeinitializeSnapshot(shared.snapshot);
+
+    return rtn;
+}
+
+#else
+
+bool Test_SnapshotConcurrent(void) {
+    return true;
+}
+
+#endif
@@ -0,0 +1,153 @@
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+ 
+ @File Name
+ TestTransfer.c
+ 
+ @Author
+ Luca Pascarella https://lucapascarella.com
+ 
+ @Summary
+ This file tests the RingTransfer library
+ 
+ @Description
+ This file collects the tests of the ring to ring transfer.
+ 
+ @License
+ Copyright (C) 2016 LP Systems
+ 
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+ 
+ https://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+#include "TestTransfer.h"
+
+#if defined(__linux__)
+#include <unistd.h>
+#define TEST_TRANSFER_REMAP
+#endif
+
+static bool Test_TransferCheck(RING_DATA *dst, size_t len, uint32_t seed) {
+    uint8_t chunk[4096];
+    size_t i, n;
+    bool rtn = true;
+    
+    while (len > 0) {
+        n = RING_GetBuffer(dst, chunk, min(len, sizeof (chunk)));
+        for (i = 0; i < n; i++, seed++)
+            rtn &= (chunk[i] == (uint8_t) (seed * 2654435761u >> 24));
+        len -= n;
+        if (n == 0)
+            return false;
+    }
+    return rtn;
+}
+
+// Reads the source memory in place, the bytes left behind by a transfer
+
+static bool Test_TransferSource(const RING_DATA *src, size_t start, size_t len, uint32_t seed, bool zero) {
+    size_t i;
+    bool rtn = true;
+    
+    for (i = 0; i < len; i++, seed++)
+        rtn &= (src->buf[(start + i) % src->size] == (zero ? 0 : (uint8_t) (seed * 2654435761u >> 24)));
+    return rtn;
+}
+
+static void Test_TransferFill(RING_DATA *src, size_t len, uint32_t seed) {
+    uint8_t chunk[4096];
+    size_t i, n;
+    
+    while (len > 0) {
+        n = min(len, sizeof (chunk));
+        for (i = 0; i < n; i++, seed++)
+            chunk[i] = (uint8_t) (seed * 2654435761u >> 24);
+        RING_AddBuffer(src, chunk, n);
+        len -= n;
+    }
+}
+
+bool Test_TransferCopyRemap(void) {
+    RING_DATA *src, *dst;
+    size_t k, len, start, head, page, first, pages, moved;
+    bool rtn = true;
+    
+    // Both segments of both rings
+    src = RING_InitBuffer(NULL, 64);
+    dst = RING_InitBuffer(NULL, 32);
+    for (k = 0; k < 64; k++) {
+        src->head = src->tail = k;
+        dst->head = dst->tail = (k * 7) % 32;
+        Test_TransferFill(src, 40, (uint32_t) k);
+        rtn &= (RING_Transfer(dst, src, 100) == 31);
+        rtn &= (RING_GetFullSpace(src) == 9 && RING_GetFullSpace(dst) == 31);
+        rtn &= Test_TransferCheck(dst, 31, (uint32_t) k);
+        rtn &= (RING_Transfer(dst, src, 5) == 5);
+        rtn &= Test_TransferCheck(dst, 5, (uint32_t) k + 31);
+        src->tail = src->head;
+    }
+    RING_DeinitializeBuffer(dst);
+    RING_DeinitializeBuffer(src);
+    
+    // Mapped rings, page aligned alike or not
+    src = RING_InitMappedBuffer(0x800000);
+    dst = RING_InitMappedBuffer(0x800000);
+    if (src == NULL || dst == NULL)
+        return rtn;
+    moved = 0;
+    for (k = 0; k < 4; k++) {
+        len = 0x300000 + k * 1000;
+        RING_IncreaseHead(src, 0x280000 + k * 100);
+        RING_IncreaseTail(src, 0x280000 + k * 100);
+        // Even passes line the destination head up with the source tail, odd
+        // passes are 17 bytes off
+        RING_IncreaseHead(dst, ((k & 1) ? 0x80000 + 17 : 0x180000) + ((src->tail - dst->head) & 0xFFFF));
+        RING_IncreaseTail(dst, RING_GetFullSpace(dst));
+        Test_TransferFill(src, len, (uint32_t) k);
+        start = src->tail;
+        head = dst->head;
+        rtn &= (RING_Transfer(dst, src, len) == len);
+        rtn &= (RING_GetFullSpace(src) == 0);
+        rtn &= Test_TransferCheck(dst, len, (uint32_t) k);
+        
+        // Matching page offsets leave zero pages behind the moved run, the
+        // bytes copied around it and the bytes of other offsets stay as they were
+        first = pages = 0;
+#ifdef TEST_TRANSFER_REMAP
+        page = (size_t) sysconf(_SC_PAGESIZE);
+        if ((start & (page - 1)) == (head & (page - 1))) {
+            first = (page - (start & (page - 1))) & (page - 1);
+            pages = min(len - first, min(src->size - (start + first) % src->size, dst->size - (head + first) % dst->size));
+            pages &= ~(page - 1);
+            rtn &= (pages > 0 && (k & 1) == 0);
+            moved++;
+        }
+#else
+        (void) page;
+        (void) head;
+#endif
+        rtn &= Test_TransferSource(src, start, first, (uint32_t) k, false);
+        rtn &= Test_TransferSource(src, start + first, pages, 0, true);
+        rtn &= Test_TransferSource(src, start + first + pages, len - first - pages, (uint32_t) (k + first + pages), false);
+        
+        // The source pages are usable again
+        Test_TransferFill(src, len, (uint32_t) k + 5);
+        rtn &= (RING_Transfer(dst, src, len) == len);
+        rtn &= Test_TransferCheck(dst, len, (uint32_t) k + 5);
+    }
+#ifdef TEST_TRANSFER_REMAP
+    rtn &= (moved == 2);
+#endif
+    RING_DeinitializeBuffer(dst);
+    RING_DeinitializeBuffer(src);
+    
+    return rtn;
+}
@@ -0,0 +1,99 @@
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+ 
+ @File Name
+ TestTransform.c
+ 
+ @Author
+ Luca Pascarella https://lucapascarella.com
+ 
+ @Summary
+ This file tests the RingTransform library
+ 
+ @Description
+ This file collects the tests of the copy-with-transform functions.
+ 
+ @License
+ Copyright (C) 2016 LP Systems
+ 
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+ 
+ https://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+#include "TestTransform.h"
+
+bool Test_TransformSwapXorWiden(void) {
+    RING_TRANSFORM *transform;
+    RING_DATA *ring;
+    uint8_t src[200], dst[400], key[] = {0x37, 0xFA, 0x21, 0x3D, 0x55};
+    uint16_t narrow;
+    uint32_t wide;
+    size_t i, k, n;
+    bool rtn = true;
+    
+    for (i = 0; i < sizeof (src); i++)
+        src[i] = (uint8_t) (i * 13 + 1);
+    ring = RING_InitBuffer(NULL, 128);
+    rtn &= (ring != NULL);
+    
+    // Words straddling the wrap, written plainly and read back swapped
+    for (k = 2; k <= 8; k *= 2) {
+        transform = RING_InitTransform(k == 2 ? RING_TRANSFORM_SWAP16 : k == 4 ? RING_TRANSFORM_SWAP32 : RING_TRANSFORM_SWAP64);
+        RING_IncreaseHead(ring, 123);
+        RING_IncreaseTail(ring, 123);
+        rtn &= (RING_AddBuffer(ring, src, 101) == 101);
+        rtn &= (RING_GetBufferTransformed(transform, ring, dst, 101) == 101 - 101 % k);
+        for (i = 0; i < 101 - 101 % k; i++)
+            rtn &= (dst[i] == src[i - i % k + k - 1 - i % k]);
+        RING_GetBuffer(ring, dst, sizeof (dst));
+        RING_DeinitializeTransform(transform);
+    }
+    
+    // Key phase continues across calls of any length
+    transform = RING_InitTransform(RING_TRANSFORM_XOR);
+    rtn &= RING_SetTransformKey(transform, key, sizeof (key));
+    rtn &= (RING_AddBufferTransformed(transform, ring, src, 7) == 7);
+    rtn &= (RING_AddBufferTransformed(transform, ring, &src[7], 90) == 90);
+    rtn &= (RING_GetBuffer(ring, dst, sizeof (dst)) == 97);
+    for (i = 0; i < 97; i++)
+        rtn &= (dst[i] == (src[i] ^ key[i % sizeof (key)]));
+    rtn &= RING_SetTransformKey(transform, key, sizeof (key));
+    RING_AddBuffer(ring, dst, 97);
+    rtn &= (RING_GetBufferTransformed(transform, ring, dst, 33) == 33);
+    rtn &= (RING_GetBufferTransformed(transform, ring, &dst[33], 64) == 64);
+    rtn &= (memcmp(dst, src, 97) == 0);
+    RING_DeinitializeTransform(transform);
+    
+    // Widen on read and on write, the free space limits the written words
+    transform = RING_InitTransform(RING_TRANSFORM_WIDEN16);
+    rtn &= (RING_AddBuffer(ring, src, 60) == 60);
+    rtn &= (RING_GetBufferTransformed(transform, ring, dst, 60) == 60);
+    for (i = 0; i < 30; i++) {
+        memcpy(&narrow, &src[2 * i], 2);
+        memcpy(&wide, &dst[4 * i], 4);
+        rtn &= (wide == narrow);
+    }
+    RING_IncreaseHead(ring, 1);
+    RING_IncreaseTail(ring, 1);
+    n = RING_AddBufferTransformed(transform, ring, src, sizeof (src));
+    rtn &= (n == 62 && RING_GetFullSpace(ring) == 124);
+    rtn &= (RING_GetBuffer(ring, dst, sizeof (dst)) == 124);
+    for (i = 0; i < n / 2; i++) {
+        memcpy(&narrow, &src[2 * i], 2);
+        memcpy(&wide, &dst[4 * i], 4);
+        rtn &= (wide == narrow);
+    }
+    RING_DeinitializeTransform(transform);
+    
+    RING_DeinitializeBuffer(ring);
+    
+    return rtn;
+}
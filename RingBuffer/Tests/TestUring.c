@@ -0,0 +1,130 @@
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+ 
+ @File Name
+ TestUring.c
+ 
+ @Author
+ Luca Pascarella https://lucapascarella.com
+ 
+ @Summary
+ This file tests the RingUring library
+ 
+ @Description
+ This file collects the tests of the io_uring engine.
+ 
+ @License
+ Copyright (C) 2016 LP Systems
+ 
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+ 
+ https://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE     // mkstemp(), pread()
+#endif
+
+#include "TestUring.h"
+
+#ifdef __linux__
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+static uint8_t Test_UringPattern(size_t i) {
+    return (uint8_t) (i * 2654435761u >> 24);
+}
+
+// Runs the engine until the source ends and the ring is drained, the bytes
+// written into the pipe are collected on the way
+
+static bool Test_UringRun(RING_URING *uring, size_t chunk, int pipeFd, uint8_t *dst, size_t *len) {
+    ssize_t n;
+    size_t rounds;
+
+    for (rounds = 0; rounds < 100000; rounds++) {
+        if (uring->eof && RING_IsUringIdle(uring) && RING_GetFullSpace(uring->ring) == 0)
+            return uring->error == 0;
+        RING_SubmitUring(uring, chunk);
+        RING_CompleteUring(uring, true);
+        while (pipeFd >= 0 && (n = read(pipeFd, &dst[*len], 4096)) > 0)
+            *len += (size_t) n;
+    }
+    return false;
+}
+
+bool Test_UringFilePipeCopy(void) {
+    char path[] = "/tmp/RingUringXXXXXX", path2[] = "/tmp/RingUringXXXXXX";
+    RING_DATA *ring;
+    RING_URING *uring;
+    uint8_t *src, *dst;
+    int fd, p[2];
+    size_t i, len;
+    bool rtn = true;
+
+    ring = RING_InitBuffer(NULL, 4096);
+    if ((uring = RING_InitUring(ring, 8)) == NULL) {
+        RING_DeinitializeBuffer(ring);
+        return true; // No io_uring on this kernel
+    }
+
+    src = malloc(100000);
+    dst = malloc(100000 + 4096);
+    for (i = 0; i < 100000; i++)
+        src[i] = Test_UringPattern(i);
+
+    // File to pipe, the chunk does not divide the file, so the last positioned
+    // read is short and the reads in flight after it are discarded
+    fd = mkstemp(path);
+    unlink(path);
+    rtn &= (write(fd, src, 100000) == 100000);
+    rtn &= (pipe(p) == 0);
+    fcntl(p[0], F_SETFL, O_NONBLOCK);
+    RING_SetUringSource(uring, fd, 0);
+    RING_SetUringSink(uring, p[1], -1);
+    len = 0;
+    rtn &= Test_UringRun(uring, 768, p[0], dst, &len);
+    rtn &= (len == 100000 && memcmp(src, dst, len) == 0);
+    rtn &= (uring->readOffset == 100000);
+    close(p[0]);
+    close(p[1]);
+    close(fd);
+
+    // Pipe to file, stream reads may be short at any point
+    fd = mkstemp(path2);
+    unlink(path2);
+    rtn &= (pipe(p) == 0);
+    rtn &= (write(p[1], src, 50000) == 50000);
+    close(p[1]);
+    RING_SetUringSource(uring, p[0], -1);
+    RING_SetUringSink(uring, fd, 0);
+    len = 0;
+    rtn &= Test_UringRun(uring, 1000, -1, dst, &len);
+    rtn &= (pread(fd, dst, 100000, 0) == 50000 && memcmp(src, dst, 50000) == 0);
+    close(p[0]);
+    close(fd);
+
+    free(dst);
+    free(src);
+    RING_DeinitializeUring(uring);
+    RING_DeinitializeBuffer(ring);
+
+    return rtn;
+}
+
+#else
+
+bool Test_UringFilePipeCopy(void) {
+    return true;
+}
+
+#endif
@@ -0,0 +1,80 @@
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+ 
+ @File Name
+ TestView.cpp
+ 
+ @Author
+ Luca Pascarella https://lucapascarella.com
+ 
+ @Summary
+ This file tests the RingView library
+ 
+ @Description
+ This file collects the tests of the random-access view.
+ 
+ @License
+ Copyright (C) 2016 LP Systems
+ 
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+ 
+ https://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+// The standard headers come last, RingView.hpp must not leak the min() macro
+#include "RingView.hpp"
+#include "TestView.h"
+#include <algorithm>
+#include <type_traits>
+
+// The view is a random-access range that can be passed around by value
+static_assert(std::ranges::random_access_range<ring::View>);
+static_assert(std::ranges::view<ring::View>);
+static_assert(std::ranges::borrowed_range<ring::View>);
+static_assert(std::random_access_iterator<ring::Iterator>);
+// A const ring cannot be written through a view
+static_assert(!std::is_constructible_v<ring::View, const RING_DATA *>);
+
+bool Test_ViewWrappedRange(void) {
+    uint8_t data[12], tmp[10];
+    size_t i;
+    bool rtn = true;
+
+    for (i = 0; i < sizeof (data); i++)
+        data[i] = (uint8_t) (100 + i);
+
+    ring::Buffer buffer(16);
+
+    // The tail is moved so that the data wraps after 6 bytes
+    RING_AddBuffer(buffer.get(), tmp, sizeof (tmp));
+    RING_GetBuffer(buffer.get(), tmp, sizeof (tmp));
+    RING_AddBuffer(buffer.get(), data, sizeof (data));
+
+    ring::View view = buffer.view();
+    rtn &= (view.size() == sizeof (data));
+    rtn &= (view.segments()[0].size() == 6 && view.segments()[1].size() == 6);
+    rtn &= (std::ranges::equal(view, std::span<const uint8_t>(data)));
+    rtn &= (view[11] == 111 && *(view.end() - 1) == 111 && view.end() - view.begin() == 12);
+
+    // The algorithms write across the wrap
+    std::ranges::reverse(view);
+    for (i = 0; i < sizeof (data); i++)
+        rtn &= (view[i] == data[sizeof (data) - 1 - i]);
+    std::ranges::sort(view);
+    rtn &= (std::ranges::equal(view, std::span<const uint8_t>(data)));
+
+    // Consuming up to an iterator moves the tail across the wrap
+    auto it = std::ranges::find(view, 108);
+    rtn &= (it != view.end() && it.position() == 8);
+    buffer.consume(it);
+    rtn &= (RING_GetFullSpace(buffer.get()) == 4 && buffer.view().front() == 108);
+
+    return rtn;
+}
@@ -0,0 +1,90 @@
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+ 
+ @File Name
+ TestWatermark.c
+ 
+ @Author
+ Luca Pascarella https://lucapascarella.com
+ 
+ @Summary
+ This file tests the RingWatermark library
+ 
+ @Description
+ This file collects the tests of the fill level watermarks.
+ 
+ @License
+ Copyright (C) 2016 LP Systems
+ 
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+ 
+ https://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+#include "TestWatermark.h"
+
+typedef struct {
+    size_t highs; // Number of high crossings
+    size_t lows; // Number of low crossings
+} TEST_WATERMARK_EVENTS;
+
+static void Test_WatermarkCallback(void *ctx, bool high) {
+    TEST_WATERMARK_EVENTS *events = ctx;
+
+    if (high)
+        events->highs++;
+    else
+        events->lows++;
+}
+
+bool Test_WatermarkHysteresis(void) {
+    TEST_WATERMARK_EVENTS events = {0, 0};
+    RING_DATA *ring;
+    RING_WATERMARK *watermark;
+    uint8_t buf[64];
+    size_t i;
+    bool rtn = true;
+
+    ring = RING_InitBuffer(NULL, 128);
+    rtn &= (RING_InitWatermark(ring, 96, 32, NULL, NULL) == NULL);
+    rtn &= (RING_InitWatermark(ring, 32, 128, NULL, NULL) == NULL);
+    watermark = RING_InitWatermark(ring, 32, 96, Test_WatermarkCallback, &events);
+    rtn &= (watermark != NULL && !RING_IsWatermarkHigh(watermark));
+
+    memset(buf, 0x5A, sizeof (buf));
+    for (i = 0; i < 3; i++) {
+        // Oscillating around the high mark fires once
+        rtn &= (RING_AddWatermarkBuffer(watermark, buf, 64) == 64);
+        rtn &= (RING_AddWatermarkBuffer(watermark, buf, 31) == 31);
+        rtn &= (!RING_IsWatermarkHigh(watermark) && events.highs == i);
+        rtn &= (RING_AddWatermarkBuffer(watermark, buf, 1) == 1);
+        rtn &= (RING_IsWatermarkHigh(watermark) && events.highs == i + 1);
+        rtn &= (RING_GetWatermarkBuffer(watermark, buf, 10) == 10);
+        rtn &= (RING_AddWatermarkBuffer(watermark, buf, 10) == 10);
+        rtn &= (events.highs == i + 1 && events.lows == i);
+
+        // Draining fires once at the low mark
+        rtn &= (RING_GetWatermarkBuffer(watermark, buf, 63) == 63);
+        rtn &= (RING_IsWatermarkHigh(watermark) && events.lows == i);
+        rtn &= (RING_GetWatermarkBuffer(watermark, buf, 1) == 1);
+        rtn &= (!RING_IsWatermarkHigh(watermark) && events.lows == i + 1);
+        rtn &= (RING_GetWatermarkBuffer(watermark, buf, 64) == 32);
+        rtn &= (events.lows == i + 1);
+    }
+
+    // Moves done through other functions are seen by an explicit update
+    RING_IncreaseHead(ring, 100);
+    rtn &= (RING_UpdateWatermark(watermark) && events.highs == 4);
+
+    RING_DeinitializeWatermark(watermark);
+    RING_DeinitializeBuffer(ring);
+
+    return rtn;
+}
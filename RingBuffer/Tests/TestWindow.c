@@ -0,0 +1,82 @@
+/** **************************************************************************
+ @Company
+ LP Systems https://lpsystems.eu
+ 
+ @File Name
+ TestWindow.c
+ 
+ @Author
+ Luca Pascarella https://lucapascarella.com
+ 
+ @Summary
+ This file tests the RingWindow library
+ 
+ @Description
+ This file collects the tests of the retransmission window.
+ 
+ @License
+ Copyright (C) 2016 LP Systems
+ 
+ Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+ in compliance with the License. You may obtain a copy of the License at
+ 
+ https://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software distributed under the License
+ is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ or implied. See the License for the specific language governing permissions and limitations under
+ the License.
+ ************************************************************************** */
+
+#include "TestWindow.h"
+
+bool Test_WindowSendAckRewind(void) {
+    RING_DATA *ring;
+    RING_WINDOW *window;
+    uint8_t *ptr;
+    size_t toSend;
+    bool rtn = true;
+    
+    ring = RING_InitBuffer(NULL, 16);
+    rtn &= (ring != NULL);
+    
+    // Move the cursors close to the end of the buffer, the window sent cursor
+    // starts at the tail
+    RING_IncreaseHead(ring, 12);
+    RING_IncreaseTail(ring, 12);
+    window = RING_InitWindow(ring);
+    rtn &= (window != NULL);
+    rtn &= (RING_GetWindowInFlightSpace(window) == 0);
+    
+    rtn &= (RING_AddBuffer(ring, (uint8_t*) "ABCDEFGH", 8) == 8);
+    rtn &= (RING_GetWindowUnsentSpace(window) == 8);
+    
+    // Send wraps in two linear chunks
+    ptr = RING_SendWindowDirectly(window, &toSend, 6);
+    rtn &= (toSend == 4 && memcmp(ptr, "ABCD", 4) == 0);
+    ptr = RING_SendWindowDirectly(window, &toSend, 2);
+    rtn &= (toSend == 2 && memcmp(ptr, "EF", 2) == 0);
+    rtn &= (RING_GetWindowInFlightSpace(window) == 6);
+    rtn &= (RING_GetWindowUnsentSpace(window) == 2);
+    
+    // Sent bytes still occupy the ring until they are acknowledged
+    rtn &= (RING_GetFullSpace(ring) == 8);
+    rtn &= (RING_AcknowledgeWindow(window, 3) == 3);
+    rtn &= (RING_GetFullSpace(ring) == 5);
+    rtn &= (RING_GetWindowInFlightSpace(window) == 3);
+    
+    // Retransmit the unacknowledged bytes
+    rtn &= (RING_RewindWindow(window, SIZE_MAX) == 3);
+    ptr = RING_SendWindowDirectly(window, &toSend, 16);
+    rtn &= (toSend == 1 && memcmp(ptr, "D", 1) == 0);
+    ptr = RING_SendWindowDirectly(window, &toSend, 16);
+    rtn &= (toSend == 4 && memcmp(ptr, "EFGH", 4) == 0);
+    
+    rtn &= (RING_AcknowledgeWindow(window, 100) == 5);
+    rtn &= (RING_GetFullSpace(ring) == 0);
+    
+    RING_DeinitializeWindow(window);
+    RING_DeinitializeBuffer(ring);
+    
+    return rtn;
+}
@@ -34,6 +34,27 @@
 #include <string.h>
 #include <assert.h>
 #include "Test1.h"
+#include "TestGroup.h"
+#include "TestFanIn.h"
+#include "TestReserve.h"
+#include "TestWindow.h"
+#include "TestLz4.h"
+#include "TestCrc.h"
+#include "TestFraming.h"
+#include "TestTransform.h"
+#include "TestCursor.h"
+#include "TestSession.h"
+#include "TestCompact.h"
+#include "TestTransfer.h"
+#include "TestRecord.h"
+#include "TestLanes.h"
+#include "TestWatermark.h"
+#include "TestSnapshot.h"
+#include "TestLatency.h"
+#include "TestExternal.h"
+#include "TestUring.h"
+#include "TestCoro.h"
+#include "TestView.h"
 #include "RingBuffer.h"
 
 void printb(uint8_t *buf, size_t size);
@@ -54,6 +75,36 @@ int main(int argc, const char * argv[]) {
     printf("Test multiple fill long: %c\n", Test_MultipleFillLong()?'Y':'N');
     printf("Test linear add: %c\n", Test_LinearAdd()?'Y':'N');
     printf("Test linear get: %c\n", Test_LinearGet()?'Y':'N');
+    printf("Test streaming copy: %c\n", Test_StreamingCopy()?'Y':'N');
+    printf("Test fast path: %c\n", Test_FastPath()?'Y':'N');
+    printf("Test mapped buffer: %c\n", Test_MappedBuffer()?'Y':'N');
+    printf("Test size policy: %c\n", Test_SizePolicy()?'Y':'N');
+    printf("Test group local and steal: %c\n", Test_GroupLocalAndSteal()?'Y':'N');
+    printf("Test group threaded steal: %c\n", Test_GroupThreadedSteal()?'Y':'N');
+    printf("Test fan-in round robin: %c\n", Test_FanInRoundRobin()?'Y':'N');
+    printf("Test fan-in threaded producers: %c\n", Test_FanInThreadedProducers()?'Y':'N');
+    printf("Test reserve in order: %c\n", Test_ReserveInOrder()?'Y':'N');
+    printf("Test window send ack rewind: %c\n", Test_WindowSendAckRewind()?'Y':'N');
+    printf("Test lz4 round trip: %c\n", Test_Lz4RoundTrip()?'Y':'N');
+    printf("Test crc32c: %c\n", Test_Crc32c()?'Y':'N');
+    printf("Test crc32c software: %c\n", Test_Crc32cSoftware()?'Y':'N');
+    printf("Test framing slip cobs: %c\n", Test_FramingSlipCobs()?'Y':'N');
+    printf("Test transform swap xor widen: %c\n", Test_TransformSwapXorWiden()?'Y':'N');
+    printf("Test cursor decode commit: %c\n", Test_CursorDecodeCommit()?'Y':'N');
+    printf("Test session batch publish: %c\n", Test_SessionBatchPublish()?'Y':'N');
+    printf("Test compact lazy storage: %c\n", Test_CompactLazyStorage()?'Y':'N');
+    printf("Test transfer copy remap: %c\n", Test_TransferCopyRemap()?'Y':'N');
+    printf("Test record window: %c\n", Test_RecordWindow()?'Y':'N');
+    printf("Test lanes priority weight: %c\n", Test_LanesPriorityWeight()?'Y':'N');
+    printf("Test lanes threaded producers: %c\n", Test_LanesThreadedProducers()?'Y':'N');
+    printf("Test watermark hysteresis: %c\n", Test_WatermarkHysteresis()?'Y':'N');
+    printf("Test snapshot recent bytes: %c\n", Test_SnapshotRecent()?'Y':'N');
+    printf("Test snapshot concurrent: %c\n", Test_SnapshotConcurrent()?'Y':'N');
+    printf("Test latency percentiles: %c\n", Test_LatencyPercentiles()?'Y':'N');
+    printf("Test external counter overrun: %c\n", Test_ExternalCounterOverrun()?'Y':'N');
+    printf("Test uring file pipe copy: %c\n", Test_UringFilePipeCopy()?'Y':'N');
+    printf("Test coro suspend resume: %c\n", Test_CoroSuspendResume()?'Y':'N');
+    printf("Test view wrapped range: %c\n", Test_ViewWrappedRange()?'Y':'N');
     
     printf("\nRingBuffer ended\n");
     return 0;